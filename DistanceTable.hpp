@@ -0,0 +1,113 @@
+/*******************************************************************************
+                                                    Jose Jorge Jimenez-Olivas
+                                                    Brandon Cramer
+
+                 University of California, San Diego
+                           IEEE Micromouse
+
+File Name:       DistanceTable.hpp
+Description:     Compact table of shortest distances from every maze cell to
+                 the nearest cell of a goal set.
+*******************************************************************************/
+#ifndef DISTANCETABLE_HPP
+#define DISTANCETABLE_HPP
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+class DistanceTable {
+public:
+  friend class Maze;
+  /* cell indices (row * width + column) of the goal set */
+  std::vector<int> goals;
+  /* bytes per stored distance - 1, 2 or 4 */
+  int entry_size;
+  /* distances stored little-endian, entry_size bytes per cell */
+  std::vector<uint8_t> data;
+  /* table must be recomputed before its next lookup */
+  bool stale = true;
+
+  /*****************************************************************************
+  % Constructor:  DistanceTable
+  % File:         DistanceTable.hpp
+  % Parameters:   goals - cell indices of the goal set.
+  %               cells - number of cells in the maze.
+  % Description:  Creates a stale table in the narrowest entry size that can
+  %               hold the longest possible distance and the unreachable mark.
+  ******************************************************************************/
+  DistanceTable( const std::vector<int> & goals, int cells ) : goals( goals ) {
+    /* no distance can exceed the number of non-goal cells */
+    uint32_t longest = (uint32_t)cells - (uint32_t)goals.size();
+    if( longest < UINT8_MAX ) entry_size = 1;
+    else if( longest < UINT16_MAX ) entry_size = 2;
+    else entry_size = 4;
+    data = std::vector<uint8_t>( (size_t)cells * entry_size );
+  }
+
+  /*****************************************************************************
+  % Routine Name: unreachable
+  % File:         DistanceTable.hpp
+  % Parameters:   None.
+  % Description:  Marker stored for cells that cannot reach any goal.
+  % Return:       Largest value representable in entry_size bytes.
+  *****************************************************************************/
+  uint32_t unreachable() const {
+    return ( entry_size == 4 ) ? UINT32_MAX : ( (1u << (8 * entry_size)) - 1 );
+  }
+
+  /*****************************************************************************
+  % Routine Name: get
+  % File:         DistanceTable.hpp
+  % Parameters:   index - cell index.
+  % Description:  Reads the stored distance of a cell.
+  % Return:       The distance, or unreachable().
+  *****************************************************************************/
+  uint32_t get( int index ) const {
+    const uint8_t * entry = &data[ (size_t)index * entry_size ];
+    switch( entry_size ) {
+      case 1: return entry[ 0 ];
+      case 2: return entry[ 0 ] | ( (uint32_t)entry[ 1 ] << 8 );
+      default: return entry[ 0 ] | ( (uint32_t)entry[ 1 ] << 8 ) |
+                      ( (uint32_t)entry[ 2 ] << 16 ) | ( (uint32_t)entry[ 3 ] << 24 );
+    }
+  }
+
+  /*****************************************************************************
+  % Routine Name: set
+  % File:         DistanceTable.hpp
+  % Parameters:   index - cell index.
+  %               value - distance to store.
+  % Description:  Writes the distance of a cell.
+  % Return:       Nothing.
+  *****************************************************************************/
+  void set( int index, uint32_t value ) {
+    uint8_t * entry = &data[ (size_t)index * entry_size ];
+    for( int byte = 0; byte < entry_size; byte++ ) {
+      entry[ byte ] = (uint8_t)( value >> (8 * byte) );
+    }
+  }
+
+  /*****************************************************************************
+  % Routine Name: affectedBy
+  % File:         DistanceTable.hpp
+  % Parameters:   index_A    - cell index on one side of the wall.
+  %               index_B    - cell index on the other side of the wall.
+  %               wall_added - true if the wall was added, false if removed.
+  % Description:  Decides from the current distances alone whether toggling
+  %               the wall between two adjacent cells can change the table.
+  %               An added wall only matters if the edge was on a shortest
+  %               path, a removed wall only if it creates a shortcut.
+  % Return:       True if the table must be recomputed.
+  *****************************************************************************/
+  bool affectedBy( int index_A, int index_B, bool wall_added ) const {
+    uint32_t distance_A = get( index_A );
+    uint32_t distance_B = get( index_B );
+    uint32_t gap = ( distance_A > distance_B ) ? distance_A - distance_B
+                                               : distance_B - distance_A;
+    if( distance_A == unreachable() && distance_B == unreachable() ) return false;
+    if( wall_added ) return gap == 1;
+    return gap > 1;
+  }
+};
+#endif
@@ -10,9 +10,23 @@ Description:     2D matrix data structure with an internal graph abstraction.
 *******************************************************************************/
 #include "Maze.h"
 
+const int Maze::WALL_UP;
+const int Maze::WALL_RIGHT;
+const int Maze::WALL_DOWN;
+const int Maze::WALL_LEFT;
+const int Maze::ALL_SIDES;
+const int Maze::INVALID_CELL;
+const int Maze::OPEN_BOUNDARY;
+const int Maze::INCONSISTENT_WALLS;
+const int Maze::PARALLEL_GRAIN;
+
 /* Helper Functions */
 namespace MazeHelper {
   std::stack<std::string> verticallyStackedRange( int min, int max );
+  uint64_t mix( uint64_t value );
+  uint64_t spreadBits( uint32_t value );
+  uint32_t compactBits( uint64_t value );
+  bool writeSnapshot( const MazeSnapshot & snapshot, const std::string & filename );
 }
 
 /*******************************************************************************
@@ -20,9 +34,15 @@ namespace MazeHelper {
 % File:        Maze.cpp
 % Parameters:  width  - width of rectangular maze.
 %              height - height of rectangular maze.
+%              layout - order of the cells in memory. TILED and MORTON keep
+%                       vertical neighbors close for searches on wide
+%                       mazes, at the cost of padding cells up to whole
+%                       tiles or squares.
 % Description: Creates a two dimensional maze data structure.
 *******************************************************************************/
-Maze::Maze( int width, int height ) : width( width ), height( height ) {
+Maze::Maze( int width, int height, Layout layout ) : layout( layout ),
+  width( width ), height( height ) {
+
   if( width < 0 || height < 0 ) {
     #if defined( ARDUINO )
       width = height = 0;
@@ -30,13 +50,33 @@ Maze::Maze( int width, int height ) : width( width ), height( height ) {
       throw std::length_error("Maze");
     #endif
   }
-  maze = std::vector<std::vector<MazeCell>>( height, std::vector<MazeCell>() );
-  /* creating maze cells */
-  for( int row = 0; row < height; row++ ) {
-    for( int column = 0; column < width; column++ ) {
-      maze[ row ].push_back( MazeCell(row, column) );
-    }
+  size_t cells = (size_t)width * height;
+  if( layout == TILED ) {
+    tile_columns = ( width + 7 ) / 8;
+    cells = (size_t)tile_columns * ( (height + 7) / 8 ) * 64;
+  }
+  else if( layout == MORTON ) {
+    /* squares of up to 64x64 cells, no larger than the shorter side needs */
+    const int shorter = std::min( width, height );
+    while( morton_bits < 6 && (1 << morton_bits) < shorter ) morton_bits++;
+    const int side = 1 << morton_bits;
+    tile_columns = ( width + side - 1 ) >> morton_bits;
+    cells = ( (size_t)tile_columns * ((height + side - 1) >> morton_bits) )
+            << ( 2 * morton_bits );
   }
+  /* creating maze cells in storage order */
+  MAZE_COUNT_ADD( ALLOCATIONS, 3 ); /* cells and the two passage planes */
+  maze.reserve( cells );
+  for( size_t index = 0; index < cells; index++ ) {
+    int row, column;
+    cellLocation( index, row, column );
+    maze.push_back( MazeCell(row, column) );
+  }
+  /* every cell starts out walled in */
+  plane_stride = ( width + 63 ) / 64;
+  right_plane = std::vector<uint64_t>( (size_t)height * plane_stride, 0 );
+  down_plane = std::vector<uint64_t>( (size_t)height * plane_stride, 0 );
+  zobrist = wallsHash( width, height );
 }
 
 /*******************************************************************************
@@ -51,6 +91,164 @@ Maze::Maze( const char * filename ) :
   load( filename );
 }
 
+/*******************************************************************************
+% Constructor: Maze
+% File:        Maze.cpp
+% Parameters:  other - maze to copy.
+% Description: Deep copy of a maze. The bit planes are copied word by word and
+%              the neighbor links are rebuilt from them in one pass, so no
+%              link of the copy points into the original. Search data and
+%              goal tables are copied as well; listeners and the journal
+%              history stay with the original.
+*******************************************************************************/
+Maze::Maze( const Maze & other ) : maze( other.maze ), layout( other.layout ),
+  tile_columns( other.tile_columns ), morton_bits( other.morton_bits ),
+  goal_tables( other.goal_tables ), right_plane( other.right_plane ),
+  down_plane( other.down_plane ), plane_stride( other.plane_stride ),
+  zobrist( other.zobrist ), snapshot_blocks( other.snapshot_blocks ),
+  width( other.width ), height( other.height ) {
+
+  MAZE_COUNT_ADD( ALLOCATIONS, 3 ); /* cells and the two passage planes */
+  /* copied cells keep only their location - links come from the planes */
+  relinkCells();
+
+  for( int row = 0; row < height; row++ ) {
+    for( int column = 0; column < width; column++ ) {
+      const MazeCell & source = other.maze[ cellIndex(row, column) ];
+      MazeCell & cell = maze[ cellIndex(row, column) ];
+      cell.distance = source.distance;
+      cell.visited = source.visited;
+      /* translate the search tree into this maze */
+      if( source.prev != nullptr ) {
+        cell.prev = &maze[ cellIndex(source.prev->row, source.prev->column) ];
+      }
+    }
+  }
+}
+
+/*******************************************************************************
+% Constructor: Maze
+% File:        Maze.cpp
+% Parameters:  other - maze to take over.
+% Description: Moves the cells of a maze without copying them - every cell
+%              keeps its address. The other maze is left empty (0 x 0), and
+%              its listeners stay attached to it.
+*******************************************************************************/
+Maze::Maze( Maze && other ) : maze( std::move(other.maze) ), layout( other.layout ),
+  tile_columns( other.tile_columns ), morton_bits( other.morton_bits ),
+  goal_tables( std::move(other.goal_tables) ),
+  right_plane( std::move(other.right_plane) ),
+  down_plane( std::move(other.down_plane) ),
+  plane_stride( other.plane_stride ), zobrist( other.zobrist ),
+  journal( std::move(other.journal) ),
+  redo_journal( std::move(other.redo_journal) ),
+  journaling( other.journaling ),
+  snapshot_blocks( std::move(other.snapshot_blocks) ),
+  width( other.width ), height( other.height ) {
+
+  other.maze.clear();
+  other.goal_tables.clear();
+  other.right_plane.clear();
+  other.down_plane.clear();
+  other.journal.clear();
+  other.redo_journal.clear();
+  other.snapshot_blocks.clear();
+  other.width = other.height = other.plane_stride = 0;
+  other.tile_columns = other.morton_bits = 0;
+  other.zobrist = wallsHash( 0, 0 );
+}
+
+/*******************************************************************************
+% Constructor: Maze
+% File:        Maze.cpp
+% Parameters:  snapshot - snapshot of a maze.
+% Description: Forks a full maze from a snapshot, sharing its row blocks as
+%              the snapshot cache of the new maze.
+*******************************************************************************/
+Maze::Maze( const MazeSnapshot & snapshot ) :
+  Maze( snapshot.width, snapshot.height ) {
+
+  for( int row = 0; row < height; row++ ) {
+    const SnapshotBlock & block = *snapshot.blocks[ row / MazeSnapshot::BLOCK_ROWS ];
+    size_t offset = (size_t)( row % MazeSnapshot::BLOCK_ROWS ) * plane_stride;
+    std::copy( block.right.begin() + offset, block.right.begin() + offset + plane_stride,
+               right_plane.begin() + (size_t)row * plane_stride );
+    std::copy( block.down.begin() + offset, block.down.begin() + offset + plane_stride,
+               down_plane.begin() + (size_t)row * plane_stride );
+  }
+  zobrist = snapshot.hash;
+  snapshot_blocks = snapshot.blocks;
+  relinkCells();
+}
+
+/*******************************************************************************
+% Routine Name: operator =
+% File:         Maze.cpp
+% Parameters:   other - maze to copy.
+% Description:  Replaces this maze with a deep copy of another, as the move
+%               assignment of a copy.
+% Return:       This maze.
+*******************************************************************************/
+Maze & Maze::operator=( const Maze & other ) {
+  if( this != &other ) *this = Maze( other );
+  return *this;
+}
+
+/*******************************************************************************
+% Routine Name: operator =
+% File:         Maze.cpp
+% Parameters:   other - maze to take over.
+% Description:  Replaces the cells of this maze with those of another, which
+%               is left empty. Listeners of this maze stay attached and, when
+%               the dimensions agree, are told of every passage that differs.
+%               Structures built for other dimensions must be rebuilt. The
+%               journal history no longer applies and is dropped.
+% Return:       This maze.
+*******************************************************************************/
+Maze & Maze::operator=( Maze && other ) {
+  if( this == &other ) return *this;
+  std::vector<WallChange> changes;
+  if( width == other.width && height == other.height && !listeners.empty() ) {
+    changes = diff( *this, other );
+  }
+
+  maze.swap( other.maze );
+  goal_tables.swap( other.goal_tables );
+  right_plane.swap( other.right_plane );
+  down_plane.swap( other.down_plane );
+  snapshot_blocks.swap( other.snapshot_blocks );
+  width = other.width;
+  height = other.height;
+  layout = other.layout;
+  tile_columns = other.tile_columns;
+  morton_bits = other.morton_bits;
+  plane_stride = other.plane_stride;
+  zobrist = other.zobrist;
+  journal.clear();
+  redo_journal.clear();
+  maze_str.clear();
+
+  /* leave the other maze empty */
+  other.maze.clear();
+  other.goal_tables.clear();
+  other.right_plane.clear();
+  other.down_plane.clear();
+  other.journal.clear();
+  other.redo_journal.clear();
+  other.snapshot_blocks.clear();
+  other.width = other.height = other.plane_stride = 0;
+  other.tile_columns = other.morton_bits = 0;
+  other.zobrist = wallsHash( 0, 0 );
+
+  for( const WallChange & change : changes ) {
+    MazeCell * cell = at( change.row, change.column );
+    MazeCell * neighbor = ( change.orientation == 0 ) ? at( change.row, change.column + 1 )
+                                                      : at( change.row + 1, change.column );
+    notifyWallChanged( cell, neighbor );
+  }
+  return *this;
+}
+
 /*******************************************************************************
 % Destructor: ~Maze 
 % File:        Maze.cpp
@@ -72,6 +270,7 @@ void Maze::addEdge( MazeCell * cell_A, MazeCell * cell_B ) {
   /* undirected edge added */
   cell_A->addNeighbor( cell_B );
   cell_B->addNeighbor( cell_A );
+  setPassage( cell_A, cell_B, true );
 }
 
 
@@ -88,31 +287,454 @@ void Maze::removeEdge( MazeCell * cell_A, MazeCell * cell_B ) {
   /* removing undirected edge */
   cell_A->removeNeighbor( cell_B );
   cell_B->removeNeighbor( cell_A );
+  setPassage( cell_A, cell_B, false );
 }
 
 /*******************************************************************************
-% Routine Name: clearWalls
+% Routine Name: setPassage
 % File:         Maze.cpp
-% Parameters:   None. 
-% Description:  Clears the maze such that no walls will exist - this will 
-%               create a fully connected maze (definition of wall).
-% Return:       Nothing. 
+% Parameters:   cell_A - a cell in this maze.
+%               cell_B - a cell in this maze.
+%               open   - true for an open passage, false for a wall.
+% Description:  Mirrors an edge change into the bit planes, and toggles the
+%               passage key into the hash when the bit actually flips.
+% Return:       Nothing.
 *******************************************************************************/
-void Maze::clearWalls() {
-  for( int row = 0; row < getHeight(); row++ ) {
-    for( int column = 0; column < getWidth(); column++ ) {
-      MazeCell * currentCell = at(row, column);
+void Maze::setPassage( MazeCell * cell_A, MazeCell * cell_B, bool open ) {
+  MazeCell * first = ( cell_A->row + cell_A->column < cell_B->row + cell_B->column )
+                     ? cell_A : cell_B;
+  MazeCell * second = ( first == cell_A ) ? cell_B : cell_A;
+  int orientation;
+  if( first->row == second->row && first->column + 1 == second->column ) {
+    orientation = 0;
+  }
+  else if( first->column == second->column && first->row + 1 == second->row ) {
+    orientation = 1;
+  }
+  else return; /* not adjacent */
+
+  std::vector<uint64_t> & plane = ( orientation == 0 ) ? right_plane : down_plane;
+  uint64_t & word = plane[ (size_t)first->row * plane_stride + first->column / 64 ];
+  uint64_t bit = (uint64_t)1 << ( first->column % 64 );
+  if( ((word & bit) != 0) == open ) return;
+  word ^= bit;
+  if( open ) MAZE_COUNT( EDGE_ADDS );
+  else MAZE_COUNT( EDGE_REMOVES );
+  zobrist ^= passageKey( width, first->row, first->column, orientation );
+  recordPassage( first->row, first->column, orientation );
+  invalidateSnapshotRow( first->row );
+}
+
+/*******************************************************************************
+% Routine Name: relinkCells
+% File:         Maze.cpp
+% Parameters:   None.
+% Description:  Rebuilds the up, right, down and left links of every cell
+%               directly from the bit planes, bands of rows across threads.
+% Return:       Nothing.
+*******************************************************************************/
+void Maze::relinkCells() {
+  MAZE_TRACE_SCOPE( "Maze::relinkCells" );
+  parallelForEachRow( [this]( int first_row, int last_row ) {
+    relinkRows( first_row, last_row );
+  } );
+}
 
-      if( !outOfBounds(row + 1, column) ) {
-	      /* vertical deviation downwards */
-	      removeWall( currentCell, at(row + 1, column) );
+/*******************************************************************************
+% Routine Name: relinkRows
+% File:         Maze.cpp
+% Parameters:   first_row - first row to relink.
+%               last_row  - row past the last row to relink.
+% Description:  Rebuilds the links of a band of rows from the bit planes.
+%               Bands only write to their own cells and can run in parallel.
+% Return:       Nothing.
+*******************************************************************************/
+void Maze::relinkRows( int first_row, int last_row ) {
+  for( int row = first_row; row < last_row; row++ ) {
+    const uint64_t * right_row = &right_plane[ (size_t)row * plane_stride ];
+    const uint64_t * down_row = &down_plane[ (size_t)row * plane_stride ];
+    const uint64_t * up_row = ( row > 0 ) ? down_row - plane_stride : nullptr;
+    for( int column = 0; column < width; column++ ) {
+      MazeCell & cell = maze[ cellIndex(row, column) ];
+      uint64_t bit = (uint64_t)1 << ( column % 64 );
+      int word = column / 64;
+      cell.right = ( right_row[ word ] & bit ) ? &maze[ cellIndex(row, column + 1) ]
+                                               : nullptr;
+      cell.down = ( down_row[ word ] & bit ) ? &maze[ cellIndex(row + 1, column) ]
+                                             : nullptr;
+      cell.up = ( up_row && (up_row[ word ] & bit) ) ? &maze[ cellIndex(row - 1, column) ]
+                                                     : nullptr;
+      cell.left = ( column > 0 && (right_row[ (column - 1) / 64 ] &
+        ((uint64_t)1 << ((column - 1) % 64))) ) ? &maze[ cellIndex(row, column - 1) ]
+                                                : nullptr;
+    }
+  }
+}
+
+/*******************************************************************************
+% Routine Name: invalidateSnapshotRow
+% File:         Maze.cpp
+% Parameters:   row - row whose passages changed.
+% Description:  Drops the cached snapshot block holding the row, so the next
+%               snapshot copies that block afresh.
+% Return:       Nothing.
+*******************************************************************************/
+void Maze::invalidateSnapshotRow( int row ) {
+  size_t block = row / MazeSnapshot::BLOCK_ROWS;
+  if( block < snapshot_blocks.size() ) snapshot_blocks[ block ].reset();
+}
+
+/*******************************************************************************
+% Routine Name: snapshot
+% File:         Maze.cpp
+% Parameters:   None.
+% Description:  Takes an immutable copy of the walls. Rows are stored in
+%               blocks of MazeSnapshot::BLOCK_ROWS, and only the blocks whose
+%               passages changed since the last snapshot are copied - the
+%               rest are shared with it.
+% Return:       The snapshot.
+*******************************************************************************/
+MazeSnapshot Maze::snapshot() {
+  MAZE_TRACE_SCOPE( "Maze::snapshot" );
+  const int block_rows = MazeSnapshot::BLOCK_ROWS;
+  snapshot_blocks.resize( (height + block_rows - 1) / block_rows );
+  for( size_t block = 0; block < snapshot_blocks.size(); block++ ) {
+    if( snapshot_blocks[ block ] ) continue;
+    int first_row = block * block_rows;
+    int rows = std::min( block_rows, height - first_row );
+    size_t begin = (size_t)first_row * plane_stride;
+    size_t end = begin + (size_t)rows * plane_stride;
+    std::shared_ptr<SnapshotBlock> copy( new SnapshotBlock() );
+    MAZE_COUNT( ALLOCATIONS );
+    copy->right.assign( right_plane.begin() + begin, right_plane.begin() + end );
+    copy->down.assign( down_plane.begin() + begin, down_plane.begin() + end );
+    snapshot_blocks[ block ] = copy;
+  }
+
+  MazeSnapshot snapshot;
+  snapshot.width = width;
+  snapshot.height = height;
+  snapshot.stride = plane_stride;
+  snapshot.hash = zobrist;
+  snapshot.blocks = snapshot_blocks;
+  return snapshot;
+}
+
+/*******************************************************************************
+% Routine Name: recordPassage
+% File:         Maze.cpp
+% Parameters:   row         - row of the cell left of or above the passage.
+%               column      - column of that cell.
+%               orientation - 0 for the passage to the right, 1 for below.
+% Description:  Appends a flipped passage to the journal. A fresh change
+%               invalidates everything that could have been redone.
+% Return:       Nothing.
+*******************************************************************************/
+void Maze::recordPassage( int row, int column, int orientation ) {
+  if( !journaling || replaying ) return;
+  uint32_t index = (uint32_t)row * width + column;
+  journal.push_back( (index << 1) | orientation );
+  redo_journal.clear();
+}
+
+/*******************************************************************************
+% Routine Name: replayPassage
+% File:         Maze.cpp
+% Parameters:   entry - journal entry of a passage.
+% Description:  Flips a passage through addWall or removeWall, so goal tables,
+%               listeners and the hash stay in step, without journaling it.
+% Return:       Nothing.
+*******************************************************************************/
+void Maze::replayPassage( uint32_t entry ) {
+  int index = entry >> 1;
+  int orientation = entry & 1;
+  MazeCell * first = at( index / width, index % width );
+  MazeCell * second = ( orientation == 0 ) ? at( first->row, first->column + 1 )
+                                           : at( first->row + 1, first->column );
+  const std::vector<uint64_t> & plane = ( orientation == 0 ) ? right_plane : down_plane;
+  bool open = ( plane[ (size_t)first->row * plane_stride + first->column / 64 ] >>
+                (first->column % 64) ) & 1;
+  replaying = true;
+  if( open ) addWall( first, second );
+  else removeWall( first, second );
+  replaying = false;
+}
+
+/*******************************************************************************
+% Routine Name: setJournaling
+% File:         Maze.cpp
+% Parameters:   enabled - true to record wall changes.
+% Description:  Starts or stops the journal. Either way the recorded history
+%               is discarded.
+% Return:       Nothing.
+*******************************************************************************/
+void Maze::setJournaling( bool enabled ) {
+  journaling = enabled;
+  journal.clear();
+  redo_journal.clear();
+}
+
+/*******************************************************************************
+% Routine Name: checkpoint
+% File:         Maze.cpp
+% Parameters:   None.
+% Description:  Marks the current journal position, starting the journal if
+%               it is not recording yet.
+% Return:       Position to hand to rollback.
+*******************************************************************************/
+size_t Maze::checkpoint() {
+  if( !journaling ) setJournaling( true );
+  return journal.size();
+}
+
+/*******************************************************************************
+% Routine Name: rollback
+% File:         Maze.cpp
+% Parameters:   checkpoint - position returned by checkpoint().
+% Description:  Undoes, newest first, every wall change recorded after the
+%               checkpoint. Costs one edge update per change.
+% Return:       False if the checkpoint is ahead of the journal.
+*******************************************************************************/
+bool Maze::rollback( size_t checkpoint ) {
+  if( checkpoint > journal.size() ) return false;
+  while( journal.size() > checkpoint ) undo();
+  return true;
+}
+
+/*******************************************************************************
+% Routine Name: undo
+% File:         Maze.cpp
+% Parameters:   None.
+% Description:  Undoes the most recent recorded wall change.
+% Return:       False if there is nothing to undo.
+*******************************************************************************/
+bool Maze::undo() {
+  if( journal.empty() ) return false;
+  uint32_t entry = journal.back();
+  journal.pop_back();
+  replayPassage( entry );
+  redo_journal.push_back( entry );
+  return true;
+}
+
+/*******************************************************************************
+% Routine Name: redo
+% File:         Maze.cpp
+% Parameters:   None.
+% Description:  Reapplies the most recently undone wall change.
+% Return:       False if there is nothing to redo.
+*******************************************************************************/
+bool Maze::redo() {
+  if( redo_journal.empty() ) return false;
+  uint32_t entry = redo_journal.back();
+  redo_journal.pop_back();
+  replayPassage( entry );
+  journal.push_back( entry );
+  return true;
+}
+
+/*******************************************************************************
+% Routine Name: diff
+% File:         Maze.cpp
+% Parameters:   maze_A - first maze.
+%               maze_B - second maze.
+% Description:  XORs the passage planes of both mazes a word at a time and
+%               lists the set bits of the result.
+% Return:       Every passage whose wall differs, empty if the dimensions
+%               differ.
+*******************************************************************************/
+std::vector<WallChange> Maze::diff( const Maze & maze_A, const Maze & maze_B ) {
+  std::vector<WallChange> changes;
+  if( maze_A.width != maze_B.width || maze_A.height != maze_B.height ) return changes;
+  if( maze_A.zobrist == maze_B.zobrist && maze_A == maze_B ) return changes;
+
+  const int stride = maze_A.plane_stride;
+  for( int orientation = 0; orientation < 2; orientation++ ) {
+    const std::vector<uint64_t> & plane_A = orientation ? maze_A.down_plane
+                                                        : maze_A.right_plane;
+    const std::vector<uint64_t> & plane_B = orientation ? maze_B.down_plane
+                                                        : maze_B.right_plane;
+    for( size_t index = 0; index < plane_A.size(); index++ ) {
+      uint64_t bits = plane_A[ index ] ^ plane_B[ index ];
+      while( bits ) {
+        int offset = __builtin_ctzll( bits );
+        bits &= bits - 1;
+        WallChange change;
+        change.row = index / stride;
+        change.column = ( index % stride ) * 64 + offset;
+        change.orientation = orientation;
+        /* the passage is open in A, so B has the wall */
+        change.added = ( plane_A[ index ] >> offset ) & 1;
+        changes.push_back( change );
       }
-      if( !outOfBounds(row, column + 1) ) {
-	      /* horizontal deviation to the right */
-	      removeWall( currentCell, at(row, column + 1) );
+    }
+  }
+  return changes;
+}
+
+/*******************************************************************************
+% Routine Name: passageKey
+% File:         Maze.cpp
+% Parameters:   width       - width of the maze.
+%               row         - row of the cell left of or above the passage.
+%               column      - column of that cell.
+%               orientation - 0 for the passage to the right, 1 for below.
+% Description:  Zobrist key of a passage. Keys are derived by hashing the
+%               passage index instead of being stored in a table.
+% Return:       64-bit pseudo-random key.
+*******************************************************************************/
+uint64_t Maze::passageKey( int width, int row, int column, int orientation ) {
+  uint64_t index = (uint64_t)row * width + column;
+  return MazeHelper::mix( (index << 1) | orientation );
+}
+
+/*******************************************************************************
+% Routine Name: wallsHash
+% File:         Maze.cpp
+% Parameters:   width  - width of the maze.
+%               height - height of the maze.
+% Description:  Zobrist hash of a maze with no open passages, the starting
+%               value that passage keys are toggled into.
+% Return:       64-bit hash of the dimensions.
+*******************************************************************************/
+uint64_t Maze::wallsHash( int width, int height ) {
+  return MazeHelper::mix( ((uint64_t)(uint32_t)width << 32) | (uint32_t)height );
+}
+
+/*******************************************************************************
+% Routine Name: getRightPlane
+% File:         Maze.cpp
+% Parameters:   None.
+% Description:  Read-only access to the packed plane of passages right of
+%               every cell. Bit (column % 64) of word row * stride +
+%               column / 64 is set if the passage is open.
+% Return:       The plane words.
+*******************************************************************************/
+const std::vector<uint64_t> & Maze::getRightPlane() const {
+  return right_plane;
+}
+
+/*******************************************************************************
+% Routine Name: getDownPlane
+% File:         Maze.cpp
+% Parameters:   None.
+% Description:  Read-only access to the packed plane of passages below every
+%               cell, laid out like the right plane.
+% Return:       The plane words.
+*******************************************************************************/
+const std::vector<uint64_t> & Maze::getDownPlane() const {
+  return down_plane;
+}
+
+/*******************************************************************************
+% Routine Name: getPlaneStride
+% File:         Maze.cpp
+% Parameters:   None.
+% Description:  Getter method for the words per row of a passage plane.
+% Return:       Width of the maze rounded up to whole 64-bit words.
+*******************************************************************************/
+int Maze::getPlaneStride() const {
+  return plane_stride;
+}
+
+/*******************************************************************************
+% Routine Name: setPassagePlanes
+% File:         Maze.cpp
+% Parameters:   right - packed passages right of every cell.
+%               down  - packed passages below every cell.
+% Description:  Replaces every wall of the maze in bulk. Passages leading out
+%               of the maze are ignored. Neighbor links are rebuilt directly
+%               from the planes, and only the passages that actually changed
+%               are reported to goal tables, and to listeners in one batch.
+% Return:       False if the planes do not match the maze dimensions.
+*******************************************************************************/
+bool Maze::setPassagePlanes( const std::vector<uint64_t> & right,
+  const std::vector<uint64_t> & down ) {
+
+  if( right.size() != right_plane.size() || down.size() != down_plane.size() ) {
+    return false;
+  }
+  MAZE_TRACE_SCOPE( "Maze::setPassagePlanes" );
+  std::vector<uint64_t> changed_right( right_plane.size() );
+  std::vector<uint64_t> changed_down( down_plane.size() );
+
+  for( int row = 0; row < getHeight(); row++ ) {
+    for( int word = 0; word < plane_stride; word++ ) {
+      size_t index = (size_t)row * plane_stride + word;
+      /* mask off passages through the right and bottom boundary */
+      int bits = std::min( 64, getWidth() - 1 - word * 64 );
+      uint64_t right_mask = ( bits <= 0 ) ? 0 :
+        ( bits == 64 ) ? ~(uint64_t)0 : ( ((uint64_t)1 << bits) - 1 );
+      bits = std::min( 64, getWidth() - word * 64 );
+      uint64_t down_mask = ( row == getHeight() - 1 ) ? 0 :
+        ( bits == 64 ) ? ~(uint64_t)0 : ( ((uint64_t)1 << bits) - 1 );
+
+      changed_right[ index ] = ( right[ index ] & right_mask ) ^ right_plane[ index ];
+      changed_down[ index ] = ( down[ index ] & down_mask ) ^ down_plane[ index ];
+      right_plane[ index ] ^= changed_right[ index ];
+      down_plane[ index ] ^= changed_down[ index ];
+    }
+  }
+
+  relinkCells();
+
+  /* hash, goal tables and listeners see only the flipped passages */
+  std::vector<WallChange> changes;
+  for( int orientation = 0; orientation < 2; orientation++ ) {
+    std::vector<uint64_t> & changed = ( orientation == 0 ) ? changed_right : changed_down;
+    std::vector<uint64_t> & plane = ( orientation == 0 ) ? right_plane : down_plane;
+    for( size_t index = 0; index < changed.size(); index++ ) {
+      uint64_t bits = changed[ index ];
+      while( bits ) {
+        int row = index / plane_stride;
+        int column = ( index % plane_stride ) * 64 + __builtin_ctzll( bits );
+        bits &= bits - 1;
+        MazeCell * first = &maze[ cellIndex(row, column) ];
+        MazeCell * second = ( orientation == 0 ) ? &maze[ cellIndex(row, column + 1) ]
+                                                 : &maze[ cellIndex(row + 1, column) ];
+        bool opened = ( plane[ index ] >> (column % 64) ) & 1;
+        if( opened ) MAZE_COUNT( EDGE_ADDS );
+        else MAZE_COUNT( EDGE_REMOVES );
+        zobrist ^= passageKey( width, row, column, orientation );
+        recordPassage( row, column, orientation );
+        invalidateSnapshotRow( row );
+        invalidateGoalTables( first, second, !opened );
+        if( !listeners.empty() ) {
+          WallChange change = { row, column, orientation, !opened };
+          changes.push_back( change );
+        }
       }
     }
   }
+  notifyWallsChanged( changes.data(), changes.size() );
+  return true;
+}
+
+/*******************************************************************************
+% Routine Name: getHash
+% File:         Maze.cpp
+% Parameters:   None.
+% Description:  Zobrist hash of the maze dimensions and open passages. It is
+%               updated in constant time by every wall change.
+% Return:       64-bit hash - equal mazes always have equal hashes.
+*******************************************************************************/
+uint64_t Maze::getHash() const {
+  return zobrist;
+}
+
+/*******************************************************************************
+% Routine Name: clearWalls
+% File:         Maze.cpp
+% Parameters:   None. 
+% Description:  Clears the maze such that no walls will exist - this will 
+%               create a fully connected maze (definition of wall). The planes
+%               are filled a word at a time and the cells relinked in bulk.
+% Return:       Nothing. 
+*******************************************************************************/
+void Maze::clearWalls() {
+  /* every passage open - setPassagePlanes masks off the boundary */
+  std::vector<uint64_t> open( right_plane.size(), ~(uint64_t)0 );
+  setPassagePlanes( open, open );
 }
 
 /*******************************************************************************
@@ -126,6 +748,8 @@ void Maze::clearWalls() {
 void Maze::addWall( MazeCell * cell_A, MazeCell * cell_B ) {
   if( cell_A == nullptr || cell_B == nullptr ) return;
   removeEdge( cell_A, cell_B );
+  invalidateGoalTables( cell_A, cell_B, true );
+  notifyWallChanged( cell_A, cell_B );
 }
 
 /*******************************************************************************
@@ -139,20 +763,278 @@ void Maze::addWall( MazeCell * cell_A, MazeCell * cell_B ) {
 void Maze::removeWall( MazeCell * cell_A, MazeCell * cell_B ) {
   if( cell_A == nullptr || cell_B == nullptr ) return;
   addEdge( cell_A, cell_B );
+  invalidateGoalTables( cell_A, cell_B, false );
+  notifyWallChanged( cell_A, cell_B );
+}
+
+/*******************************************************************************
+% Routine Name: applyWalls
+% File:         Maze.cpp
+% Parameters:   cell   - a cell in this maze.
+%               walls  - mask of WALL_UP, WALL_RIGHT, WALL_DOWN and WALL_LEFT
+%                        set for every side with a wall.
+%               sensed - mask of the sides the walls mask reports on, the
+%                        rest are left as they are.
+% Description:  Applies one sensor reading around a cell. Each sensed side is
+%               written straight into the bit planes and the links of both
+%               cells, and listeners are notified once for the whole reading.
+%               Sides on the maze boundary are always walled. Errors are
+%               reported through the return value only.
+% Return:       Number of walls that changed, INVALID_CELL if the cell is not
+%               in this maze, or OPEN_BOUNDARY if an opening was reported on
+%               the maze boundary - in which case nothing is applied.
+*******************************************************************************/
+int Maze::applyWalls( MazeCell * cell, int walls, int sensed ) {
+  if( cell == nullptr || outOfBounds(cell->row, cell->column) ||
+      &maze[ cellIndex(cell->row, cell->column) ] != cell ) {
+    return INVALID_CELL;
+  }
+  const int row = cell->row;
+  const int column = cell->column;
+  const int boundary = ( row == 0 ) * WALL_UP | ( column == width - 1 ) * WALL_RIGHT |
+                       ( row == height - 1 ) * WALL_DOWN | ( column == 0 ) * WALL_LEFT;
+  const int open = ~walls & sensed & ALL_SIDES;
+  if( open & boundary ) return OPEN_BOUNDARY;
+  sensed &= ~boundary;
+
+  WallChange changes[ 4 ];
+  int count = 0;
+  if( sensed & WALL_UP ) {
+    count += applyPassage( row - 1, column, 1, open & WALL_UP, &changes[ count ] );
+  }
+  if( sensed & WALL_RIGHT ) {
+    count += applyPassage( row, column, 0, open & WALL_RIGHT, &changes[ count ] );
+  }
+  if( sensed & WALL_DOWN ) {
+    count += applyPassage( row, column, 1, open & WALL_DOWN, &changes[ count ] );
+  }
+  if( sensed & WALL_LEFT ) {
+    count += applyPassage( row, column - 1, 0, open & WALL_LEFT, &changes[ count ] );
+  }
+  notifyWallsChanged( changes, count );
+  return count;
+}
+
+/*******************************************************************************
+% Routine Name: applyWalls
+% File:         Maze.cpp
+% Parameters:   first_row    - top row of the block.
+%               first_column - left column of the block.
+%               rows         - number of rows in the block.
+%               columns      - number of columns in the block.
+%               walls        - rows x columns wall masks in row-major order.
+% Description:  Bulk import of the walls of a block of cells. The masks are
+%               validated before anything is written: adjacent cells must
+%               agree on their shared wall and the maze boundary must stay
+%               walled. Listeners are notified once for the whole block.
+% Return:       Number of walls that changed, INVALID_CELL if the block does
+%               not fit in the maze, OPEN_BOUNDARY or INCONSISTENT_WALLS.
+*******************************************************************************/
+int Maze::applyWalls( int first_row, int first_column, int rows, int columns,
+  const uint8_t * walls ) {
+
+  if( walls == nullptr || first_row < 0 || first_column < 0 || rows < 0 ||
+      columns < 0 || first_row + rows > height || first_column + columns > width ) {
+    return INVALID_CELL;
+  }
+  for( int row = 0; row < rows; row++ ) {
+    for( int column = 0; column < columns; column++ ) {
+      const int mask = walls[ row * columns + column ];
+      const int maze_row = first_row + row;
+      const int maze_column = first_column + column;
+      const int boundary = ( maze_row == 0 ) * WALL_UP |
+        ( maze_column == width - 1 ) * WALL_RIGHT |
+        ( maze_row == height - 1 ) * WALL_DOWN | ( maze_column == 0 ) * WALL_LEFT;
+      if( ~mask & boundary ) return OPEN_BOUNDARY;
+      /* right wall against the left wall of the next cell, down against up */
+      if( column + 1 < columns &&
+          ((mask >> 1 ^ walls[ row * columns + column + 1 ] >> 3) & 1) ) {
+        return INCONSISTENT_WALLS;
+      }
+      if( row + 1 < rows &&
+          ((mask >> 2 ^ walls[ (row + 1) * columns + column ]) & 1) ) {
+        return INCONSISTENT_WALLS;
+      }
+    }
+  }
+
+  std::vector<WallChange> changes;
+  WallChange change;
+  for( int row = 0; row < rows; row++ ) {
+    for( int column = 0; column < columns; column++ ) {
+      const int mask = walls[ row * columns + column ];
+      const int maze_row = first_row + row;
+      const int maze_column = first_column + column;
+      if( row == 0 && maze_row > 0 &&
+          applyPassage(maze_row - 1, maze_column, 1, !(mask & WALL_UP), &change) ) {
+        changes.push_back( change );
+      }
+      if( column == 0 && maze_column > 0 &&
+          applyPassage(maze_row, maze_column - 1, 0, !(mask & WALL_LEFT), &change) ) {
+        changes.push_back( change );
+      }
+      if( maze_column < width - 1 &&
+          applyPassage(maze_row, maze_column, 0, !(mask & WALL_RIGHT), &change) ) {
+        changes.push_back( change );
+      }
+      if( maze_row < height - 1 &&
+          applyPassage(maze_row, maze_column, 1, !(mask & WALL_DOWN), &change) ) {
+        changes.push_back( change );
+      }
+    }
+  }
+  notifyWallsChanged( changes.data(), changes.size() );
+  return changes.size();
+}
+
+/*******************************************************************************
+% Routine Name: applyPassage
+% File:         Maze.cpp
+% Parameters:   row         - row of the cell left of or above the passage.
+%               column      - column of that cell.
+%               orientation - 0 for the passage to the right, 1 for below.
+%               open        - true for an open passage, false for a wall.
+%               change      - filled in with the change, if any.
+% Description:  Writes one passage into the bit plane, the links of both
+%               cells, the hash, the journal, the snapshot cache and the goal
+%               tables. Listeners are left to the caller.
+% Return:       True if the passage flipped.
+*******************************************************************************/
+bool Maze::applyPassage( int row, int column, int orientation, bool open,
+  WallChange * change ) {
+
+  std::vector<uint64_t> & plane = orientation ? down_plane : right_plane;
+  uint64_t & word = plane[ (size_t)row * plane_stride + column / 64 ];
+  const uint64_t bit = (uint64_t)1 << ( column % 64 );
+  const uint64_t flip = ( word ^ (-(uint64_t)open) ) & bit;
+  if( flip == 0 ) return false;
+  word ^= flip;
+  if( open ) MAZE_COUNT( EDGE_ADDS );
+  else MAZE_COUNT( EDGE_REMOVES );
+
+  MazeCell & first = maze[ cellIndex(row, column) ];
+  MazeCell & second = orientation ? maze[ cellIndex(row + 1, column) ]
+                                   : maze[ cellIndex(row, column + 1) ];
+  MazeCell * & first_link = orientation ? first.down : first.right;
+  MazeCell * & second_link = orientation ? second.up : second.left;
+  first_link = open ? &second : nullptr;
+  second_link = open ? &first : nullptr;
+
+  zobrist ^= passageKey( width, row, column, orientation );
+  recordPassage( row, column, orientation );
+  invalidateSnapshotRow( row );
+  invalidateGoalTables( &first, &second, !open );
+  change->row = row;
+  change->column = column;
+  change->orientation = orientation;
+  change->added = !open;
+  return true;
+}
+
+/*******************************************************************************
+% Routine Name: addListener
+% File:         Maze.cpp
+% Parameters:   listener - object caching state derived from the maze walls.
+% Description:  Attaches a listener to be notified of every wall change. The
+%               listener must be removed before it is destroyed.
+% Return:       Nothing.
+*******************************************************************************/
+void Maze::addListener( MazeListener * listener ) {
+  if( listener == nullptr ) return;
+  for( MazeListener * attached : listeners ) {
+    /* listener is already attached */
+    if( attached == listener ) return;
+  }
+  listeners.push_back( listener );
+}
+
+/*******************************************************************************
+% Routine Name: removeListener
+% File:         Maze.cpp
+% Parameters:   listener - a previously attached listener.
+% Description:  Detaches the listener from wall change notifications.
+% Return:       Nothing.
+*******************************************************************************/
+void Maze::removeListener( MazeListener * listener ) {
+  for( size_t index = 0; index < listeners.size(); index++ ) {
+    if( listeners[ index ] == listener ) {
+      listeners.erase( listeners.begin() + index );
+      return;
+    }
+  }
+}
+
+/*******************************************************************************
+% Routine Name: notifyWallChanged
+% File:         Maze.cpp
+% Parameters:   cell_A - a cell in this maze.
+%               cell_B - a cell in this maze.
+% Description:  Informs all attached listeners that the wall between the given
+%               cells was added or removed.
+% Return:       Nothing.
+*******************************************************************************/
+void Maze::notifyWallChanged( MazeCell * cell_A, MazeCell * cell_B ) {
+  for( MazeListener * listener : listeners ) {
+    listener->wallChanged( cell_A, cell_B );
+  }
+}
+
+/*******************************************************************************
+% Routine Name: notifyWallsChanged
+% File:         Maze.cpp
+% Parameters:   changes - passages that flipped.
+%               count   - number of changes.
+% Description:  Informs every attached listener of a batch of wall changes
+%               with a single call each.
+% Return:       Nothing.
+*******************************************************************************/
+void Maze::notifyWallsChanged( const WallChange * changes, int count ) {
+  if( count == 0 ) return;
+  for( MazeListener * listener : listeners ) {
+    listener->wallsChanged( *this, changes, count );
+  }
+}
+
+/*******************************************************************************
+% Routine Name: wallsChanged
+% File:         Maze.cpp
+% Parameters:   maze    - maze whose walls changed.
+%               changes - passages that flipped.
+%               count   - number of changes.
+% Description:  Default batch notification - forwards every change to
+%               wallChanged. Listeners that can handle a batch at once
+%               override it.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeListener::wallsChanged( Maze & maze, const WallChange * changes,
+  int count ) {
+
+  for( int index = 0; index < count; index++ ) {
+    const WallChange & change = changes[ index ];
+    MazeCell * cell = maze.at( change.row, change.column );
+    MazeCell * neighbor = change.orientation ? maze.at( change.row + 1, change.column )
+                                             : maze.at( change.row, change.column + 1 );
+    wallChanged( cell, neighbor );
+  }
 }
 
 /*******************************************************************************
 % Routine Name: clear
 % File:         Maze.cpp
 % Parameters:   None.
-% Description:  Clears all internal data of cell relationships in maze.
+% Description:  Clears all internal data of cell relationships in maze. Every
+%               open passage is walled through setPassagePlanes, so the bit
+%               planes, hash, journal, goal tables and listeners follow, then
+%               the search data of the cells is reset in parallel.
 % Return:       Nothing. 
 *******************************************************************************/
 void Maze::clear() {
-  for( MazeCell * cell : *this ) {
+  setPassagePlanes( std::vector<uint64_t>(right_plane.size()),
+                    std::vector<uint64_t>(down_plane.size()) );
+  parallelForEachCell( []( MazeCell * cell ) {
     /* clear data for all cells in maze */
     cell->clearData();
-  }
+  } );
 }
 
 /*******************************************************************************
@@ -175,10 +1057,11 @@ MazeCell * Maze::at( std::pair<int, int> & coordinate ) {
 % Return:       MazeCell pointer at (row, col) position in 2-dimensional maze. 
 *******************************************************************************/
 MazeCell * Maze::at( int row, int column ) {
+  MAZE_COUNT( AT_CALLS );
   if( outOfBounds(row, column) ) {
     return nullptr;
   }
-  return &maze[ row ][ column ];
+  return &maze[ cellIndex(row, column) ];
 }
 
 /*******************************************************************************
@@ -218,28 +1101,104 @@ bool Maze::outOfBounds( int row, int column) {
 }
 
 /*******************************************************************************
-% Routine Name: getAdjacentCellList
+% Routine Name: getAdjacentCellList
+% File:         Maze.cpp
+% Parameters:   cell - the cell of interest in the maze.
+% Description:  Gets all global adjacent neighbors of cell in maze.
+% Return:       A list of all existing adjacent neighbors of cell in maze.
+*******************************************************************************/
+std::vector<MazeCell *> Maze::getAdjacentCellList( MazeCell * cell ) {
+  MAZE_COUNT( NEIGHBOR_QUERIES );
+  if( cell == nullptr ) return std::vector<MazeCell *>();
+  const int MAX_CELLS = 4;
+  const int EVEN = 2;
+  std::vector<MazeCell *> list;
+
+  for( int index = 0; index < MAX_CELLS; index++ ) {
+    /* append all adjacent neighbors to list */
+    int deviation = ( index < EVEN ) ? -1 : +1;
+    int dr = ( index % EVEN == 0 ) ? deviation : 0;
+    int dc = ( index % EVEN == 1 ) ? -deviation : 0;
+    if( !outOfBounds(cell->row + dr, cell->column + dc) ) { 
+      list.push_back( at(cell->row + dr, cell->column + dc) );
+    }
+  }
+  return list;
+}
+
+/*******************************************************************************
+% Routine Name: cellIndex
+% File:         Maze.cpp
+% Parameters:   row    - row of a cell in the maze.
+%               column - column of a cell in the maze.
+% Description:  Maps a location to its position in storage. Tiles are 8x8
+%               cells. Morton squares are up to 64x64 cells in Z-order, and
+%               follow each other in row-major order like tiles.
+% Return:       Index of the cell in storage.
+*******************************************************************************/
+size_t Maze::cellIndex( int row, int column ) const {
+  if( layout == ROW_MAJOR ) return (size_t)row * width + column;
+  if( layout == TILED ) {
+    size_t tile = (size_t)( row >> 3 ) * tile_columns + ( column >> 3 );
+    return ( tile << 6 ) | ( (row & 7) << 3 ) | ( column & 7 );
+  }
+  const uint32_t mask = ( 1u << morton_bits ) - 1;
+  const size_t square = (size_t)( row >> morton_bits ) * tile_columns +
+                        ( column >> morton_bits );
+  return ( square << (2 * morton_bits) ) |
+         ( MazeHelper::spreadBits(row & mask) << 1 ) |
+         MazeHelper::spreadBits( column & mask );
+}
+
+/*******************************************************************************
+% Routine Name: cellLocation
+% File:         Maze.cpp
+% Parameters:   index  - position in storage.
+%               row    - set to the row of the cell stored there.
+%               column - set to the column of the cell stored there.
+% Description:  Inverse of cellIndex. Padding positions of the tiled and
+%               Morton layouts map to locations outside the maze.
+% Return:       Nothing.
+*******************************************************************************/
+void Maze::cellLocation( size_t index, int & row, int & column ) const {
+  if( layout == ROW_MAJOR ) {
+    row = index / width;
+    column = index % width;
+  }
+  else if( layout == TILED ) {
+    size_t tile = index >> 6;
+    row = ( tile / tile_columns ) * 8 + ( (index >> 3) & 7 );
+    column = ( tile % tile_columns ) * 8 + ( index & 7 );
+  }
+  else {
+    const uint64_t local = index & ( ((size_t)1 << (2 * morton_bits)) - 1 );
+    const size_t square = index >> ( 2 * morton_bits );
+    row = ( (square / tile_columns) << morton_bits ) + MazeHelper::compactBits( local >> 1 );
+    column = ( (square % tile_columns) << morton_bits ) + MazeHelper::compactBits( local );
+  }
+}
+
+/*******************************************************************************
+% Routine Name: getLayout
 % File:         Maze.cpp
-% Parameters:   cell - the cell of interest in the maze.
-% Description:  Gets all global adjacent neighbors of cell in maze.
-% Return:       A list of all existing adjacent neighbors of cell in maze.
+% Parameters:   None.
+% Description:  Getter method for the order of the cells in memory.
+% Return:       ROW_MAJOR, TILED or MORTON.
 *******************************************************************************/
-std::vector<MazeCell *> Maze::getAdjacentCellList( MazeCell * cell ) {
-  if( cell == nullptr ) return std::vector<MazeCell *>();
-  const int MAX_CELLS = 4;
-  const int EVEN = 2;
-  std::vector<MazeCell *> list;
+Maze::Layout Maze::getLayout() const {
+  return layout;
+}
 
-  for( int index = 0; index < MAX_CELLS; index++ ) {
-    /* append all adjacent neighbors to list */
-    int deviation = ( index < EVEN ) ? -1 : +1;
-    int dr = ( index % EVEN == 0 ) ? deviation : 0;
-    int dc = ( index % EVEN == 1 ) ? -deviation : 0;
-    if( !outOfBounds(cell->row + dr, cell->column + dc) ) { 
-      list.push_back( at(cell->row + dr, cell->column + dc) );
-    }
-  }
-  return list;
+/*******************************************************************************
+% Routine Name: getStorageSize
+% File:         Maze.cpp
+% Parameters:   None.
+% Description:  Getter method for the cells held in storage. Tiled and Morton
+%               layouts pad the maze up to whole tiles or squares.
+% Return:       Number of cells stored.
+*******************************************************************************/
+size_t Maze::getStorageSize() const {
+  return maze.size();
 }
 
 /*******************************************************************************
@@ -249,7 +1208,7 @@ std::vector<MazeCell *> Maze::getAdjacentCellList( MazeCell * cell ) {
 % Description:  Getter method for the width, in unit cells, of the maze.
 % Return:       The width of the maze in unit of cells.
 *******************************************************************************/
-int Maze::getWidth() {
+int Maze::getWidth() const {
   return width;
 }
 
@@ -260,7 +1219,7 @@ int Maze::getWidth() {
 % Description:  Getter method for the height, in unit cells, of the maze.
 % Return:       The height of the maze in units of cells.
 *******************************************************************************/
-int Maze::getHeight() {
+int Maze::getHeight() const {
   return height;
 }
 
@@ -273,6 +1232,7 @@ int Maze::getHeight() {
 *******************************************************************************/
 bool Maze::save( const char * filename ) {
   #ifndef ARDUINO
+  MAZE_TRACE_SCOPE( "Maze::save" );
   std::ofstream outstream;
   outstream.open( filename, std::ios::out | std::ios::binary );
   std::cerr << "Saving Maze..." << std::endl;
@@ -295,6 +1255,7 @@ bool Maze::save( const char * filename ) {
 *******************************************************************************/
 bool Maze::load( const char * filename ) {
   #ifndef ARDUINO
+  MAZE_TRACE_SCOPE( "Maze::load" );
   std::ifstream instream;
   instream.open( filename, std::ios::in | std::ios::binary );
   std::cerr << "Loading Maze..." << std::endl;
@@ -308,6 +1269,108 @@ bool Maze::load( const char * filename ) {
   #endif
 }
 
+#if !defined( ARDUINO )
+/*******************************************************************************
+% Routine Name: saveAsync
+% File:         Maze.cpp
+% Parameters:   filename - File to save the maze to.
+%               done     - optional callback, invoked on the worker thread
+%                          with the save status before the future is ready.
+% Description:  Takes a snapshot - the only work done on the calling thread,
+%               and it copies just the row blocks changed since the last one -
+%               and leaves encoding and writing to a detached worker. The maze
+%               may be changed as soon as this returns; the file holds the
+%               walls at the time of the call. The worker writes a temporary
+%               file next to the target and renames it over the target, so an
+%               interrupted save never leaves a partial maze behind. Wait on
+%               the future before exiting, or before starting another save to
+%               the same file, to keep the saves in order.
+% Return:       Future of the save status.
+*******************************************************************************/
+std::future<bool> Maze::saveAsync( const char * filename,
+  std::function<void( bool )> done ) {
+
+  std::shared_ptr<std::promise<bool>> status( new std::promise<bool>() );
+  std::future<bool> result = status->get_future();
+  MazeSnapshot copy = snapshot();
+  std::string path( filename );
+
+  std::thread( [copy, path, done, status]() {
+    bool saved = MazeHelper::writeSnapshot( copy, path );
+    if( done ) done( saved );
+    status->set_value( saved );
+  } ).detach();
+  return result;
+}
+#endif
+
+/*******************************************************************************
+% Routine Name: decodeDimensions
+% File:         Maze.cpp
+% Parameters:   data   - bytes of a file written by save.
+%               size   - number of bytes.
+%               width  - output width of the stored maze.
+%               height - output height of the stored maze.
+% Description:  Reads the big endian header and checks that the size matches
+%               the cell data it announces.
+% Return:       True if the bytes hold a saved maze.
+*******************************************************************************/
+bool Maze::decodeDimensions( const uint8_t * data, size_t size, int & width,
+  int & height ) {
+
+  if( data == nullptr || size < 2 * sizeof(uint32_t) ) return false;
+  uint32_t header[ 2 ];
+  for( int field = 0; field < 2; field++ ) {
+    const uint8_t * bytes = data + field * sizeof( uint32_t );
+    header[ field ] = (uint32_t)bytes[ 0 ] << 24 | (uint32_t)bytes[ 1 ] << 16 |
+                      (uint32_t)bytes[ 2 ] << 8 | bytes[ 3 ];
+  }
+  if( header[ 0 ] == 0 || header[ 1 ] == 0 || header[ 0 ] > INT_MAX ||
+      header[ 1 ] > INT_MAX ) {
+    return false;
+  }
+  width = header[ 0 ];
+  height = header[ 1 ];
+  const unsigned long long cells = (unsigned long long)width * height;
+  return size == 2 * sizeof( uint32_t ) + ( 2 * cells + CHAR_BIT - 1 ) / CHAR_BIT;
+}
+
+/*******************************************************************************
+% Routine Name: decode
+% File:         Maze.cpp
+% Parameters:   data - bytes of a file written by save.
+%               size - number of bytes.
+% Description:  In-memory counterpart of load for callers that read files
+%               themselves. The 2-bit codewords are unpacked straight into
+%               passage planes and applied with setPassagePlanes, and nothing
+%               is printed.
+% Return:       False if the bytes are not a saved maze of these dimensions,
+%               in which case the maze is left as it was.
+*******************************************************************************/
+bool Maze::decode( const uint8_t * data, size_t size ) {
+  int read_width, read_height;
+  if( !decodeDimensions(data, size, read_width, read_height) ||
+      read_width != width || read_height != height ) {
+    return false;
+  }
+  MAZE_TRACE_SCOPE( "Maze::decode" );
+  MAZE_COUNT_ADD( BYTES_READ, size );
+  const uint8_t * cells = data + 2 * sizeof( uint32_t );
+  std::vector<uint64_t> right( right_plane.size(), 0 );
+  std::vector<uint64_t> down( down_plane.size(), 0 );
+  size_t cell = 0;
+  for( int row = 0; row < height; row++ ) {
+    for( int column = 0; column < width; column++, cell++ ) {
+      /* codewords fill each byte from the top - down bit, then right bit */
+      const int codeword = cells[ cell / 4 ] >> ( 6 - 2 * (cell % 4) );
+      const size_t word = (size_t)row * plane_stride + column / 64;
+      right[ word ] |= (uint64_t)( codeword & 0x1 ) << ( column % 64 );
+      down[ word ] |= (uint64_t)( (codeword >> 1) & 0x1 ) << ( column % 64 );
+    }
+  }
+  return setPassagePlanes( right, down );
+}
+
 /*******************************************************************************
 % Routine Name: serialize
 % File:         Maze.cpp
@@ -321,7 +1384,7 @@ bool Maze::serialize( std::ofstream & outstream ) {
   int bitcount = 0;
   /* write dimensions of maze out to stream - order: width height */
   int w = ntohl(width);
-  int h = ntohl(width);
+  int h = ntohl(height);
   outstream.write( (char *) &w, sizeof(width) );
   outstream.write( (char *) &h, sizeof(height) );
 
@@ -349,6 +1412,8 @@ bool Maze::serialize( std::ofstream & outstream ) {
     data = data << (CHAR_BIT - bitcount); /* trailing zeros only */
     outstream.write( (char *) &data, sizeof(char)); 
   }
+  MAZE_COUNT_ADD( BYTES_WRITTEN, 2 * sizeof(int) +
+    ( 2 * (size_t)getWidth() * getHeight() + CHAR_BIT - 1 ) / CHAR_BIT );
   return true;
   #endif
 }
@@ -368,6 +1433,7 @@ bool Maze::deserialize( std::ifstream & instream ) {
   /* read dimensions of maze from input stream - order: width height */
   char buffer[BUFSIZ] = { 0 };
   instream.read( buffer, 2 * sizeof(int) );
+  MAZE_COUNT_ADD( BYTES_READ, instream.gcount() );
   if( !instream ) {
     /* corrupted datafile - missing bytes */
     std::cerr << "Currupted file detected: Incompatible file size: Aborting maze build" << std::endl; 
@@ -392,6 +1458,7 @@ bool Maze::deserialize( std::ifstream & instream ) {
   int column = 0;
   clearWalls(); /* creating walls are easier than removing walls */
   instream.read(buffer, sizeof(char)); /* read byte */
+  MAZE_COUNT_ADD( BYTES_READ, instream.gcount() );
   memcpy(&recieved, buffer, sizeof(char));
   while( instream ) {
     /* reading 2-bit codewords. (1 codeword = 1 encoded maze node) */
@@ -420,6 +1487,7 @@ bool Maze::deserialize( std::ifstream & instream ) {
 	    }
     }
     instream.read(buffer, sizeof(char));
+    MAZE_COUNT_ADD( BYTES_READ, instream.gcount() );
     memcpy(&recieved, buffer, sizeof(char));
   }
 
@@ -507,6 +1575,260 @@ int Maze::deserializeHeight( const char * filename ) {
   #endif
 }
 
+/*******************************************************************************
+% Routine Name: addGoalSet
+% File:         Maze.cpp
+% Parameters:   goals - cells of this maze to measure distances to.
+% Description:  Registers a goal set and builds its distance table. The table
+%               is kept up to date across wall changes, and stored in the
+%               narrowest integer width that fits the maze.
+% Return:       Identifier of the goal set, -1 if goals is empty or invalid.
+*******************************************************************************/
+int Maze::addGoalSet( const std::vector<MazeCell *> & goals ) {
+  std::vector<int> indices;
+  for( MazeCell * goal : goals ) {
+    if( goal == nullptr || at(goal->row, goal->column) != goal ) return -1;
+    indices.push_back( goal->row * getWidth() + goal->column );
+  }
+  if( indices.empty() ) return -1;
+  std::sort( indices.begin(), indices.end() );
+  indices.erase( std::unique(indices.begin(), indices.end()), indices.end() );
+
+  for( size_t goal_set = 0; goal_set < goal_tables.size(); goal_set++ ) {
+    /* goal set is already registered */
+    if( goal_tables[ goal_set ].goals == indices ) return goal_set;
+  }
+  goal_tables.push_back( DistanceTable(indices, getWidth() * getHeight()) );
+  buildGoalTable( goal_tables.back() );
+  return goal_tables.size() - 1;
+}
+
+/*******************************************************************************
+% Routine Name: clearGoalSets
+% File:         Maze.cpp
+% Parameters:   None.
+% Description:  Removes all registered goal sets and their distance tables.
+% Return:       Nothing.
+*******************************************************************************/
+void Maze::clearGoalSets() {
+  goal_tables.clear();
+}
+
+/*******************************************************************************
+% Routine Name: goalDistance
+% File:         Maze.cpp
+% Parameters:   goal_set - identifier returned by addGoalSet.
+%               row      - row of cell in maze.
+%               column   - column of cell in maze.
+% Description:  overloaded - delegates to goalDistance(goal_set, cell).
+% Return:       Distance to the nearest goal, -1 if unreachable.
+*******************************************************************************/
+int Maze::goalDistance( int goal_set, int row, int column ) {
+  return goalDistance( goal_set, at(row, column) );
+}
+
+/*******************************************************************************
+% Routine Name: goalDistance
+% File:         Maze.cpp
+% Parameters:   goal_set - identifier returned by addGoalSet.
+%               cell     - a cell in this maze.
+% Description:  Table lookup of the distance from a cell to the nearest cell
+%               of a registered goal set. A table made stale by a wall change
+%               is recomputed on its next lookup.
+% Return:       Distance to the nearest goal, -1 if unreachable or invalid.
+*******************************************************************************/
+int Maze::goalDistance( int goal_set, MazeCell * cell ) {
+  if( cell == nullptr ) return -1;
+  if( goal_set < 0 || goal_set >= (int)goal_tables.size() ) return -1;
+  DistanceTable & table = goal_tables[ goal_set ];
+  if( table.stale ) buildGoalTable( table );
+  uint32_t distance = table.get( cell->row * getWidth() + cell->column );
+  return ( distance == table.unreachable() ) ? -1 : (int)distance;
+}
+
+/*******************************************************************************
+% Routine Name: buildGoalTable
+% File:         Maze.cpp
+% Parameters:   table - distance table of a goal set.
+% Description:  Multi-source breadth first search from every goal of the set.
+% Return:       Nothing.
+*******************************************************************************/
+void Maze::buildGoalTable( DistanceTable & table ) {
+  MAZE_TRACE_SCOPE( "Maze::buildGoalTable" );
+  const int cells = getWidth() * getHeight();
+  std::vector<int> queue( cells );
+  int head = 0;
+  int tail = 0;
+
+  for( int index = 0; index < cells; index++ ) {
+    table.set( index, table.unreachable() );
+  }
+  for( int goal : table.goals ) {
+    table.set( goal, 0 );
+    queue[ tail++ ] = goal;
+  }
+  while( head < tail ) {
+    int index = queue[ head++ ];
+    MAZE_COUNT( GOAL_TABLE_EXPANSIONS );
+    MazeCell * currentCell = at( index / getWidth(), index % getWidth() );
+    uint32_t distance = table.get( index ) + 1;
+    MazeCell * neighbors[ 4 ] = { currentCell->up, currentCell->right,
+                                  currentCell->down, currentCell->left };
+    for( MazeCell * neighbor : neighbors ) {
+      if( neighbor == nullptr ) continue;
+      int neighbor_index = neighbor->row * getWidth() + neighbor->column;
+      if( table.get(neighbor_index) != table.unreachable() ) continue;
+      table.set( neighbor_index, distance );
+      queue[ tail++ ] = neighbor_index;
+    }
+  }
+  table.stale = false;
+}
+
+/*******************************************************************************
+% Routine Name: invalidateGoalTables
+% File:         Maze.cpp
+% Parameters:   cell_A     - a cell in this maze.
+%               cell_B     - a cell in this maze.
+%               wall_added - true if the wall was added, false if removed.
+% Description:  Marks stale only the goal tables whose distances can change
+%               from toggling the wall between two adjacent cells.
+% Return:       Nothing.
+*******************************************************************************/
+void Maze::invalidateGoalTables( MazeCell * cell_A, MazeCell * cell_B,
+  bool wall_added ) {
+
+  int row_distance = std::abs( cell_A->row - cell_B->row );
+  int column_distance = std::abs( cell_A->column - cell_B->column );
+  if( row_distance + column_distance != 1 ) return; /* not adjacent */
+
+  int index_A = cell_A->row * getWidth() + cell_A->column;
+  int index_B = cell_B->row * getWidth() + cell_B->column;
+  for( DistanceTable & table : goal_tables ) {
+    if( table.stale ) continue;
+    if( table.affectedBy(index_A, index_B, wall_added) ) table.stale = true;
+  }
+}
+
+/*******************************************************************************
+% Routine Name: saveGoalTables
+% File:         Maze.cpp
+% Parameters:   filename - File to write the goal distance tables to.
+% Description:  Saves every goal set and its distance table to the disk, to be
+%               stored next to the maze file for a warm start. Every integer
+%               is big endian, and the header carries the hash of the walls
+%               the distances were computed on.
+% Return:       Save status.
+*******************************************************************************/
+bool Maze::saveGoalTables( const char * filename ) {
+  #ifndef ARDUINO
+  std::ofstream outstream;
+  outstream.open( filename, std::ios::out | std::ios::binary );
+  if( !outstream.is_open() ) {
+    std::cerr << "Unable to open file: " << filename << std::endl;
+    return false;
+  }
+  auto writeInt = [&]( uint32_t value ) {
+    value = htonl( value );
+    outstream.write( (char *) &value, sizeof(value) );
+  };
+  /* header - order: magic width height hash (high, low) count */
+  outstream.write( GOAL_TABLE_MAGIC, 4 );
+  writeInt( getWidth() );
+  writeInt( getHeight() );
+  writeInt( (uint32_t)(getHash() >> 32) );
+  writeInt( (uint32_t)getHash() );
+  writeInt( goal_tables.size() );
+
+  std::vector<uint8_t> entries;
+  for( DistanceTable & table : goal_tables ) {
+    /* tables - order: goal count, goals, entry size, distances */
+    if( table.stale ) buildGoalTable( table );
+    writeInt( table.goals.size() );
+    for( int goal : table.goals ) writeInt( goal );
+    writeInt( table.entry_size );
+    /* entries are kept little endian in memory - reversed byte by byte */
+    entries.resize( table.data.size() );
+    for( size_t entry = 0; entry < table.data.size(); entry += table.entry_size ) {
+      std::reverse_copy( &table.data[ entry ], &table.data[ entry ] + table.entry_size,
+                         &entries[ entry ] );
+    }
+    outstream.write( (char *) entries.data(), entries.size() );
+  }
+  bool status = (bool)outstream;
+  outstream.close();
+  return status;
+  #endif
+}
+
+/*******************************************************************************
+% Routine Name: loadGoalTables
+% File:         Maze.cpp
+% Parameters:   filename - File to read the goal distance tables from.
+% Description:  Replaces the registered goal sets with the ones stored on the
+%               disk. The file must have been saved with a maze of the same
+%               dimensions. If the walls have changed since, the goal sets
+%               are kept and their tables rebuilt on the next lookup.
+% Return:       Load status.
+*******************************************************************************/
+bool Maze::loadGoalTables( const char * filename ) {
+  #ifndef ARDUINO
+  std::ifstream instream;
+  instream.open( filename, std::ios::in | std::ios::binary );
+  if( !instream.is_open() ) {
+    std::cerr << "Unable to open file: " << filename << std::endl;
+    return false;
+  }
+  auto readInt = [&]() {
+    uint32_t value = 0;
+    instream.read( (char *) &value, sizeof(value) );
+    return ntohl( value );
+  };
+  char magic[ 4 ] = { 0 };
+  instream.read( magic, 4 );
+  int read_width = readInt();
+  int read_height = readInt();
+  uint64_t read_hash = (uint64_t)readInt() << 32;
+  read_hash |= readInt();
+  uint32_t count = readInt();
+  if( !instream || std::memcmp(magic, GOAL_TABLE_MAGIC, 4) != 0 ||
+      read_width != getWidth() || read_height != getHeight() ) {
+    std::cerr << "Incompatible goal table file: Aborting load" << std::endl;
+    return false;
+  }
+
+  /* distances of other walls are rebuilt on the next lookup */
+  const bool stale = ( read_hash != getHash() );
+  const int cells = getWidth() * getHeight();
+  std::vector<DistanceTable> tables;
+  for( uint32_t table_index = 0; table_index < count; table_index++ ) {
+    uint32_t goal_count = readInt();
+    if( !instream || goal_count == 0 || goal_count > (uint32_t)cells ) break;
+    std::vector<int> goals( goal_count );
+    for( int & goal : goals ) {
+      goal = readInt();
+      if( goal < 0 || goal >= cells ) instream.setstate( std::ios::failbit );
+    }
+    DistanceTable table( goals, cells );
+    if( (int)readInt() != table.entry_size ) break;
+    instream.read( (char *) table.data.data(), table.data.size() );
+    if( !instream ) break;
+    for( size_t entry = 0; entry < table.data.size(); entry += table.entry_size ) {
+      std::reverse( &table.data[ entry ], &table.data[ entry ] + table.entry_size );
+    }
+    table.stale = stale;
+    tables.push_back( table );
+  }
+  if( tables.size() != count ) {
+    /* corrupted datafile - missing bytes */
+    std::cerr << "Currupted goal table file detected: Aborting load" << std::endl;
+    return false;
+  }
+  goal_tables.swap( tables );
+  return true;
+  #endif
+}
+
 /*******************************************************************************
 % Routine Name: operator (const char *) 
 % File:         Maze.cpp
@@ -580,25 +1902,20 @@ Maze::operator const char *() {
 % Routine Name: operator==
 % File:         Maze.cpp
 % Parameters:   other - Comparing maze.
-% Description:  Maze graph equivalence.
+% Description:  Maze graph equivalence. Differing hashes reject early, equal
+%               hashes are confirmed by comparing the passage planes.
 % Return:       True if maze graphs are equivelent, false otherwise.
 *******************************************************************************/
 bool Maze::operator==( const Maze & other ) const {
   if( height != other.height ) return false;
   if( width != other.width ) return false;
+  if( zobrist != other.zobrist ) return false;
 
-  for( int row = 0; row < height; row++ ) {
-    for( int column = 0; column < width; column++ ) {
-      /* compare all cells for graph-node equivalence */
-      const MazeCell * currentCell = &this->maze[ row ][ column ];
-      const MazeCell * otherCell = &other.maze[ row ][ column ];
-      if( !(currentCell->up) != !(otherCell->up) ) return false;
-      if( !(currentCell->right) != !(otherCell->right) ) return false;
-      if( !(currentCell->down) != !(otherCell->down) ) return false;
-      if( !(currentCell->left) != !(otherCell->left) ) return false;
-    }
-  }
-  return true;
+  /* compare the passage planes word by word */
+  size_t bytes = right_plane.size() * sizeof( uint64_t );
+  if( bytes == 0 ) return true;
+  return std::memcmp( right_plane.data(), other.right_plane.data(), bytes ) == 0 &&
+         std::memcmp( down_plane.data(), other.down_plane.data(), bytes ) == 0;
 }
 
 /*******************************************************************************
@@ -629,38 +1946,41 @@ std::ostream & operator<<( std::ostream & os, Maze & maze ) {
 % Routine Name: Maze::Iterator::operator * 
 % File:         Maze.cpp
 % Parameters:   None.
-% Description:  Overloads the * operator to return the curr maze cell pointer.
-% Return:       The maze cell that curr points to. 
+% Description:  Overloads the * operator to return the maze cell at the
+%               current position. Whole-maze iteration of a row-major maze
+%               reads storage directly, without bounds checks.
+% Return:       The maze cell at the current position.
 *******************************************************************************/
 MazeCell * Maze::Iterator::operator*() const {
-  return curr;
+  if( line >= 0 ) {
+    return vertical ? &maze->maze[ maze->cellIndex(position, line) ]
+                    : &maze->maze[ maze->cellIndex(line, position) ];
+  }
+  if( maze->layout == ROW_MAJOR ) return &maze->maze[ position ];
+  return &maze->maze[ maze->cellIndex(position / maze->width, position % maze->width) ];
+}
+
+/*******************************************************************************
+% Routine Name: Maze::Iterator::operator []
+% File:         Maze.cpp
+% Parameters:   offset - distance from the current position.
+% Description:  Random access relative to the current position.
+% Return:       The maze cell offset positions away.
+*******************************************************************************/
+MazeCell * Maze::Iterator::operator[]( std::ptrdiff_t offset ) const {
+  return *( *this + offset );
 }
 
 /*******************************************************************************
 % Routine Name: Maze::Iterator::operator ++ 
 % File:         Maze.cpp
 % Parameters:   None.
-% Description:  Overloads the prefix operator++ and moves curr to the 
-%               successor cell of the maze container.
+% Description:  Overloads the prefix operator++ and moves to the successor
+%               cell - the next column, wrapping to the next row.
 % Return:       The calling maze iteartor.
 *******************************************************************************/
 Maze::Iterator & Maze::Iterator::operator++() {
-  MazeCell * end = maze.at( maze.getHeight() - 1, maze.getWidth() - 1 );
-
-  if( curr == end ) {
-    /* terminating case */
-    curr = nullptr;
-    return *this;
-  }
-
-  if( curr->column + 1 == maze.getWidth() ) {
-    /* wrapping around 2d array */
-    curr = maze.at( curr->row + 1, 0 );
-  }
-  else {
-    /* typical 1d array iteration */
-    curr = maze.at( curr->row, curr->column + 1);
-  }
+  position++;
   return *this;
 }
 
@@ -668,27 +1988,126 @@ Maze::Iterator & Maze::Iterator::operator++() {
 % Routine Name: Maze::Iterator::operator ++ 
 % File:         Maze.cpp
 % Parameters:   None.
-% Description:  Overloads the postfix operator++ and moves curr to the 
-%               successor of the maze container.
-% Return:       The calling maze iterator before moving curr to its sucessor. 
+% Description:  Overloads the postfix operator++ and moves to the successor
+%               cell of the maze container.
+% Return:       The calling maze iterator before moving to its sucessor. 
 *******************************************************************************/
 Maze::Iterator Maze::Iterator::operator++(int) {
-  Maze::Iterator before( maze, curr );
-  ++(*this);
+  Maze::Iterator before( *this );
+  position++;
+  return before;
+}
+
+/*******************************************************************************
+% Routine Name: Maze::Iterator::operator --
+% File:         Maze.cpp
+% Parameters:   None.
+% Description:  Overloads the prefix operator-- and moves to the predecessor
+%               cell of the maze container.
+% Return:       The calling maze iterator.
+*******************************************************************************/
+Maze::Iterator & Maze::Iterator::operator--() {
+  position--;
+  return *this;
+}
+
+/*******************************************************************************
+% Routine Name: Maze::Iterator::operator --
+% File:         Maze.cpp
+% Parameters:   None.
+% Description:  Overloads the postfix operator-- and moves to the predecessor
+%               cell of the maze container.
+% Return:       The calling maze iterator before moving to its predecessor.
+*******************************************************************************/
+Maze::Iterator Maze::Iterator::operator--(int) {
+  Maze::Iterator before( *this );
+  position--;
   return before;
 }
 
+/*******************************************************************************
+% Routine Name: Maze::Iterator::operator +=
+% File:         Maze.cpp
+% Parameters:   offset - number of cells to move forward.
+% Description:  Moves the iterator in constant time.
+% Return:       The calling maze iterator.
+*******************************************************************************/
+Maze::Iterator & Maze::Iterator::operator+=( std::ptrdiff_t offset ) {
+  position += offset;
+  return *this;
+}
+
+/*******************************************************************************
+% Routine Name: Maze::Iterator::operator -=
+% File:         Maze.cpp
+% Parameters:   offset - number of cells to move back.
+% Description:  Moves the iterator in constant time.
+% Return:       The calling maze iterator.
+*******************************************************************************/
+Maze::Iterator & Maze::Iterator::operator-=( std::ptrdiff_t offset ) {
+  position -= offset;
+  return *this;
+}
+
+/*******************************************************************************
+% Routine Name: Maze::Iterator::operator +
+% File:         Maze.cpp
+% Parameters:   offset - number of cells to move forward.
+% Description:  Copy of the iterator moved forward.
+% Return:       The moved iterator.
+*******************************************************************************/
+Maze::Iterator Maze::Iterator::operator+( std::ptrdiff_t offset ) const {
+  Maze::Iterator moved( *this );
+  moved.position += offset;
+  return moved;
+}
+
+/*******************************************************************************
+% Routine Name: operator +
+% File:         Maze.cpp
+% Parameters:   offset   - number of cells to move forward.
+%               iterator - iterator to move.
+% Description:  Copy of the iterator moved forward, with the offset first.
+% Return:       The moved iterator.
+*******************************************************************************/
+Maze::Iterator operator+( std::ptrdiff_t offset, const Maze::Iterator & iterator ) {
+  return iterator + offset;
+}
+
+/*******************************************************************************
+% Routine Name: Maze::Iterator::operator -
+% File:         Maze.cpp
+% Parameters:   offset - number of cells to move back.
+% Description:  Copy of the iterator moved back.
+% Return:       The moved iterator.
+*******************************************************************************/
+Maze::Iterator Maze::Iterator::operator-( std::ptrdiff_t offset ) const {
+  Maze::Iterator moved( *this );
+  moved.position -= offset;
+  return moved;
+}
+
+/*******************************************************************************
+% Routine Name: Maze::Iterator::operator -
+% File:         Maze.cpp
+% Parameters:   other - an iterator over the same cells.
+% Description:  Distance between two iterators.
+% Return:       Number of cells from other to this iterator.
+*******************************************************************************/
+std::ptrdiff_t Maze::Iterator::operator-( Maze::Iterator const & other ) const {
+  return position - other.position;
+}
+
 /*******************************************************************************
 % Routine Name: Maze::Iterator::operator ==
 % File:         Maze.cpp
 % Parameters:   other - an iterator to compare with.
 % Description:  Overloads the == operator to check equality of two maze 
-%               iterators based on a shallow comparsion of curr pointers.
-% Return:       True if both curr and the other iterators curr point to the 
-%               same address in memory, false otherwise. 
+%               iterators over the same cells by their positions.
+% Return:       True if both iterators are at the same position.
 *******************************************************************************/
 bool Maze::Iterator::operator==( Maze::Iterator const & other ) const {
-  return curr == other.curr;
+  return position == other.position;
 }
 
 /*******************************************************************************
@@ -696,12 +2115,55 @@ bool Maze::Iterator::operator==( Maze::Iterator const & other ) const {
 % File:         Maze.cpp
 % Parameters:   other - an iterator to compare with.
 % Description:  Overloads the != opearator to evaluate when two maze iterators
-%               are not equivalent based on curr pointer comparison. 
-% Return:       True if the other iterator's curr is not same as this objects
-%               curr, false otherwise. 
+%               are not equivalent based on their positions.
+% Return:       True if the iterators are at different positions.
 *******************************************************************************/
 bool Maze::Iterator::operator!=( Maze::Iterator const & other ) const {
-  return curr != other.curr;
+  return position != other.position;
+}
+
+/*******************************************************************************
+% Routine Name: Maze::Iterator::operator <
+% File:         Maze.cpp
+% Parameters:   other - an iterator over the same cells.
+% Description:  Orders iterators by position.
+% Return:       True if this iterator comes before the other.
+*******************************************************************************/
+bool Maze::Iterator::operator<( Maze::Iterator const & other ) const {
+  return position < other.position;
+}
+
+/*******************************************************************************
+% Routine Name: Maze::Iterator::operator >
+% File:         Maze.cpp
+% Parameters:   other - an iterator over the same cells.
+% Description:  Orders iterators by position.
+% Return:       True if this iterator comes after the other.
+*******************************************************************************/
+bool Maze::Iterator::operator>( Maze::Iterator const & other ) const {
+  return position > other.position;
+}
+
+/*******************************************************************************
+% Routine Name: Maze::Iterator::operator <=
+% File:         Maze.cpp
+% Parameters:   other - an iterator over the same cells.
+% Description:  Orders iterators by position.
+% Return:       True unless this iterator comes after the other.
+*******************************************************************************/
+bool Maze::Iterator::operator<=( Maze::Iterator const & other ) const {
+  return position <= other.position;
+}
+
+/*******************************************************************************
+% Routine Name: Maze::Iterator::operator >=
+% File:         Maze.cpp
+% Parameters:   other - an iterator over the same cells.
+% Description:  Orders iterators by position.
+% Return:       True unless this iterator comes before the other.
+*******************************************************************************/
+bool Maze::Iterator::operator>=( Maze::Iterator const & other ) const {
+  return position >= other.position;
 }
 
 /*******************************************************************************
@@ -759,3 +2221,93 @@ std::stack<std::string> MazeHelper::verticallyStackedRange( int min, int max ) {
 
   return stak;
 }  
+
+/*******************************************************************************
+% Routine Name: mix
+% File:         Maze.cpp
+% Parameters:   value - integer to scramble.
+% Description:  SplitMix64 finalizer - a bijective 64-bit scrambler.
+% Return:       Well distributed 64-bit value.
+*******************************************************************************/
+uint64_t MazeHelper::mix( uint64_t value ) {
+  value += 0x9E3779B97F4A7C15ULL;
+  value = ( value ^ (value >> 30) ) * 0xBF58476D1CE4E5B9ULL;
+  value = ( value ^ (value >> 27) ) * 0x94D049BB133111EBULL;
+  return value ^ ( value >> 31 );
+}
+
+/*******************************************************************************
+% Routine Name: spreadBits
+% File:         Maze.cpp
+% Parameters:   value - integer to spread.
+% Description:  Moves bit i of the value to bit 2i, leaving the odd bits
+%               clear for interleaving a second coordinate.
+% Return:       The spread value.
+*******************************************************************************/
+uint64_t MazeHelper::spreadBits( uint32_t value ) {
+  uint64_t bits = value;
+  bits = ( bits | (bits << 16) ) & 0x0000FFFF0000FFFFULL;
+  bits = ( bits | (bits << 8) ) & 0x00FF00FF00FF00FFULL;
+  bits = ( bits | (bits << 4) ) & 0x0F0F0F0F0F0F0F0FULL;
+  bits = ( bits | (bits << 2) ) & 0x3333333333333333ULL;
+  bits = ( bits | (bits << 1) ) & 0x5555555555555555ULL;
+  return bits;
+}
+
+/*******************************************************************************
+% Routine Name: compactBits
+% File:         Maze.cpp
+% Parameters:   value - interleaved value.
+% Description:  Inverse of spreadBits - gathers the even bits of the value.
+% Return:       The compacted value.
+*******************************************************************************/
+uint32_t MazeHelper::compactBits( uint64_t value ) {
+  value &= 0x5555555555555555ULL;
+  value = ( value | (value >> 1) ) & 0x3333333333333333ULL;
+  value = ( value | (value >> 2) ) & 0x0F0F0F0F0F0F0F0FULL;
+  value = ( value | (value >> 4) ) & 0x00FF00FF00FF00FFULL;
+  value = ( value | (value >> 8) ) & 0x0000FFFF0000FFFFULL;
+  value = ( value | (value >> 16) ) & 0x00000000FFFFFFFFULL;
+  return value;
+}
+
+/*******************************************************************************
+% Routine Name: writeSnapshot
+% File:         Maze.cpp
+% Parameters:   snapshot - walls to save.
+%               filename - File to save the walls to.
+% Description:  Encodes the snapshot chunk by chunk into a temporary file,
+%               then renames it over the target.
+% Return:       Save status.
+*******************************************************************************/
+bool MazeHelper::writeSnapshot( const MazeSnapshot & snapshot,
+  const std::string & filename ) {
+
+  #if !defined( ARDUINO )
+  MAZE_TRACE_SCOPE( "Maze::saveAsync" );
+  const size_t CHUNK_SIZE = 4096;
+  static std::atomic<unsigned> sequence( 0 );
+  const std::string temporary = filename + ".tmp" + std::to_string( sequence++ );
+  std::ofstream outstream( temporary.c_str(), std::ios::out | std::ios::binary );
+  if( !outstream.is_open() ) {
+    std::cerr << "Unable to open file: " << temporary << std::endl;
+    return false;
+  }
+  uint8_t chunk[ CHUNK_SIZE ];
+  size_t offset = 0;
+  while( size_t size = snapshot.encode(offset, chunk, CHUNK_SIZE) ) {
+    outstream.write( (char *) chunk, size );
+    offset += size;
+  }
+  outstream.close();
+  if( !outstream || std::rename(temporary.c_str(), filename.c_str()) != 0 ) {
+    std::cerr << "Unable to save file: " << filename << std::endl;
+    std::remove( temporary.c_str() );
+    return false;
+  }
+  MAZE_COUNT_ADD( BYTES_WRITTEN, offset );
+  return true;
+  #else
+  return false;
+  #endif
+}
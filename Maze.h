@@ -27,19 +27,106 @@ Description:     2D matrix data structure with an internal graph abstraction.
   #include <utility>
   #include <iterator>
   #include <fstream>
+  #include <algorithm>
+  #include <cstdint>
   #include "MazeCell.hpp"
+  #include "DistanceTable.hpp"
+  #include "MazeSnapshot.hpp"
+  #include "MazeInstrumentation.hpp"
 #else
   #error "board not supported." 
 #endif
 
+#if !defined( ARDUINO )
+  #include <arpa/inet.h>
+  #include <thread>
+  #include <future>
+  #include <atomic>
+  #include <functional>
+  #include <cstdio>
+#endif
+
+/* Passage that differs between two mazes of equal dimensions */
+struct WallChange {
+  int row;
+  int column;
+  /* 0 for the passage right of the cell, 1 for the passage below it */
+  int orientation;
+  /* true if the wall exists in the second maze but not the first */
+  bool added;
+};
+
+class Maze;
+
+/* Observer of wall changes - for structures that cache derived maze state */
+class MazeListener {
+public:
+  virtual ~MazeListener() {}
+  /* invoked after a wall between two cells has been added or removed */
+  virtual void wallChanged( MazeCell * cell_A, MazeCell * cell_B ) = 0;
+  /* invoked once after a batch of walls changed - defaults to wallChanged */
+  virtual void wallsChanged( Maze & maze, const WallChange * changes, int count );
+};
+
 class Maze {
+public:
+  /* order of the cells in memory */
+  enum Layout {
+    /* one row after another */
+    ROW_MAJOR,
+    /* 8x8 tiles in row-major order, row-major within a tile */
+    TILED,
+    /* Z-order curve within squares of up to 64x64, squares row-major */
+    MORTON
+  };
+
 private:
-  std::vector<std::vector<MazeCell>> maze;
+  /* every cell, in the order given by the layout */
+  std::vector<MazeCell> maze;
+  Layout layout = ROW_MAJOR;
+  /* tiles or Morton squares per row of the maze */
+  int tile_columns = 0;
+  /* side of the Morton squares is 1 << morton_bits */
+  int morton_bits = 0;
   std::string maze_str;
+  std::vector<MazeListener *> listeners;
+  std::vector<DistanceTable> goal_tables;
+  /* bit planes of open passages - right of and below every cell, row-major
+     with every row padded to whole words */
+  std::vector<uint64_t> right_plane;
+  std::vector<uint64_t> down_plane;
+  int plane_stride;
+  /* Zobrist hash - xor of the keys of every open passage */
+  uint64_t zobrist;
+  /* journal of flipped passages - (cell index << 1) | orientation */
+  std::vector<uint32_t> journal;
+  std::vector<uint32_t> redo_journal;
+  bool journaling = false;
+  bool replaying = false;
+  /* row blocks of the last snapshot - null where rows changed since */
+  std::vector<std::shared_ptr<const SnapshotBlock>> snapshot_blocks;
+  /* dimensions, in unit cells */
+  int width, height;
   /* Creates an undirected egde between the given cells. */
   void addEdge( MazeCell * cell_A, MazeCell * cell_B );
   /* Removes an undirected egde that is between the given cells. */
   void removeEdge( MazeCell * cell_A, MazeCell * cell_B );
+  /* records an open or closed passage in the bit planes and the hash */
+  void setPassage( MazeCell * cell_A, MazeCell * cell_B, bool open );
+  /* appends a flipped passage to the journal */
+  void recordPassage( int row, int column, int orientation );
+  /* flips a journaled passage back through addWall or removeWall */
+  void replayPassage( uint32_t entry );
+  /* position of a cell in storage under the layout */
+  size_t cellIndex( int row, int column ) const;
+  /* location of the cell stored at a position - padding lies outside */
+  void cellLocation( size_t index, int & row, int & column ) const;
+  /* rebuilds the neighbor links of every cell from the bit planes */
+  void relinkCells();
+  /* rebuilds the neighbor links of a band of rows */
+  void relinkRows( int first_row, int last_row );
+  /* drops the cached snapshot block holding a row */
+  void invalidateSnapshotRow( int row );
   /* writes encoded maze to disk */
   bool serialize( std::ofstream & outstream );
   /* reads and decodes encoded maze from disk */
@@ -50,19 +137,61 @@ private:
   int deserializeWidth( const char * filename );
   /* read stored maze height from file */
   int deserializeHeight( const char * filename );
+  /* informs all attached listeners of a wall change */
+  void notifyWallChanged( MazeCell * cell_A, MazeCell * cell_B );
+  /* informs all attached listeners of a batch of wall changes */
+  void notifyWallsChanged( const WallChange * changes, int count );
+  /* sets one passage by coordinates, relinking both cells */
+  bool applyPassage( int row, int column, int orientation, bool open,
+                     WallChange * change );
+  /* marks the goal tables a wall change can affect as stale */
+  void invalidateGoalTables( MazeCell * cell_A, MazeCell * cell_B, bool wall_added );
+  /* multi-source breadth first search from the goals of a table */
+  void buildGoalTable( DistanceTable & table );
 
 public:  
-  const int width, height;
+  static constexpr const char * GOAL_TABLE_MAGIC = "MZGT";
+  /* fewest cells worth handing to a thread of a parallel pass */
+  static const int PARALLEL_GRAIN = 1 << 15;
+  /* sides of a cell, as bits of a wall mask */
+  static const int WALL_UP = 0x1;
+  static const int WALL_RIGHT = 0x2;
+  static const int WALL_DOWN = 0x4;
+  static const int WALL_LEFT = 0x8;
+  static const int ALL_SIDES = 0xF;
+  /* error codes of applyWalls */
+  static const int INVALID_CELL = -1;
+  static const int OPEN_BOUNDARY = -2;
+  static const int INCONSISTENT_WALLS = -3;
   /* Creates a two dimensional maze data structure. */
-  Maze( int width, int height );
+  Maze( int width, int height, Layout layout = ROW_MAJOR );
   /* creates maze from encoded file */
   Maze( const char * filename );
+  /* Deep copy of the walls, cell data and goal tables of a maze. */
+  Maze( const Maze & other );
+  /* Takes over the cells of a maze, leaving it empty. */
+  Maze( Maze && other );
+  /* Creates a maze with the walls of a snapshot. */
+  explicit Maze( const MazeSnapshot & snapshot );
+  /* Replaces this maze with a deep copy of another. */
+  Maze & operator=( const Maze & other );
+  /* Replaces this maze with the cells of another, leaving it empty. */
+  Maze & operator=( Maze && other );
   /* Destructs the maze data structure */
   ~Maze();
   /* Creates a wall between two neighbor cells in maze. */
   void addWall( MazeCell * cell_A, MazeCell * cell_B );
   /* Removes the wall betweeb two neighbor cells in maze. */
   void removeWall( MazeCell * cell_A, MazeCell * cell_B );
+  /* Sets the sensed walls around a cell with one listener notification. */
+  int applyWalls( MazeCell * cell, int walls, int sensed = ALL_SIDES );
+  /* Sets the walls of a block of cells from row-major wall masks. */
+  int applyWalls( int first_row, int first_column, int rows, int columns,
+                  const uint8_t * walls );
+  /* Attaches a listener to be notified of every wall change. */
+  void addListener( MazeListener * listener );
+  /* Detaches a previously attached listener. */
+  void removeListener( MazeListener * listener );
   /* Clears all internal data of cell relationships in maze. */
   void clear();
   /* Clears the maze such that no walls will exist between two cells */
@@ -77,41 +206,239 @@ public:
   bool outOfBounds( int row, int column );
   /* Gets all global adjacent neighbors of cell in maze. */
   std::vector<MazeCell *> getAdjacentCellList( MazeCell * cell );
+  /* Getter method for the order of the cells in memory. */
+  Layout getLayout() const;
+  /* Getter method for the number of cells stored, including padding. */
+  size_t getStorageSize() const;
   /* Getter method for the width, in unit cells, of the maze. */
-  int getWidth();
+  int getWidth() const;
   /* Getter method for the height, in unit cells, of the maze. */
-  int getHeight();
+  int getHeight() const;
   /* saves maze to file */
   bool save( const char * filename );
   /* loads maze from file */
   bool load( const char * filename );
+  #if !defined( ARDUINO )
+  /* Saves a snapshot of the maze on a background thread. */
+  std::future<bool> saveAsync( const char * filename,
+                               std::function<void( bool )> done = nullptr );
+  #endif
+  /* Reads the dimensions of a saved maze held in memory. */
+  static bool decodeDimensions( const uint8_t * data, size_t size, int & width,
+                                int & height );
+  /* Replaces the walls from a saved maze held in memory, silently. */
+  bool decode( const uint8_t * data, size_t size );
+  /* Registers a goal set and builds its distance table. */
+  int addGoalSet( const std::vector<MazeCell *> & goals );
+  /* Removes all registered goal sets. */
+  void clearGoalSets();
+  /* overloaded - delegates to goalDistance(goal_set, cell) */
+  int goalDistance( int goal_set, int row, int column );
+  /* Distance from a cell to the nearest cell of a registered goal set. */
+  int goalDistance( int goal_set, MazeCell * cell );
+  /* saves goal distance tables to file */
+  bool saveGoalTables( const char * filename );
+  /* loads goal distance tables from file */
+  bool loadGoalTables( const char * filename );
   /* c std::string representation of the maze */
   operator const char *();
+  /* Read-only access to the packed plane of passages right of cells. */
+  const std::vector<uint64_t> & getRightPlane() const;
+  /* Read-only access to the packed plane of passages below cells. */
+  const std::vector<uint64_t> & getDownPlane() const;
+  /* Number of 64-bit words per row of a passage plane. */
+  int getPlaneStride() const;
+  /* Replaces every wall of the maze from packed passage planes. */
+  bool setPassagePlanes( const std::vector<uint64_t> & right,
+                         const std::vector<uint64_t> & down );
+  /* Zobrist key of the passage right of (0) or below (1) a cell */
+  static uint64_t passageKey( int width, int row, int column, int orientation );
+  /* Zobrist hash of a maze of the given dimensions with every wall up */
+  static uint64_t wallsHash( int width, int height );
+  /* Immutable copy of the walls sharing unchanged rows with the last one. */
+  MazeSnapshot snapshot();
+  /* Starts or stops recording wall changes in the journal. */
+  void setJournaling( bool enabled );
+  /* Marks the current journal position, starting the journal if needed. */
+  size_t checkpoint();
+  /* Undoes every wall change recorded after a checkpoint. */
+  bool rollback( size_t checkpoint );
+  /* Undoes the most recent recorded wall change. */
+  bool undo();
+  /* Reapplies the most recently undone wall change. */
+  bool redo();
+  /* Lists every passage that differs between two mazes. */
+  static std::vector<WallChange> diff( const Maze & maze_A, const Maze & maze_B );
+  /* 64-bit hash of the maze walls, maintained incrementally */
+  uint64_t getHash() const;
   /* Maze graph equivalance */
   bool operator==( const Maze & other ) const;
   /* Maze graph non-equivalence */
   bool operator!=( const Maze & other ) const;
   /* implicit call to output the std::string representation of the maze */
   friend std::ostream & operator<<( std::ostream & os, Maze & maze );
-  /* Iterator class for the maze container - allowing ranging for loops */
-  class Iterator : public std::iterator<std::input_iterator_tag, MazeCell> {
+  /* Random access iterator over the cells of the maze, or of one row or
+     column of it - allowing ranging for loops and STL algorithms */
+  class Iterator {
+  public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef MazeCell * value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef MazeCell ** pointer;
+    typedef MazeCell * reference;
   private:
-    Maze & maze;
-    MazeCell * curr;
+    Maze * maze;
+    /* row-major position over the maze, or position along the line */
+    std::ptrdiff_t position;
+    /* row or column iterated, -1 for the whole maze */
+    int line;
+    bool vertical;
   public:
-    Iterator( Maze & maze, MazeCell * curr ) : maze(maze), curr(curr) {}
+    Iterator( Maze & maze, std::ptrdiff_t position, int line = -1,
+      bool vertical = false ) : maze(&maze), position(position), line(line),
+      vertical(vertical) {}
     MazeCell * operator*() const;
+    MazeCell * operator[]( std::ptrdiff_t offset ) const;
     Iterator & operator++();
     Iterator operator++(int);
+    Iterator & operator--();
+    Iterator operator--(int);
+    Iterator & operator+=( std::ptrdiff_t offset );
+    Iterator & operator-=( std::ptrdiff_t offset );
+    Iterator operator+( std::ptrdiff_t offset ) const;
+    Iterator operator-( std::ptrdiff_t offset ) const;
+    std::ptrdiff_t operator-( Iterator const & other ) const;
     bool operator==( Iterator const & other ) const;
     bool operator!=( Iterator const & other ) const;
+    bool operator<( Iterator const & other ) const;
+    bool operator>( Iterator const & other ) const;
+    bool operator<=( Iterator const & other ) const;
+    bool operator>=( Iterator const & other ) const;
+  };
+
+  /* View of the cells of one row or column of the maze */
+  class CellSpan {
+  private:
+    Maze & maze;
+    int line;
+    bool vertical;
+  public:
+    CellSpan( Maze & maze, int line, bool vertical ) : maze(maze), line(line),
+      vertical(vertical) {}
+    MazeCell * operator[]( int index ) const { return *( begin() + index ); }
+    int size() const { return vertical ? maze.height : maze.width; }
+    Maze::Iterator begin() const { return Maze::Iterator( maze, 0, line, vertical ); }
+    Maze::Iterator end() const { return Maze::Iterator( maze, size(), line, vertical ); }
   };
 
-  Maze::Iterator begin() { return Maze::Iterator( *this, at(0, 0) ); }
-  Maze::Iterator end() { return Maze::Iterator( *this, nullptr ); }
+  Maze::Iterator begin() { return Maze::Iterator( *this, 0 ); }
+  Maze::Iterator end() { return Maze::Iterator( *this, (std::ptrdiff_t)width * height ); }
+  /* View of the cells of a row, left to right. */
+  CellSpan row( int row ) { return CellSpan( *this, row, false ); }
+  /* View of the cells of a column, top to bottom. */
+  CellSpan column( int column ) { return CellSpan( *this, column, true ); }
+
+  /* Calls a function on bands of rows [first_row, last_row) across threads. */
+  template <typename Function>
+  void parallelForEachRow( Function function, int threads = 0 );
+  /* Calls a function on every cell, splitting the rows across threads. */
+  template <typename Function>
+  void parallelForEachCell( Function function, int threads = 0 );
+  /* Maps every cell to a value and folds the values, across threads. */
+  template <typename T, typename Transform, typename Reduce>
+  T transformReduce( T init, Transform transform, Reduce reduce, int threads = 0 );
 
 };
 
+/* overloaded - moves an iterator forward, as iterator + offset */
+Maze::Iterator operator+( std::ptrdiff_t offset, const Maze::Iterator & iterator );
+
+/*******************************************************************************
+% Routine Name: parallelForEachRow
+% File:         Maze.h
+% Parameters:   function - callable as function( first_row, last_row ).
+%               threads  - number of threads, 0 for one per core.
+% Description:  Splits the rows into contiguous bands, one per thread, with
+%               at least PARALLEL_GRAIN cells each. The calling thread takes
+%               the first band. Runs on the calling thread alone on Arduino.
+% Return:       Nothing.
+*******************************************************************************/
+template <typename Function>
+void Maze::parallelForEachRow( Function function, int threads ) {
+  #if defined( ARDUINO )
+    function( 0, height );
+  #else
+    if( threads <= 0 ) threads = std::max( 1u, std::thread::hardware_concurrency() );
+    long bands = std::min( (long)threads, (long)width * height / PARALLEL_GRAIN );
+    bands = std::max( 1L, std::min(bands, (long)height) );
+    if( bands == 1 ) {
+      function( 0, height );
+      return;
+    }
+    std::vector<std::thread> workers;
+    for( long band = 1; band < bands; band++ ) {
+      workers.push_back( std::thread(function, (int)(height * band / bands),
+                                     (int)(height * (band + 1) / bands)) );
+    }
+    function( 0, (int)(height / bands) );
+    for( std::thread & worker : workers ) worker.join();
+  #endif
+}
+
+/*******************************************************************************
+% Routine Name: parallelForEachCell
+% File:         Maze.h
+% Parameters:   function - callable as function( MazeCell * ).
+%               threads  - number of threads, 0 for one per core.
+% Description:  Calls the function on every cell, each band of rows on its
+%               own thread. The function must only touch its own cell.
+% Return:       Nothing.
+*******************************************************************************/
+template <typename Function>
+void Maze::parallelForEachCell( Function function, int threads ) {
+  parallelForEachRow( [this, &function]( int first_row, int last_row ) {
+    for( int row = first_row; row < last_row; row++ ) {
+      for( MazeCell * cell : this->row( row ) ) function( cell );
+    }
+  }, threads );
+}
+
+/*******************************************************************************
+% Routine Name: transformReduce
+% File:         Maze.h
+% Parameters:   init      - initial value of the fold.
+%               transform - callable as transform( MazeCell * ) returning T.
+%               reduce    - associative callable as reduce( T, T ).
+%               threads   - number of threads, 0 for one per core.
+% Description:  Folds the transformed cells of every band of rows on its own
+%               thread, then folds the band results onto init in row order.
+% Return:       The folded value.
+*******************************************************************************/
+template <typename T, typename Transform, typename Reduce>
+T Maze::transformReduce( T init, Transform transform, Reduce reduce, int threads ) {
+  /* one slot per band, keyed by its first row - never packed like bool */
+  struct Slot {
+    T value;
+    bool filled;
+  };
+  std::vector<Slot> slots( std::max(1, height), Slot{ T(), false } );
+  parallelForEachRow( [&]( int first_row, int last_row ) {
+    bool empty = true;
+    T value = T();
+    for( int row = first_row; row < last_row; row++ ) {
+      for( MazeCell * cell : this->row( row ) ) {
+        value = empty ? transform( cell ) : reduce( value, transform(cell) );
+        empty = false;
+      }
+    }
+    if( !empty ) slots[ first_row ] = Slot{ value, true };
+  }, threads );
+  for( int row = 0; row < height; row++ ) {
+    if( slots[ row ].filled ) init = reduce( init, slots[ row ].value );
+  }
+  return init;
+}
+
 #ifndef ARDUINO
   #include "Maze.cpp"
 #endif
@@ -0,0 +1,388 @@
+/*******************************************************************************
+                                                    Jose Jorge Jimenez-Olivas
+                                                    Brandon Cramer
+
+                 University of California, San Diego
+                           IEEE Micromouse
+
+File Name:       MazeAnalytics.cpp
+Description:     Linear-time structural checks of the maze - connected
+                 components, loops, perfect-maze test, unreachable cells,
+                 bridges and articulation points.
+*******************************************************************************/
+#include "MazeAnalytics.h"
+
+/*******************************************************************************
+% Constructor: MazeAnalytics
+% File:        MazeAnalytics.cpp
+% Parameters:  maze    - maze to analyze.
+%              threads - most row bands analyzed in parallel, 0 for one per
+%                        hardware thread. Every band holds at least
+%                        Maze::PARALLEL_GRAIN cells, so small mazes are
+%                        analyzed on the calling thread alone.
+% Description: Creates an analytics module over the maze.
+*******************************************************************************/
+MazeAnalytics::MazeAnalytics( Maze & maze, int threads ) : maze( maze ) {
+  #if defined( ARDUINO )
+    threads = 1;
+  #else
+    if( threads <= 0 ) threads = std::thread::hardware_concurrency();
+  #endif
+  this->threads = std::max( 1, std::min(threads, maze.getHeight()) );
+}
+
+/*******************************************************************************
+% Routine Name: analyze
+% File:         MazeAnalytics.cpp
+% Parameters:   origin - cell reachability is measured from, (0, 0) if null.
+% Description:  Builds a union-find forest of the open edges. Row bands are
+%               unioned in parallel since their sets never overlap, then the
+%               edges crossing band borders are merged sequentially. The
+%               calling thread takes the first band.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeAnalytics::analyze( MazeCell * origin ) {
+  MAZE_TRACE_SCOPE( "MazeAnalytics::analyze" );
+  const int width = maze.getWidth();
+  const int height = maze.getHeight();
+  const int cells = width * height;
+  component.resize( cells );
+  component_count = 0;
+  edge_count = 0;
+  unreachable_count = 0;
+  if( cells == 0 ) return;
+  if( origin == nullptr ) origin = maze.at( 0, 0 );
+
+  const long grain_bands = (long)cells / Maze::PARALLEL_GRAIN;
+  const int band_count = (int)std::max( 1L, std::min((long)threads, grain_bands) );
+  const int band_rows = ( height + band_count - 1 ) / band_count;
+  const int bands = ( height + band_rows - 1 ) / band_rows;
+  std::vector<long> band_edges( bands, 0 );
+  std::vector<long> band_roots( bands, 0 );
+  std::vector<long> band_unreachable( bands, 0 );
+
+  auto forEachBand = [&]( std::function<void (int, int, int)> work ) {
+    #if defined( ARDUINO )
+      for( int band = 0; band < bands; band++ ) {
+        work( band, band * band_rows, std::min((band + 1) * band_rows, height) - 1 );
+      }
+    #else
+      std::vector<std::thread> workers;
+      for( int band = 1; band < bands; band++ ) {
+        int first_row = band * band_rows;
+        int last_row = std::min( first_row + band_rows, height ) - 1;
+        workers.push_back( std::thread(work, band, first_row, last_row) );
+      }
+      work( 0, 0, std::min(band_rows, height) - 1 );
+      for( std::thread & worker : workers ) worker.join();
+    #endif
+  };
+
+  forEachBand( [&]( int band, int first_row, int last_row ) {
+    unionBand( first_row, last_row, &band_edges[ band ] );
+  });
+  for( int band = 1; band < bands; band++ ) {
+    /* merge edges crossing the border above each band */
+    int row = band * band_rows - 1;
+    for( int column = 0; column < width; column++ ) {
+      if( maze.at(row, column)->down == nullptr ) continue;
+      unite( row * width + column, (row + 1) * width + column );
+      band_edges[ band ]++;
+    }
+  }
+
+  const int origin_root = find( origin->row * width + origin->column );
+  forEachBand( [&]( int band, int first_row, int last_row ) {
+    countBand( first_row, last_row, origin_root, &band_roots[ band ],
+               &band_unreachable[ band ] );
+  });
+  for( int band = 0; band < bands; band++ ) {
+    edge_count += band_edges[ band ];
+    component_count += band_roots[ band ];
+    unreachable_count += band_unreachable[ band ];
+  }
+}
+
+/*******************************************************************************
+% Routine Name: analyzeCuts
+% File:         MazeAnalytics.cpp
+% Parameters:   None.
+% Description:  Tarjan's bridge and articulation point search. The DFS keeps
+%               an explicit stack and a per-cell direction cursor, so it
+%               cannot overflow the call stack on large mazes.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeAnalytics::analyzeCuts() {
+  const int width = maze.getWidth();
+  const int cells = width * maze.getHeight();
+  std::vector<int> discovered( cells, 0 );
+  std::vector<int> low( cells, 0 );
+  std::vector<int> parent( cells, -1 );
+  std::vector<unsigned char> cursor( cells, 0 );
+  std::vector<bool> articulation( cells, false );
+  std::vector<int> stack;
+  int time = 0;
+  bridges.clear();
+  articulation_points.clear();
+
+  for( int root = 0; root < cells; root++ ) {
+    if( discovered[ root ] ) continue;
+    int root_children = 0;
+    discovered[ root ] = low[ root ] = ++time;
+    stack.push_back( root );
+
+    while( !stack.empty() ) {
+      int cell = stack.back();
+      if( cursor[ cell ] < 4 ) {
+        /* visit the next open neighbor */
+        MazeCell * next = neighbor( cell, cursor[ cell ]++ );
+        if( next == nullptr ) continue;
+        int child = next->row * width + next->column;
+        if( !discovered[ child ] ) {
+          parent[ child ] = cell;
+          discovered[ child ] = low[ child ] = ++time;
+          if( cell == root ) root_children++;
+          stack.push_back( child );
+        }
+        else if( child != parent[ cell ] ) {
+          low[ cell ] = std::min( low[ cell ], discovered[ child ] );
+        }
+        continue;
+      }
+
+      /* all neighbors done - report to the parent */
+      stack.pop_back();
+      int up = parent[ cell ];
+      if( up < 0 ) continue;
+      low[ up ] = std::min( low[ up ], low[ cell ] );
+      if( low[ cell ] > discovered[ up ] ) {
+        bridges.push_back( std::make_pair(maze.at(up / width, up % width),
+                                          maze.at(cell / width, cell % width)) );
+      }
+      if( up != root && low[ cell ] >= discovered[ up ] ) articulation[ up ] = true;
+    }
+    if( root_children > 1 ) articulation[ root ] = true;
+  }
+
+  for( int cell = 0; cell < cells; cell++ ) {
+    if( articulation[ cell ] ) {
+      articulation_points.push_back( maze.at(cell / width, cell % width) );
+    }
+  }
+}
+
+/*******************************************************************************
+% Routine Name: unionBand
+% File:         MazeAnalytics.cpp
+% Parameters:   first_row - first row of the band.
+%               last_row  - last row of the band.
+%               edges     - output count of open edges within the band.
+% Description:  Unions the cells of a band along its open edges. Only cells
+%               of the band are touched, so bands can run concurrently.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeAnalytics::unionBand( int first_row, int last_row, long * edges ) {
+  const int width = maze.getWidth();
+  long count = 0;
+  for( int cell = first_row * width; cell < (last_row + 1) * width; cell++ ) {
+    component[ cell ] = cell;
+  }
+  for( int row = first_row; row <= last_row; row++ ) {
+    for( int column = 0; column < width; column++ ) {
+      MazeCell * currentCell = maze.at( row, column );
+      int cell = row * width + column;
+      if( currentCell->right != nullptr ) {
+        unite( cell, cell + 1 );
+        count++;
+      }
+      if( row < last_row && currentCell->down != nullptr ) {
+        unite( cell, cell + width );
+        count++;
+      }
+    }
+  }
+  *edges = count;
+}
+
+/*******************************************************************************
+% Routine Name: countBand
+% File:         MazeAnalytics.cpp
+% Parameters:   first_row   - first row of the band.
+%               last_row    - last row of the band.
+%               origin_root - set representative of the origin cell.
+%               roots       - output count of set representatives.
+%               unreachable - output count of cells outside the origin set.
+% Description:  Read-only pass over a finished forest, safe to run
+%               concurrently over disjoint bands.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeAnalytics::countBand( int first_row, int last_row, int origin_root,
+  long * roots, long * unreachable ) {
+
+  const int width = maze.getWidth();
+  long root_count = 0;
+  long outside_count = 0;
+  for( int cell = first_row * width; cell < (last_row + 1) * width; cell++ ) {
+    if( component[ cell ] == cell ) root_count++;
+    if( findConst(cell) != origin_root ) outside_count++;
+  }
+  *roots = root_count;
+  *unreachable = outside_count;
+}
+
+/*******************************************************************************
+% Routine Name: find
+% File:         MazeAnalytics.cpp
+% Parameters:   cell - index of a cell.
+% Description:  Finds the set representative, halving the path on the way.
+% Return:       Index of the representative cell.
+*******************************************************************************/
+int MazeAnalytics::find( int cell ) {
+  while( component[ cell ] != cell ) {
+    component[ cell ] = component[ component[ cell ] ];
+    cell = component[ cell ];
+  }
+  return cell;
+}
+
+/*******************************************************************************
+% Routine Name: findConst
+% File:         MazeAnalytics.cpp
+% Parameters:   cell - index of a cell.
+% Description:  Finds the set representative without path compression.
+% Return:       Index of the representative cell.
+*******************************************************************************/
+int MazeAnalytics::findConst( int cell ) const {
+  while( component[ cell ] != cell ) cell = component[ cell ];
+  return cell;
+}
+
+/*******************************************************************************
+% Routine Name: unite
+% File:         MazeAnalytics.cpp
+% Parameters:   cell_A - index of a cell.
+%               cell_B - index of a cell.
+% Description:  Merges the sets of two cells, the smaller index becomes root.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeAnalytics::unite( int cell_A, int cell_B ) {
+  int root_A = find( cell_A );
+  int root_B = find( cell_B );
+  if( root_A == root_B ) return;
+  if( root_A < root_B ) component[ root_B ] = root_A;
+  else component[ root_A ] = root_B;
+}
+
+/*******************************************************************************
+% Routine Name: neighbor
+% File:         MazeAnalytics.cpp
+% Parameters:   cell      - index of a cell.
+%               direction - 0 up, 1 right, 2 down, 3 left.
+% Description:  Looks up the open neighbor of a cell in a direction.
+% Return:       The neighbor, nullptr if a wall is in the way.
+*******************************************************************************/
+MazeCell * MazeAnalytics::neighbor( int cell, int direction ) {
+  const int width = maze.getWidth();
+  MazeCell * currentCell = maze.at( cell / width, cell % width );
+  switch( direction ) {
+    case 0: return currentCell->up;
+    case 1: return currentCell->right;
+    case 2: return currentCell->down;
+    default: return currentCell->left;
+  }
+}
+
+/*******************************************************************************
+% Routine Name: getComponentCount
+% File:         MazeAnalytics.cpp
+% Parameters:   None.
+% Description:  Getter method for the number of connected components.
+% Return:       Components found by the last analyze().
+*******************************************************************************/
+int MazeAnalytics::getComponentCount() {
+  return component_count;
+}
+
+/*******************************************************************************
+% Routine Name: getEdgeCount
+% File:         MazeAnalytics.cpp
+% Parameters:   None.
+% Description:  Getter method for the number of open edges.
+% Return:       Open edges found by the last analyze().
+*******************************************************************************/
+long MazeAnalytics::getEdgeCount() {
+  return edge_count;
+}
+
+/*******************************************************************************
+% Routine Name: getLoopCount
+% File:         MazeAnalytics.cpp
+% Parameters:   None.
+% Description:  Number of independent loops - the cyclomatic number of the
+%               maze graph, edges - cells + components.
+% Return:       Loops found by the last analyze().
+*******************************************************************************/
+long MazeAnalytics::getLoopCount() {
+  return edge_count - (long)component.size() + component_count;
+}
+
+/*******************************************************************************
+% Routine Name: isPerfect
+% File:         MazeAnalytics.cpp
+% Parameters:   None.
+% Description:  A perfect maze has exactly one path between any two cells.
+% Return:       True if the maze is connected and has no loops.
+*******************************************************************************/
+bool MazeAnalytics::isPerfect() {
+  return component_count == 1 && getLoopCount() == 0;
+}
+
+/*******************************************************************************
+% Routine Name: getUnreachableCount
+% File:         MazeAnalytics.cpp
+% Parameters:   None.
+% Description:  Getter method for the number of cells unreachable from the
+%               origin given to the last analyze().
+% Return:       The number of unreachable cells.
+*******************************************************************************/
+long MazeAnalytics::getUnreachableCount() {
+  return unreachable_count;
+}
+
+/*******************************************************************************
+% Routine Name: connected
+% File:         MazeAnalytics.cpp
+% Parameters:   cell_A - a cell in the maze.
+%               cell_B - a cell in the maze.
+% Description:  Compares the components of two cells from the last analyze().
+% Return:       True if a path exists between the cells.
+*******************************************************************************/
+bool MazeAnalytics::connected( MazeCell * cell_A, MazeCell * cell_B ) {
+  if( cell_A == nullptr || cell_B == nullptr || component.empty() ) return false;
+  const int width = maze.getWidth();
+  return find( cell_A->row * width + cell_A->column ) ==
+         find( cell_B->row * width + cell_B->column );
+}
+
+/*******************************************************************************
+% Routine Name: getBridges
+% File:         MazeAnalytics.cpp
+% Parameters:   None.
+% Description:  Getter method for the bridges found by the last analyzeCuts().
+% Return:       Cell pairs of every open edge whose wall would split the maze.
+*******************************************************************************/
+const std::vector<std::pair<MazeCell *, MazeCell *>> & MazeAnalytics::getBridges() {
+  return bridges;
+}
+
+/*******************************************************************************
+% Routine Name: getArticulationPoints
+% File:         MazeAnalytics.cpp
+% Parameters:   None.
+% Description:  Getter method for the articulation points found by the last
+%               analyzeCuts().
+% Return:       Cells whose removal would split their component.
+*******************************************************************************/
+const std::vector<MazeCell *> & MazeAnalytics::getArticulationPoints() {
+  return articulation_points;
+}
@@ -0,0 +1,78 @@
+/*******************************************************************************
+                                                    Jose Jorge Jimenez-Olivas
+                                                    Brandon Cramer
+
+                 University of California, San Diego
+                           IEEE Micromouse
+
+File Name:       MazeAnalytics.h
+Description:     Linear-time structural checks of the maze - connected
+                 components, loops, perfect-maze test, unreachable cells,
+                 bridges and articulation points.
+*******************************************************************************/
+#ifndef MAZE_ANALYTICS_H
+#define MAZE_ANALYTICS_H
+
+#include "Maze.h"
+#include <functional>
+
+#if !defined( ARDUINO )
+  #include <thread>
+#endif
+
+class MazeAnalytics {
+private:
+  Maze & maze;
+  int threads;
+  /* union-find forest over cell indices */
+  std::vector<int> component;
+  int component_count = 0;
+  long edge_count = 0;
+  long unreachable_count = 0;
+  std::vector<std::pair<MazeCell *, MazeCell *>> bridges;
+  std::vector<MazeCell *> articulation_points;
+
+  /* unions the open edges of a band of rows */
+  void unionBand( int first_row, int last_row, long * edges );
+  /* counts roots and cells outside a component over a band of rows */
+  void countBand( int first_row, int last_row, int origin_root,
+    long * roots, long * unreachable );
+  /* root of a cell with path halving */
+  int find( int cell );
+  /* root of a cell without modifying the forest */
+  int findConst( int cell ) const;
+  /* merges the sets of two cells */
+  void unite( int cell_A, int cell_B );
+  /* open neighbors of a cell index in the order up, right, down, left */
+  MazeCell * neighbor( int cell, int direction );
+
+public:
+  /* Creates an analytics module over the maze. */
+  MazeAnalytics( Maze & maze, int threads = 0 );
+  /* Computes components, edge, loop and unreachable cell counts. */
+  void analyze( MazeCell * origin = nullptr );
+  /* Computes bridges and articulation points with an iterative DFS. */
+  void analyzeCuts();
+  /* Getter method for the number of connected components. */
+  int getComponentCount();
+  /* Getter method for the number of open edges. */
+  long getEdgeCount();
+  /* Getter method for the number of independent loops. */
+  long getLoopCount();
+  /* Checks if the maze is a spanning tree of all its cells. */
+  bool isPerfect();
+  /* Getter method for the number of cells unreachable from the origin. */
+  long getUnreachableCount();
+  /* Checks if two cells are in the same connected component. */
+  bool connected( MazeCell * cell_A, MazeCell * cell_B );
+  /* Getter method for the open edges whose removal disconnects the maze. */
+  const std::vector<std::pair<MazeCell *, MazeCell *>> & getBridges();
+  /* Getter method for the cells whose removal disconnects the maze. */
+  const std::vector<MazeCell *> & getArticulationPoints();
+};
+
+#ifndef ARDUINO
+  #include "MazeAnalytics.cpp"
+#endif
+
+#endif /* MAZE_ANALYTICS_H */
@@ -15,6 +15,7 @@ Description:     Cell data structure of the maze and internal vertex for the
 #include <iostream>
 #include <vector>
 #include <string>
+#include "MazeInstrumentation.hpp"
 
 class MazeCell {
 public:
@@ -211,6 +212,7 @@ public:
   % Return:       An iterable list of neighbors.
   *****************************************************************************/
   std::vector<MazeCell *> getNeighborList() {
+    MAZE_COUNT( NEIGHBOR_QUERIES );
     std::vector<MazeCell *> neighbor_list = std::vector<MazeCell *>();
 
     if( up != nullptr ) neighbor_list.push_back( up );
@@ -235,13 +237,13 @@ public:
   /*****************************************************************************
   % Routine Name: operator =
   % File:         MazeCell.hpp
-  % Parameters:   cell - cell that will be copied. 
-  % Description:  calls the copy constructor on the cell passed. 
-  % Return:       A new copied MazeCell from the cell passed. 
+  % Parameters:   cell - cell that would be copied.
+  % Description:  Deleted - the location of a cell is fixed, and its links
+  %               belong to the maze that owns it. Copies keep only the
+  %               location, as the copy constructor does.
+  % Return:       Nothing.
   *****************************************************************************/
-  MazeCell operator=( const MazeCell & cell ) {
-    return MazeCell( cell );
-  }
+  MazeCell & operator=( const MazeCell & ) = delete;
 
 
   /*****************************************************************************
@@ -0,0 +1,366 @@
+/*******************************************************************************
+                                                    Jose Jorge Jimenez-Olivas
+                                                    Brandon Cramer
+
+                 University of California, San Diego
+                           IEEE Micromouse
+
+File Name:       MazeExplorationPlanner.cpp
+Description:     Decides when exploration can stop. Keeps optimistic (unknown
+                 sides open) and pessimistic (unknown sides walled) distance
+                 fields over the mouse's map and points the mouse at the
+                 nearest cell that could still shorten the best path.
+*******************************************************************************/
+#include "MazeExplorationPlanner.h"
+
+const int MazeExplorationPlanner::UNKNOWN_DISTANCE;
+
+/*******************************************************************************
+% Constructor: MazeExplorationPlanner
+% File:        MazeExplorationPlanner.cpp
+% Parameters:  maze  - map of the mouse, with every passage not yet sensed
+%                      walled, as a new Maze is.
+%              goals - cells the mouse has to reach.
+%              start - cell the final run starts from.
+% Description: Only the outer walls are known at first. Listens to the maze,
+%              so walls changed behind the planner's back refresh the fields.
+*******************************************************************************/
+MazeExplorationPlanner::MazeExplorationPlanner( Maze & maze,
+  const std::vector<MazeCell *> & goals, MazeCell * start ) : maze( maze ),
+  start( (start == nullptr) ? 0 : start->row * maze.getWidth() + start->column ) {
+
+  const int width = maze.getWidth();
+  const int height = maze.getHeight();
+  for( MazeCell * goal : goals ) {
+    if( goal == nullptr || maze.outOfBounds(goal->row, goal->column) ) continue;
+    this->goals.push_back( goal->row * width + goal->column );
+  }
+  known.assign( width * height, 0 );
+  for( int row = 0; row < height; row++ ) {
+    for( int column = 0; column < width; column++ ) {
+      known[ row * width + column ] = ( row == 0 ) * Maze::WALL_UP |
+        ( column == width - 1 ) * Maze::WALL_RIGHT |
+        ( row == height - 1 ) * Maze::WALL_DOWN | ( column == 0 ) * Maze::WALL_LEFT;
+    }
+  }
+  from_start.assign( width * height, UNKNOWN_DISTANCE );
+  to_goal.assign( width * height, UNKNOWN_DISTANCE );
+  confirmed.assign( width * height, UNKNOWN_DISTANCE );
+  queue.assign( width * height, 0 );
+  previous.assign( width * height, -1 );
+  maze.addListener( this );
+}
+
+/*******************************************************************************
+% Destructor:  ~MazeExplorationPlanner
+% File:        MazeExplorationPlanner.cpp
+% Parameters:  None.
+% Description: Stops listening to the maze for wall changes.
+*******************************************************************************/
+MazeExplorationPlanner::~MazeExplorationPlanner() {
+  maze.removeListener( this );
+}
+
+/*******************************************************************************
+% Routine Name: passable
+% File:         MazeExplorationPlanner.cpp
+% Parameters:   cell       - index of a cell.
+%               side       - 0 to 3 for up, right, down and left.
+%               optimistic - true to treat an unknown side as open.
+% Description:  Checks a side of a cell against the map and what is known.
+% Return:       True if the passage is open, or unknown and optimistic.
+*******************************************************************************/
+bool MazeExplorationPlanner::passable( int cell, int side, bool optimistic ) {
+  if( !(known[ cell ] & (1 << side)) ) return optimistic;
+  MazeCell * current = maze.at( cell / maze.getWidth(), cell % maze.getWidth() );
+  MazeCell * links[ 4 ] = { current->up, current->right, current->down, current->left };
+  return links[ side ] != nullptr;
+}
+
+/*******************************************************************************
+% Routine Name: flood
+% File:         MazeExplorationPlanner.cpp
+% Parameters:   distance   - set to the distance of every cell.
+%               sources    - indices of the cells at distance 0.
+%               optimistic - true to pass through unknown sides.
+% Description:  Breadth first search from the sources.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeExplorationPlanner::flood( std::vector<int> & distance,
+  const std::vector<int> & sources, bool optimistic ) {
+
+  const int width = maze.getWidth();
+  const int offsets[ 4 ] = { -width, 1, width, -1 };
+  std::fill( distance.begin(), distance.end(), UNKNOWN_DISTANCE );
+  int head = 0;
+  int tail = 0;
+  for( int source : sources ) {
+    if( distance[ source ] != UNKNOWN_DISTANCE ) continue;
+    distance[ source ] = 0;
+    queue[ tail++ ] = source;
+  }
+  while( head < tail ) {
+    const int cell = queue[ head++ ];
+    MAZE_COUNT( PLANNER_EXPANSIONS );
+    for( int side = 0; side < 4; side++ ) {
+      if( !passable(cell, side, optimistic) ) continue;
+      const int next = cell + offsets[ side ];
+      if( distance[ next ] != UNKNOWN_DISTANCE ) continue;
+      distance[ next ] = distance[ cell ] + 1;
+      queue[ tail++ ] = next;
+    }
+  }
+}
+
+/*******************************************************************************
+% Routine Name: update
+% File:         MazeExplorationPlanner.cpp
+% Parameters:   None.
+% Description:  Recomputes the three distance fields if the map or the known
+%               sides changed since the last query.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeExplorationPlanner::update() {
+  if( !stale ) return;
+  MAZE_TRACE_SCOPE( "MazeExplorationPlanner::update" );
+  flood( from_start, std::vector<int>( 1, start ), true );
+  flood( to_goal, goals, true );
+  flood( confirmed, goals, false );
+  stale = false;
+}
+
+/*******************************************************************************
+% Routine Name: sense
+% File:         MazeExplorationPlanner.cpp
+% Parameters:   cell   - a cell in the map.
+%               walls  - mask of WALL_UP, WALL_RIGHT, WALL_DOWN and WALL_LEFT
+%                        set for every side with a wall.
+%               sensed - mask of the sides the walls mask reports on.
+% Description:  Applies the reading to the map with Maze::applyWalls and
+%               marks the sensed sides known from both of their cells.
+% Return:       The result of Maze::applyWalls - nothing is marked on error.
+*******************************************************************************/
+int MazeExplorationPlanner::sense( MazeCell * cell, int walls, int sensed ) {
+  const int result = maze.applyWalls( cell, walls, sensed );
+  if( result < 0 ) return result;
+  const int width = maze.getWidth();
+  const int offsets[ 4 ] = { -width, 1, width, -1 };
+  const int index = cell->row * width + cell->column;
+  for( int side = 0; side < 4; side++ ) {
+    if( !(sensed & (1 << side)) || (known[ index ] & (1 << side)) ) continue;
+    known[ index ] |= 1 << side;
+    known[ index + offsets[ side ] ] |= 1 << ( (side + 2) % 4 );
+    stale = true;
+  }
+  return result;
+}
+
+/*******************************************************************************
+% Routine Name: getKnownSides
+% File:         MazeExplorationPlanner.cpp
+% Parameters:   cell - a cell in the map.
+% Description:  Getter method for the sides of a cell sensed so far, outer
+%               walls included.
+% Return:       Mask of WALL_UP, WALL_RIGHT, WALL_DOWN and WALL_LEFT.
+*******************************************************************************/
+int MazeExplorationPlanner::getKnownSides( MazeCell * cell ) {
+  if( cell == nullptr || maze.outOfBounds(cell->row, cell->column) ) return 0;
+  return known[ cell->row * maze.getWidth() + cell->column ];
+}
+
+/*******************************************************************************
+% Routine Name: getOptimisticLength
+% File:         MazeExplorationPlanner.cpp
+% Parameters:   None.
+% Description:  No path of the real maze is shorter than the shortest path
+%               with every unknown side open.
+% Return:       Lower bound of the shortest path length, or UNKNOWN_DISTANCE
+%               if the goals cannot be reached at all.
+*******************************************************************************/
+int MazeExplorationPlanner::getOptimisticLength() {
+  update();
+  return to_goal[ start ];
+}
+
+/*******************************************************************************
+% Routine Name: getConfirmedLength
+% File:         MazeExplorationPlanner.cpp
+% Parameters:   None.
+% Description:  Length of the best path the mouse can drive for sure.
+% Return:       Upper bound of the shortest path length, or UNKNOWN_DISTANCE
+%               if no path is confirmed yet.
+*******************************************************************************/
+int MazeExplorationPlanner::getConfirmedLength() {
+  update();
+  return confirmed[ start ];
+}
+
+/*******************************************************************************
+% Routine Name: isProven
+% File:         MazeExplorationPlanner.cpp
+% Parameters:   None.
+% Description:  The confirmed path is shortest once it is as short as the
+%               optimistic bound - no unknown wall can do better.
+% Return:       True if exploration can stop.
+*******************************************************************************/
+bool MazeExplorationPlanner::isProven() {
+  update();
+  return confirmed[ start ] != UNKNOWN_DISTANCE && confirmed[ start ] == to_goal[ start ];
+}
+
+/*******************************************************************************
+% Routine Name: canImprove
+% File:         MazeExplorationPlanner.cpp
+% Parameters:   cell - a cell in the map.
+% Description:  A cell is worth exploring if it has unknown sides and the
+%               best optimistic path through it is shorter than the confirmed
+%               path. Every other cell can be skipped for good.
+% Return:       True if the cell could still shorten the confirmed path.
+*******************************************************************************/
+bool MazeExplorationPlanner::canImprove( MazeCell * cell ) {
+  if( cell == nullptr || maze.outOfBounds(cell->row, cell->column) ) return false;
+  update();
+  const int index = cell->row * maze.getWidth() + cell->column;
+  if( known[ index ] == Maze::ALL_SIDES || from_start[ index ] == UNKNOWN_DISTANCE ||
+      to_goal[ index ] == UNKNOWN_DISTANCE ) {
+    return false;
+  }
+  const int through = from_start[ index ] + to_goal[ index ];
+  return confirmed[ start ] == UNKNOWN_DISTANCE || through < confirmed[ start ];
+}
+
+/*******************************************************************************
+% Routine Name: getCandidateCount
+% File:         MazeExplorationPlanner.cpp
+% Parameters:   None.
+% Description:  Counts the cells canImprove accepts.
+% Return:       Number of cells still worth exploring, 0 once proven.
+*******************************************************************************/
+int MazeExplorationPlanner::getCandidateCount() {
+  int count = 0;
+  for( MazeCell * cell : maze ) count += canImprove( cell );
+  return count;
+}
+
+/*******************************************************************************
+% Routine Name: plan
+% File:         MazeExplorationPlanner.cpp
+% Parameters:   origin - index of the cell of the mouse.
+% Description:  Breadth first search from the mouse over passages that may be
+%               open. A candidate costs the moves to reach it plus the detour
+%               of the best path through it over the optimistic length, so
+%               cells on an optimistic shortest path come first. The search
+%               stops once no further cell can cost less, and leaves the
+%               search tree in previous.
+% Return:       Index of the target cell, or -1 if no cell can improve.
+*******************************************************************************/
+int MazeExplorationPlanner::plan( int origin ) {
+  update();
+  const int width = maze.getWidth();
+  const int offsets[ 4 ] = { -width, 1, width, -1 };
+  std::fill( previous.begin(), previous.end(), -1 );
+  /* the queue holds one layer of equally distant cells after another */
+  int head = 0;
+  int tail = 0;
+  int layer_end = 0;
+  int travel = -1;
+  int target = -1;
+  int target_cost = 0;
+  const int best = to_goal[ start ];
+  previous[ origin ] = origin;
+  queue[ tail++ ] = origin;
+  while( head < tail ) {
+    if( head == layer_end ) {
+      /* no cell further away can beat the target found so far */
+      if( ++travel >= target_cost && target >= 0 ) break;
+      layer_end = tail;
+    }
+    const int cell = queue[ head++ ];
+    MAZE_COUNT( PLANNER_EXPANSIONS );
+    if( canImprove(maze.at(cell / width, cell % width)) ) {
+      const int cost = travel + from_start[ cell ] + to_goal[ cell ] - best;
+      if( target < 0 || cost < target_cost ) {
+        target = cell;
+        target_cost = cost;
+      }
+    }
+    for( int side = 0; side < 4; side++ ) {
+      if( !passable(cell, side, true) ) continue;
+      const int next = cell + offsets[ side ];
+      if( previous[ next ] >= 0 ) continue;
+      previous[ next ] = cell;
+      queue[ tail++ ] = next;
+    }
+  }
+  return target;
+}
+
+/*******************************************************************************
+% Routine Name: nextTarget
+% File:         MazeExplorationPlanner.cpp
+% Parameters:   mouse - cell of the mouse.
+% Description:  Cheapest cell to visit next - fewest moves to reach it plus
+%               the detour of the best path through it.
+% Return:       The target cell, or nullptr once the path is proven.
+*******************************************************************************/
+MazeCell * MazeExplorationPlanner::nextTarget( MazeCell * mouse ) {
+  if( mouse == nullptr || maze.outOfBounds(mouse->row, mouse->column) ) return nullptr;
+  const int target = plan( mouse->row * maze.getWidth() + mouse->column );
+  return ( target < 0 ) ? nullptr : maze.at( target / maze.getWidth(), target % maze.getWidth() );
+}
+
+/*******************************************************************************
+% Routine Name: nextStep
+% File:         MazeExplorationPlanner.cpp
+% Parameters:   mouse - cell of the mouse.
+% Description:  First move towards the next target. If the mouse already
+%               stands on the target it moves through an unknown side, which
+%               settles that side either way.
+% Return:       Neighbor of the mouse to move to, or nullptr once the path is
+%               proven.
+*******************************************************************************/
+MazeCell * MazeExplorationPlanner::nextStep( MazeCell * mouse ) {
+  if( mouse == nullptr || maze.outOfBounds(mouse->row, mouse->column) ) return nullptr;
+  const int width = maze.getWidth();
+  const int offsets[ 4 ] = { -width, 1, width, -1 };
+  const int origin = mouse->row * width + mouse->column;
+  int target = plan( origin );
+  if( target < 0 ) return nullptr;
+  if( target == origin ) {
+    for( int side = 0; side < 4; side++ ) {
+      if( !(known[ origin ] & (1 << side)) ) {
+        target = origin + offsets[ side ];
+        break;
+      }
+    }
+  }
+  while( previous[ target ] != origin && previous[ target ] != target ) {
+    target = previous[ target ];
+  }
+  return maze.at( target / width, target % width );
+}
+
+/*******************************************************************************
+% Routine Name: wallChanged
+% File:         MazeExplorationPlanner.cpp
+% Parameters:   cell_A - a cell in the maze.
+%               cell_B - a cell in the maze.
+% Description:  The map changed, so the fields are recomputed on demand.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeExplorationPlanner::wallChanged( MazeCell *, MazeCell * ) {
+  stale = true;
+}
+
+/*******************************************************************************
+% Routine Name: wallsChanged
+% File:         MazeExplorationPlanner.cpp
+% Parameters:   maze    - maze whose walls changed.
+%               changes - passages that flipped.
+%               count   - number of changes.
+% Description:  Marks the fields stale once for the whole batch.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeExplorationPlanner::wallsChanged( Maze &, const WallChange *, int ) {
+  stale = true;
+}
@@ -0,0 +1,82 @@
+/*******************************************************************************
+                                                    Jose Jorge Jimenez-Olivas
+                                                    Brandon Cramer
+
+                 University of California, San Diego
+                           IEEE Micromouse
+
+File Name:       MazeExplorationPlanner.h
+Description:     Decides when exploration can stop. Keeps optimistic (unknown
+                 sides open) and pessimistic (unknown sides walled) distance
+                 fields over the mouse's map and points the mouse at the
+                 nearest cell that could still shorten the best path.
+*******************************************************************************/
+#ifndef MAZE_EXPLORATION_PLANNER_H
+#define MAZE_EXPLORATION_PLANNER_H
+
+#include "Maze.h"
+
+class MazeExplorationPlanner : public MazeListener {
+private:
+  /* map of the walls sensed so far - unknown passages are walls in it */
+  Maze & maze;
+  std::vector<int> goals;
+  int start;
+  /* WALL_* mask of the sensed sides of each cell */
+  std::vector<uint8_t> known;
+  /* optimistic distances from the start and to the goals, and confirmed
+     distances to the goals over passages known to be open */
+  std::vector<int> from_start;
+  std::vector<int> to_goal;
+  std::vector<int> confirmed;
+  std::vector<int> queue;
+  std::vector<int> previous;
+  bool stale = true;
+
+  /* breadth first search from the sources over open or unknown passages */
+  void flood( std::vector<int> & distance, const std::vector<int> & sources,
+    bool optimistic );
+  /* recomputes the distance fields after the map changed */
+  void update();
+  /* cheapest cell to visit next from a cell, or -1 once nothing can improve */
+  int plan( int origin );
+  /* checks if a passage may be open */
+  bool passable( int cell, int side, bool optimistic );
+
+public:
+  static const int UNKNOWN_DISTANCE = -1;
+
+  /* Plans exploration of a map from the start cell to the goal cells. */
+  MazeExplorationPlanner( Maze & maze, const std::vector<MazeCell *> & goals,
+    MazeCell * start );
+  /* Detaches from the maze. */
+  ~MazeExplorationPlanner();
+  /* Applies a sensor reading to the map and marks its sides known. */
+  int sense( MazeCell * cell, int walls, int sensed = Maze::ALL_SIDES );
+  /* Getter method for the sensed sides of a cell. */
+  int getKnownSides( MazeCell * cell );
+  /* Length of the shortest path the unknown walls still allow. */
+  int getOptimisticLength();
+  /* Length of the shortest path over passages known to be open. */
+  int getConfirmedLength();
+  /* Checks if the confirmed path is a shortest path of the real maze. */
+  bool isProven();
+  /* Checks if exploring a cell could still shorten the confirmed path. */
+  bool canImprove( MazeCell * cell );
+  /* Number of cells that could still shorten the confirmed path. */
+  int getCandidateCount();
+  /* Nearest cell that could still shorten the confirmed path. */
+  MazeCell * nextTarget( MazeCell * mouse );
+  /* Neighbor of the mouse on the way to the next target. */
+  MazeCell * nextStep( MazeCell * mouse );
+  /* Recomputes the distance fields on the next query. */
+  void wallChanged( MazeCell * cell_A, MazeCell * cell_B ) override;
+  /* Recomputes the distance fields once for a batch of wall changes. */
+  void wallsChanged( Maze & maze, const WallChange * changes, int count ) override;
+};
+
+#ifndef ARDUINO
+  #include "MazeExplorationPlanner.cpp"
+#endif
+
+#endif /* MAZE_EXPLORATION_PLANNER_H */
@@ -0,0 +1,220 @@
+/*******************************************************************************
+                                                    Jose Jorge Jimenez-Olivas
+                                                    Brandon Cramer
+
+                 University of California, San Diego
+                           IEEE Micromouse
+
+File Name:       MazeFloodFill.cpp
+Description:     Resumable flood fill from a set of goal cells that expands a
+                 bounded number of cells per call, for fixed-budget control
+                 loops.
+*******************************************************************************/
+#include "MazeFloodFill.h"
+
+const int MazeFloodFill::UNKNOWN_DISTANCE;
+
+/*******************************************************************************
+% Constructor: MazeFloodFill
+% File:        MazeFloodFill.cpp
+% Parameters:  maze  - maze to search.
+%              goals - cells the distances are measured to.
+% Description: Allocates all search storage up front, so step never
+%              allocates, and listens to the maze for wall changes. The
+%              search itself starts on the first step.
+*******************************************************************************/
+MazeFloodFill::MazeFloodFill( Maze & maze, const std::vector<MazeCell *> & goals )
+  : maze( maze ) {
+
+  const int cells = maze.getWidth() * maze.getHeight();
+  stamp.assign( cells, 0 );
+  cell_distance.assign( cells, 0 );
+  queue.assign( cells, 0 );
+  setGoals( goals );
+  maze.addListener( this );
+}
+
+/*******************************************************************************
+% Destructor:  ~MazeFloodFill
+% File:        MazeFloodFill.cpp
+% Parameters:  None.
+% Description: Stops listening to the maze for wall changes.
+*******************************************************************************/
+MazeFloodFill::~MazeFloodFill() {
+  maze.removeListener( this );
+}
+
+/*******************************************************************************
+% Routine Name: setGoals
+% File:         MazeFloodFill.cpp
+% Parameters:   goals - cells the distances are measured to.
+% Description:  Replaces the goal cells. Cells outside the maze are ignored.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeFloodFill::setGoals( const std::vector<MazeCell *> & goals ) {
+  this->goals.clear();
+  for( MazeCell * goal : goals ) {
+    if( goal == nullptr || maze.outOfBounds(goal->row, goal->column) ) continue;
+    this->goals.push_back( goal->row * maze.getWidth() + goal->column );
+  }
+  restart_pending = true;
+}
+
+/*******************************************************************************
+% Routine Name: restart
+% File:         MazeFloodFill.cpp
+% Parameters:   None.
+% Description:  Starts a new generation, which invalidates every distance
+%               without touching the per cell arrays, and queues the goals.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeFloodFill::restart() {
+  if( ++generation == 0 ) {
+    /* stamps wrapped around - the only linear time restart */
+    std::fill( stamp.begin(), stamp.end(), 0 );
+    generation = 1;
+  }
+  queue_head = queue_size = 0;
+  for( int goal : goals ) reach( goal, 0 );
+  restart_pending = false;
+}
+
+/*******************************************************************************
+% Routine Name: reach
+% File:         MazeFloodFill.cpp
+% Parameters:   cell     - index of a cell.
+%               distance - distance of the cell to the nearest goal.
+% Description:  Records the distance of a cell first reached in this
+%               generation and queues it for expansion.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeFloodFill::reach( int cell, int distance ) {
+  if( stamp[ cell ] == generation ) return;
+  stamp[ cell ] = generation;
+  cell_distance[ cell ] = distance;
+  int tail = queue_head + queue_size++;
+  if( tail >= (int)queue.size() ) tail -= queue.size();
+  queue[ tail ] = cell;
+}
+
+/*******************************************************************************
+% Routine Name: step
+% File:         MazeFloodFill.cpp
+% Parameters:   max_expansions - budget of cells to expand in this call.
+% Description:  Continues the breadth first search from where the previous
+%               call stopped. Every expansion visits at most four neighbors
+%               and nothing is allocated, so the time of a call is bounded
+%               by its budget. A wall change since the last call restarts the
+%               search first, which costs time linear in the number of goals.
+% Return:       Number of cells expanded.
+*******************************************************************************/
+int MazeFloodFill::step( int max_expansions ) {
+  if( restart_pending ) restart();
+  const int width = maze.getWidth();
+  int expanded = 0;
+  while( expanded < max_expansions && queue_size > 0 ) {
+    const int cell = queue[ queue_head ];
+    if( ++queue_head == (int)queue.size() ) queue_head = 0;
+    queue_size--;
+
+    MazeCell * current = maze.at( cell / width, cell % width );
+    const int distance = cell_distance[ cell ] + 1;
+    if( current->up ) reach( cell - width, distance );
+    if( current->right ) reach( cell + 1, distance );
+    if( current->down ) reach( cell + width, distance );
+    if( current->left ) reach( cell - 1, distance );
+    expanded++;
+  }
+  expansions += expanded;
+  MAZE_COUNT_ADD( FLOOD_FILL_EXPANSIONS, expanded );
+  return expanded;
+}
+
+/*******************************************************************************
+% Routine Name: isFinal
+% File:         MazeFloodFill.cpp
+% Parameters:   None.
+% Description:  Checks if the search has run to completion on the current
+%               walls. Cells still without a distance are then unreachable.
+% Return:       True if every distance is final.
+*******************************************************************************/
+bool MazeFloodFill::isFinal() {
+  return !restart_pending && queue_size == 0;
+}
+
+/*******************************************************************************
+% Routine Name: getDistance
+% File:         MazeFloodFill.cpp
+% Parameters:   row    - row of the cell.
+%               column - column of the cell.
+% Description:  Distance from a cell to the nearest goal. Breadth first order
+%               makes a distance final as soon as the cell is reached, even
+%               before the whole search is.
+% Return:       The distance, or UNKNOWN_DISTANCE if the cell has not been
+%               reached or the walls changed since it was.
+*******************************************************************************/
+int MazeFloodFill::getDistance( int row, int column ) {
+  if( restart_pending || maze.outOfBounds(row, column) ) return UNKNOWN_DISTANCE;
+  const int cell = row * maze.getWidth() + column;
+  return ( stamp[ cell ] == generation ) ? cell_distance[ cell ] : UNKNOWN_DISTANCE;
+}
+
+/*******************************************************************************
+% Routine Name: getDistance
+% File:         MazeFloodFill.cpp
+% Parameters:   cell - a cell in the maze.
+% Description:  Delegates to getDistance(row, column).
+% Return:       The distance, or UNKNOWN_DISTANCE.
+*******************************************************************************/
+int MazeFloodFill::getDistance( MazeCell * cell ) {
+  if( cell == nullptr ) return UNKNOWN_DISTANCE;
+  return getDistance( cell->row, cell->column );
+}
+
+/*******************************************************************************
+% Routine Name: getQueueSize
+% File:         MazeFloodFill.cpp
+% Parameters:   None.
+% Description:  Getter method for the cells reached but not yet expanded.
+% Return:       Number of queued cells.
+*******************************************************************************/
+int MazeFloodFill::getQueueSize() {
+  return queue_size;
+}
+
+/*******************************************************************************
+% Routine Name: getExpansionCount
+% File:         MazeFloodFill.cpp
+% Parameters:   None.
+% Description:  Getter method for the total work done by the search.
+% Return:       Number of cells expanded since construction.
+*******************************************************************************/
+long MazeFloodFill::getExpansionCount() {
+  return expansions;
+}
+
+/*******************************************************************************
+% Routine Name: wallChanged
+% File:         MazeFloodFill.cpp
+% Parameters:   cell_A - a cell in the maze.
+%               cell_B - a cell in the maze.
+% Description:  Any wall change can shorten or lengthen distances already
+%               handed out, so the search restarts on the next step.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeFloodFill::wallChanged( MazeCell *, MazeCell * ) {
+  restart_pending = true;
+}
+
+/*******************************************************************************
+% Routine Name: wallsChanged
+% File:         MazeFloodFill.cpp
+% Parameters:   maze    - maze whose walls changed.
+%               changes - passages that flipped.
+%               count   - number of changes.
+% Description:  Restarts the search once for the whole batch.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeFloodFill::wallsChanged( Maze &, const WallChange *, int ) {
+  restart_pending = true;
+}
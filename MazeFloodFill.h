@@ -0,0 +1,70 @@
+/*******************************************************************************
+                                                    Jose Jorge Jimenez-Olivas
+                                                    Brandon Cramer
+
+                 University of California, San Diego
+                           IEEE Micromouse
+
+File Name:       MazeFloodFill.h
+Description:     Resumable flood fill from a set of goal cells that expands a
+                 bounded number of cells per call, for fixed-budget control
+                 loops.
+*******************************************************************************/
+#ifndef MAZE_FLOOD_FILL_H
+#define MAZE_FLOOD_FILL_H
+
+#include "Maze.h"
+
+class MazeFloodFill : public MazeListener {
+private:
+  Maze & maze;
+  std::vector<int> goals;
+  /* distance of a cell is valid only if its stamp matches the generation */
+  std::vector<uint32_t> stamp;
+  std::vector<int> cell_distance;
+  uint32_t generation = 0;
+  /* ring buffer of cell indices - every cell is queued at most once */
+  std::vector<int> queue;
+  int queue_head = 0;
+  int queue_size = 0;
+  /* the walls changed since the search started */
+  bool restart_pending = true;
+  long expansions = 0;
+
+  /* discards all distances and queues the goals, in time linear in goals */
+  void restart();
+  /* records a distance and queues a cell not yet reached in this generation */
+  void reach( int cell, int distance );
+
+public:
+  static const int UNKNOWN_DISTANCE = -1;
+
+  /* Creates a search towards the given goal cells. */
+  MazeFloodFill( Maze & maze, const std::vector<MazeCell *> & goals );
+  /* Detaches from the maze. */
+  ~MazeFloodFill();
+  /* Replaces the goal cells and restarts the search. */
+  void setGoals( const std::vector<MazeCell *> & goals );
+  /* Expands at most max_expansions cells of the search. */
+  int step( int max_expansions );
+  /* Checks if every distance is final for the current walls. */
+  bool isFinal();
+  /* Distance from a cell to the nearest goal, once the cell is reached. */
+  int getDistance( int row, int column );
+  /* overloaded - delegates to getDistance(row, column) */
+  int getDistance( MazeCell * cell );
+  /* Getter method for the number of cells waiting to be expanded. */
+  int getQueueSize();
+  /* Getter method for the number of cells expanded since construction. */
+  long getExpansionCount();
+  /* Restarts the search on the next step. */
+  void wallChanged( MazeCell * cell_A, MazeCell * cell_B ) override;
+  /* Restarts the search once for a batch of wall changes. */
+  void wallsChanged( Maze & maze, const WallChange * changes, int count ) override;
+};
+
+#ifndef ARDUINO
+  #include "MazeFloodFill.cpp"
+#endif
+
+#endif /* MAZE_FLOOD_FILL_H */
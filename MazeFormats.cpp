@@ -0,0 +1,537 @@
+/*******************************************************************************
+                                                    Jose Jorge Jimenez-Olivas
+                                                    Brandon Cramer
+
+                 University of California, San Diego
+                           IEEE Micromouse
+
+File Name:       MazeFormats.cpp
+Description:     Importers and exporters for the maze formats of the public
+                 micromouse collections - ASCII post drawings, the drawing of
+                 Maze::operator const char *, and binary .maz files with one
+                 wall byte per cell. Imports go straight into the passage
+                 planes in a single pass.
+*******************************************************************************/
+#include "MazeFormats.h"
+
+const int MazeFormats::MAZ_NORTH;
+const int MazeFormats::MAZ_EAST;
+const int MazeFormats::MAZ_SOUTH;
+const int MazeFormats::MAZ_WEST;
+
+/* Helper Functions */
+namespace MazeFormatsHelper {
+  const char * nextLine( const char * line, const char * end, size_t & length );
+  size_t rowPrefix( const char * line, size_t length );
+  bool isDrawing( const char * text, size_t size );
+  void closePassage( std::vector<uint64_t> & plane, int stride, int row, int column );
+  bool isOpen( const std::vector<uint64_t> & plane, int stride, int row, int column );
+  bool isMazFile( const char * filename );
+  bool readFile( const char * filename, std::vector<uint8_t> & bytes );
+}
+
+/*******************************************************************************
+% Routine Name: textDimensions
+% File:         MazeFormats.cpp
+% Parameters:   text   - characters of a text drawing.
+%               size   - number of characters.
+%               width  - output width of the drawn maze.
+%               height - output height of the drawn maze.
+% Description:  Reads the dimensions from the shape of the drawing. A POSTS
+%               drawing is 4 * width + 1 columns by 2 * height + 1 lines, and
+%               a DRAWING has one numbered line per row of 2 columns per cell.
+%               Trailing blank lines and carriage returns are ignored.
+% Return:       True if the text is a drawing of either style.
+*******************************************************************************/
+bool MazeFormats::textDimensions( const char * text, size_t size, int & width,
+  int & height ) {
+
+  if( text == nullptr || size == 0 ) return false;
+  const char * end = text + size;
+  size_t length;
+
+  if( MazeFormatsHelper::isDrawing(text, size) ) {
+    int rows = 0;
+    int columns = 0;
+    for( const char * line = text; line < end; ) {
+      const char * next = MazeFormatsHelper::nextLine( line, end, length );
+      size_t prefix = MazeFormatsHelper::rowPrefix( line, length );
+      if( prefix ) {
+        /* rows are numbered from 0 in order, each as wide as the first */
+        if( std::atoi(line) != rows ) return false;
+        if( rows == 0 ) columns = ( length - prefix ) / 2;
+        rows++;
+      }
+      line = next;
+    }
+    if( rows == 0 || columns == 0 ) return false;
+    width = columns;
+    height = rows;
+    return true;
+  }
+
+  MazeFormatsHelper::nextLine( text, end, length );
+  if( length < 5 || (length - 1) % 4 != 0 ) return false;
+  int lines = 0;
+  int drawn_lines = 0;
+  for( const char * line = text; line < end; ) {
+    const char * next = MazeFormatsHelper::nextLine( line, end, length );
+    lines++;
+    for( size_t column = 0; column < length; column++ ) {
+      if( line[ column ] != ' ' && line[ column ] != '\t' ) {
+        drawn_lines = lines;
+        break;
+      }
+    }
+    line = next;
+  }
+  if( drawn_lines < 3 || drawn_lines % 2 == 0 ) return false;
+  MazeFormatsHelper::nextLine( text, end, length );
+  width = ( length - 1 ) / 4;
+  height = ( drawn_lines - 1 ) / 2;
+  return true;
+}
+
+/*******************************************************************************
+% Routine Name: readText
+% File:         MazeFormats.cpp
+% Parameters:   text - characters of a text drawing.
+%               size - number of characters.
+%               maze - maze of the drawn dimensions to write the walls into.
+% Description:  Parses a drawing of either style in one pass over its lines,
+%               closing passages in a pair of all-open planes that are then
+%               applied with Maze::setPassagePlanes. In a POSTS drawing any
+%               character other than a space marks a wall, and the inside of
+%               the cells - start or goal marks, say - is ignored. The outer
+%               boundary is always walled.
+% Return:       False if the text is not a drawing of the maze dimensions, in
+%               which case the maze is left as it was.
+*******************************************************************************/
+bool MazeFormats::readText( const char * text, size_t size, Maze & maze ) {
+  int width, height;
+  if( !textDimensions(text, size, width, height) || width != maze.getWidth() ||
+      height != maze.getHeight() ) {
+    return false;
+  }
+  MAZE_TRACE_SCOPE( "MazeFormats::readText" );
+  MAZE_COUNT_ADD( BYTES_READ, size );
+  const int stride = maze.getPlaneStride();
+  std::vector<uint64_t> right( (size_t)height * stride, ~(uint64_t)0 );
+  std::vector<uint64_t> down( (size_t)height * stride, ~(uint64_t)0 );
+  const char * end = text + size;
+  size_t length;
+
+  if( MazeFormatsHelper::isDrawing(text, size) ) {
+    int row = 0;
+    for( const char * line = text; line < end && row < height; ) {
+      const char * next = MazeFormatsHelper::nextLine( line, end, length );
+      size_t prefix = MazeFormatsHelper::rowPrefix( line, length );
+      if( prefix ) {
+        /* two characters per cell - bottom wall, then right wall */
+        for( int column = 0; column < width; column++ ) {
+          size_t position = prefix + 2 * column;
+          if( position < length && line[ position ] != ' ' ) {
+            MazeFormatsHelper::closePassage( down, stride, row, column );
+          }
+          if( position + 1 < length && line[ position + 1 ] != ' ' ) {
+            MazeFormatsHelper::closePassage( right, stride, row, column );
+          }
+        }
+        row++;
+      }
+      line = next;
+    }
+    return maze.setPassagePlanes( right, down );
+  }
+
+  int line_index = 0;
+  for( const char * line = text; line < end && line_index <= 2 * height; ) {
+    const char * next = MazeFormatsHelper::nextLine( line, end, length );
+    const int row = line_index / 2;
+    if( line_index % 2 == 0 ) {
+      /* post line - the middle of each segment walls the cells it divides */
+      for( int column = 0; row > 0 && row < height && column < width; column++ ) {
+        size_t position = 4 * column + 2;
+        if( position < length && line[ position ] != ' ' ) {
+          MazeFormatsHelper::closePassage( down, stride, row - 1, column );
+        }
+      }
+    }
+    else {
+      /* cell line - the character between two cells walls them */
+      for( int column = 1; column < width; column++ ) {
+        size_t position = 4 * column;
+        if( position < length && line[ position ] != ' ' ) {
+          MazeFormatsHelper::closePassage( right, stride, row, column - 1 );
+        }
+      }
+    }
+    line_index++;
+    line = next;
+  }
+  return maze.setPassagePlanes( right, down );
+}
+
+/*******************************************************************************
+% Routine Name: writeText
+% File:         MazeFormats.cpp
+% Parameters:   maze  - maze to draw.
+%               style - POSTS for "o---o" drawings, DRAWING for the output of
+%                       Maze::operator const char *.
+% Description:  Draws the walls of the maze one line at a time. A POSTS
+%               drawing uses 'o' posts, "---" and '|' walls and a newline
+%               after every line, which is the layout of the public maze
+%               collections, so their files round-trip byte for byte.
+% Return:       The drawing.
+*******************************************************************************/
+std::string MazeFormats::writeText( Maze & maze, TextStyle style ) {
+  if( style == DRAWING ) return std::string( (const char *) maze );
+
+  MAZE_TRACE_SCOPE( "MazeFormats::writeText" );
+  const int width = maze.getWidth();
+  const int height = maze.getHeight();
+  const int stride = maze.getPlaneStride();
+  const std::vector<uint64_t> & right = maze.getRightPlane();
+  const std::vector<uint64_t> & down = maze.getDownPlane();
+  std::string text;
+  text.reserve( (size_t)(4 * width + 2) * (2 * height + 1) );
+
+  for( int row = 0; row <= height; row++ ) {
+    /* walls above the row */
+    text += 'o';
+    for( int column = 0; column < width; column++ ) {
+      bool wall = ( row == 0 || row == height ||
+                    !MazeFormatsHelper::isOpen(down, stride, row - 1, column) );
+      text += wall ? "---o" : "   o";
+    }
+    text += '\n';
+    if( row == height ) break;
+
+    /* walls between the cells of the row */
+    text += '|';
+    for( int column = 0; column < width; column++ ) {
+      bool wall = ( column == width - 1 ||
+                    !MazeFormatsHelper::isOpen(right, stride, row, column) );
+      text += wall ? "   |" : "    ";
+    }
+    text += '\n';
+  }
+  MAZE_COUNT_ADD( BYTES_WRITTEN, text.size() );
+  return text;
+}
+
+/*******************************************************************************
+% Routine Name: mazDimensions
+% File:         MazeFormats.cpp
+% Parameters:   size   - number of bytes of a .maz file.
+%               width  - output width of the stored maze.
+%               height - output height of the stored maze.
+% Description:  A .maz file holds one byte per cell of a square maze - 256
+%               bytes for the classic 16x16 maze, 1024 for a 32x32 one.
+% Return:       True if the size is that of a square maze.
+*******************************************************************************/
+bool MazeFormats::mazDimensions( size_t size, int & width, int & height ) {
+  size_t side = (size_t)std::sqrt( (double)size );
+  while( side * side > size ) side--;
+  while( (side + 1) * (side + 1) <= size ) side++;
+  if( side == 0 || side * side != size || side > INT_MAX ) return false;
+  width = height = (int)side;
+  return true;
+}
+
+/*******************************************************************************
+% Routine Name: readMaz
+% File:         MazeFormats.cpp
+% Parameters:   data - bytes of a .maz file.
+%               size - number of bytes.
+%               maze - square maze of the stored dimensions.
+% Description:  Cells are stored column after column from the west, each
+%               column from the south - byte x * side + y is the cell in
+%               column x and row side - 1 - y of the maze. A wall reported by
+%               either of its cells closes the passage, and the bytes are read
+%               in order in a single pass.
+% Return:       False if the size does not match the maze, in which case the
+%               maze is left as it was.
+*******************************************************************************/
+bool MazeFormats::readMaz( const uint8_t * data, size_t size, Maze & maze ) {
+  int width, height;
+  if( data == nullptr || !mazDimensions(size, width, height) ||
+      width != maze.getWidth() || height != maze.getHeight() ) {
+    return false;
+  }
+  MAZE_TRACE_SCOPE( "MazeFormats::readMaz" );
+  MAZE_COUNT_ADD( BYTES_READ, size );
+  const int side = width;
+  const int stride = maze.getPlaneStride();
+  std::vector<uint64_t> right( (size_t)side * stride, ~(uint64_t)0 );
+  std::vector<uint64_t> down( (size_t)side * stride, ~(uint64_t)0 );
+
+  for( int x = 0; x < side; x++ ) {
+    for( int y = 0; y < side; y++ ) {
+      const int walls = *data++;
+      const int row = side - 1 - y;
+      if( (walls & MAZ_EAST) && x < side - 1 ) {
+        MazeFormatsHelper::closePassage( right, stride, row, x );
+      }
+      if( (walls & MAZ_WEST) && x > 0 ) {
+        MazeFormatsHelper::closePassage( right, stride, row, x - 1 );
+      }
+      if( (walls & MAZ_SOUTH) && row < side - 1 ) {
+        MazeFormatsHelper::closePassage( down, stride, row, x );
+      }
+      if( (walls & MAZ_NORTH) && row > 0 ) {
+        MazeFormatsHelper::closePassage( down, stride, row - 1, x );
+      }
+    }
+  }
+  return maze.setPassagePlanes( right, down );
+}
+
+/*******************************************************************************
+% Routine Name: writeMaz
+% File:         MazeFormats.cpp
+% Parameters:   maze - square maze to encode.
+% Description:  Encodes every cell as a byte of its four walls, the boundary
+%               included, in the order readMaz reads them. Files whose walls
+%               agree from both sides round-trip byte for byte.
+% Return:       The bytes of the file - empty if the maze is not square.
+*******************************************************************************/
+std::vector<uint8_t> MazeFormats::writeMaz( Maze & maze ) {
+  std::vector<uint8_t> data;
+  if( maze.getWidth() != maze.getHeight() || maze.getWidth() == 0 ) return data;
+  MAZE_TRACE_SCOPE( "MazeFormats::writeMaz" );
+  const int side = maze.getWidth();
+  const int stride = maze.getPlaneStride();
+  const std::vector<uint64_t> & right = maze.getRightPlane();
+  const std::vector<uint64_t> & down = maze.getDownPlane();
+  data.resize( (size_t)side * side );
+
+  uint8_t * cell = data.data();
+  for( int x = 0; x < side; x++ ) {
+    for( int y = 0; y < side; y++ ) {
+      const int row = side - 1 - y;
+      int walls = 0;
+      if( row == 0 || !MazeFormatsHelper::isOpen(down, stride, row - 1, x) ) {
+        walls |= MAZ_NORTH;
+      }
+      if( x == side - 1 || !MazeFormatsHelper::isOpen(right, stride, row, x) ) {
+        walls |= MAZ_EAST;
+      }
+      if( row == side - 1 || !MazeFormatsHelper::isOpen(down, stride, row, x) ) {
+        walls |= MAZ_SOUTH;
+      }
+      if( x == 0 || !MazeFormatsHelper::isOpen(right, stride, row, x - 1) ) {
+        walls |= MAZ_WEST;
+      }
+      *cell++ = walls;
+    }
+  }
+  MAZE_COUNT_ADD( BYTES_WRITTEN, data.size() );
+  return data;
+}
+
+/*******************************************************************************
+% Routine Name: fileDimensions
+% File:         MazeFormats.cpp
+% Parameters:   filename - a .maz file, or a text drawing of either style.
+%               width    - output width of the stored maze.
+%               height   - output height of the stored maze.
+% Description:  Reads the dimensions of a file, a .maz file if its name ends
+%               in ".maz" and a text drawing otherwise.
+% Return:       True if the file holds a maze.
+*******************************************************************************/
+bool MazeFormats::fileDimensions( const char * filename, int & width, int & height ) {
+  #ifndef ARDUINO
+  std::vector<uint8_t> bytes;
+  if( !MazeFormatsHelper::readFile(filename, bytes) ) return false;
+  if( MazeFormatsHelper::isMazFile(filename) ) {
+    return mazDimensions( bytes.size(), width, height );
+  }
+  return textDimensions( (const char *) bytes.data(), bytes.size(), width, height );
+  #else
+  return false;
+  #endif
+}
+
+/*******************************************************************************
+% Routine Name: load
+% File:         MazeFormats.cpp
+% Parameters:   filename - a .maz file, or a text drawing of either style.
+%               maze     - maze of the stored dimensions.
+% Description:  Reads the whole file with one open and imports it with
+%               readMaz or readText, by the file extension.
+% Return:       Load status - the maze is left as it was on failure.
+*******************************************************************************/
+bool MazeFormats::load( const char * filename, Maze & maze ) {
+  #ifndef ARDUINO
+  std::vector<uint8_t> bytes;
+  if( !MazeFormatsHelper::readFile(filename, bytes) ) return false;
+  if( MazeFormatsHelper::isMazFile(filename) ) {
+    return readMaz( bytes.data(), bytes.size(), maze );
+  }
+  return readText( (const char *) bytes.data(), bytes.size(), maze );
+  #else
+  return false;
+  #endif
+}
+
+/*******************************************************************************
+% Routine Name: save
+% File:         MazeFormats.cpp
+% Parameters:   filename - file to write, a .maz file if it ends in ".maz" and
+%                          a POSTS drawing otherwise.
+%               maze     - maze to write.
+% Description:  Encodes the maze with writeMaz or writeText and writes it.
+% Return:       Save status - false for a .maz file of a maze not square.
+*******************************************************************************/
+bool MazeFormats::save( const char * filename, Maze & maze ) {
+  #ifndef ARDUINO
+  std::string text;
+  std::vector<uint8_t> bytes;
+  const char * data;
+  size_t size;
+  if( MazeFormatsHelper::isMazFile(filename) ) {
+    bytes = writeMaz( maze );
+    if( bytes.empty() ) return false;
+    data = (const char *) bytes.data();
+    size = bytes.size();
+  }
+  else {
+    text = writeText( maze );
+    data = text.data();
+    size = text.size();
+  }
+  std::ofstream outstream( filename, std::ios::out | std::ios::binary );
+  if( !outstream.is_open() ) {
+    std::cerr << "Unable to open file: " << filename << std::endl;
+    return false;
+  }
+  outstream.write( data, size );
+  return (bool)outstream;
+  #else
+  return false;
+  #endif
+}
+
+/*******************************************************************************
+% Routine Name: nextLine
+% File:         MazeFormats.cpp
+% Parameters:   line   - start of a line.
+%               end    - end of the text.
+%               length - output length of the line, without "\r\n" or "\n".
+% Description:  Finds the end of a line.
+% Return:       Start of the next line, or end.
+*******************************************************************************/
+const char * MazeFormatsHelper::nextLine( const char * line, const char * end,
+  size_t & length ) {
+
+  const char * newline = (const char *)std::memchr( line, '\n', end - line );
+  const char * line_end = newline ? newline : end;
+  length = line_end - line;
+  if( length && line[ length - 1 ] == '\r' ) length--;
+  return newline ? newline + 1 : end;
+}
+
+/*******************************************************************************
+% Routine Name: rowPrefix
+% File:         MazeFormats.cpp
+% Parameters:   line   - a line of a DRAWING.
+%               length - length of the line.
+% Description:  Matches the "<row>\t|" start of a row of a DRAWING.
+% Return:       Length of the prefix, 0 if the line is not a row.
+*******************************************************************************/
+size_t MazeFormatsHelper::rowPrefix( const char * line, size_t length ) {
+  size_t digits = 0;
+  while( digits < length && line[ digits ] >= '0' && line[ digits ] <= '9' ) digits++;
+  if( digits == 0 || digits + 2 > length ) return 0;
+  if( line[ digits ] != '\t' || line[ digits + 1 ] != '|' ) return 0;
+  return digits + 2;
+}
+
+/*******************************************************************************
+% Routine Name: isDrawing
+% File:         MazeFormats.cpp
+% Parameters:   text - characters of a text drawing.
+%               size - number of characters.
+% Description:  A DRAWING starts with tab-indented column indices, while a
+%               POSTS drawing starts with a line of posts and walls.
+% Return:       True for a DRAWING.
+*******************************************************************************/
+bool MazeFormatsHelper::isDrawing( const char * text, size_t size ) {
+  size_t length;
+  nextLine( text, text + size, length );
+  return std::memchr( text, '\t', length ) != nullptr;
+}
+
+/*******************************************************************************
+% Routine Name: closePassage
+% File:         MazeFormats.cpp
+% Parameters:   plane  - packed passage plane.
+%               stride - words per row of the plane.
+%               row    - row of the cell left of or above the passage.
+%               column - column of that cell.
+% Description:  Clears the bit of a passage.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeFormatsHelper::closePassage( std::vector<uint64_t> & plane, int stride,
+  int row, int column ) {
+
+  plane[ (size_t)row * stride + column / 64 ] &= ~( (uint64_t)1 << (column % 64) );
+}
+
+/*******************************************************************************
+% Routine Name: isOpen
+% File:         MazeFormats.cpp
+% Parameters:   plane  - packed passage plane.
+%               stride - words per row of the plane.
+%               row    - row of the cell left of or above the passage.
+%               column - column of that cell.
+% Description:  Reads the bit of a passage.
+% Return:       True if the passage is open.
+*******************************************************************************/
+bool MazeFormatsHelper::isOpen( const std::vector<uint64_t> & plane, int stride,
+  int row, int column ) {
+
+  return ( plane[ (size_t)row * stride + column / 64 ] >> (column % 64) ) & 1;
+}
+
+/*******************************************************************************
+% Routine Name: isMazFile
+% File:         MazeFormats.cpp
+% Parameters:   filename - name of a file.
+% Description:  Checks for the ".maz" extension, in any case.
+% Return:       True for a .maz file.
+*******************************************************************************/
+bool MazeFormatsHelper::isMazFile( const char * filename ) {
+  size_t length = std::strlen( filename );
+  if( length < 4 ) return false;
+  const char * extension = filename + length - 4;
+  return extension[ 0 ] == '.' && std::tolower( extension[ 1 ] ) == 'm' &&
+         std::tolower( extension[ 2 ] ) == 'a' && std::tolower( extension[ 3 ] ) == 'z';
+}
+
+/*******************************************************************************
+% Routine Name: readFile
+% File:         MazeFormats.cpp
+% Parameters:   filename - file to read.
+%               bytes    - output contents of the file.
+% Description:  Reads a whole file with a single open and read.
+% Return:       True if the file was read.
+*******************************************************************************/
+bool MazeFormatsHelper::readFile( const char * filename, std::vector<uint8_t> & bytes ) {
+  #ifndef ARDUINO
+  std::ifstream instream( filename, std::ios::in | std::ios::binary );
+  if( !instream.is_open() ) {
+    std::cerr << "Unable to open file: " << filename << std::endl;
+    return false;
+  }
+  instream.seekg( 0, instream.end );
+  std::streamoff size = instream.tellg();
+  if( size < 0 ) return false;
+  instream.seekg( 0, instream.beg );
+  bytes.resize( (size_t)size );
+  return (bool)instream.read( (char *) bytes.data(), size );
+  #else
+  return false;
+  #endif
+}
@@ -0,0 +1,63 @@
+/*******************************************************************************
+                                                    Jose Jorge Jimenez-Olivas
+                                                    Brandon Cramer
+
+                 University of California, San Diego
+                           IEEE Micromouse
+
+File Name:       MazeFormats.h
+Description:     Importers and exporters for the maze formats of the public
+                 micromouse collections - ASCII post drawings, the drawing of
+                 Maze::operator const char *, and binary .maz files with one
+                 wall byte per cell. Imports go straight into the passage
+                 planes in a single pass.
+*******************************************************************************/
+#ifndef MAZE_FORMATS_H
+#define MAZE_FORMATS_H
+
+#include "Maze.h"
+#include <cctype>
+#include <cstdlib>
+
+class MazeFormats {
+public:
+  /* layout of a text drawing */
+  enum TextStyle {
+    /* posts, "---" walls and "|" walls - "o---o" rows, 4 columns per cell */
+    POSTS,
+    /* the drawing of Maze::operator const char * - "_" and "|" walls */
+    DRAWING
+  };
+
+  /* wall bits of a .maz cell byte */
+  static const int MAZ_NORTH = 0x1;
+  static const int MAZ_EAST = 0x2;
+  static const int MAZ_SOUTH = 0x4;
+  static const int MAZ_WEST = 0x8;
+
+  /* Reads the dimensions of a text drawing held in memory. */
+  static bool textDimensions( const char * text, size_t size, int & width,
+                              int & height );
+  /* Replaces the walls of a maze from a text drawing of either style. */
+  static bool readText( const char * text, size_t size, Maze & maze );
+  /* Draws the walls of a maze as text. */
+  static std::string writeText( Maze & maze, TextStyle style = POSTS );
+  /* Reads the dimensions of a square .maz file from its size. */
+  static bool mazDimensions( size_t size, int & width, int & height );
+  /* Replaces the walls of a maze from a .maz file held in memory. */
+  static bool readMaz( const uint8_t * data, size_t size, Maze & maze );
+  /* Encodes the walls of a square maze as a .maz file. */
+  static std::vector<uint8_t> writeMaz( Maze & maze );
+  /* Reads the dimensions of a .maz or text file. */
+  static bool fileDimensions( const char * filename, int & width, int & height );
+  /* Replaces the walls of a maze from a .maz or text file. */
+  static bool load( const char * filename, Maze & maze );
+  /* Writes a maze to a .maz or text file, by the file extension. */
+  static bool save( const char * filename, Maze & maze );
+};
+
+#ifndef ARDUINO
+  #include "MazeFormats.cpp"
+#endif
+
+#endif /* MAZE_FORMATS_H */
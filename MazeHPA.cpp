@@ -0,0 +1,629 @@
+/*******************************************************************************
+                                                    Jose Jorge Jimenez-Olivas
+                                                    Brandon Cramer
+
+                 University of California, San Diego
+                           IEEE Micromouse
+
+File Name:       MazeHPA.cpp
+Description:     Hierarchical path-finding (HPA*) abstraction over the maze.
+                 The maze is split into square clusters whose entrances form a
+                 small abstract graph that answers path queries quickly.
+*******************************************************************************/
+#include "MazeHPA.h"
+
+#if !defined( ARDUINO )
+  #include <chrono>
+#endif
+
+/* Helper Functions */
+namespace MazeHPAHelper {
+  unsigned long currentMicros();
+}
+
+const int MazeHPA::DEFAULT_CLUSTER_SIZE;
+const int MazeHPA::MAX_ENTRANCE_WIDTH;
+const int MazeHPA::INFINITE_COST;
+
+/*******************************************************************************
+% Constructor: MazeHPA
+% File:        MazeHPA.cpp
+% Parameters:  maze         - maze to build the abstraction over.
+%              cluster_size - width and height, in unit cells, of a cluster.
+% Description: Splits the maze into clusters, builds the abstract graph and
+%              listens to the maze for wall changes.
+*******************************************************************************/
+MazeHPA::MazeHPA( Maze & maze, int cluster_size ) : maze( maze ),
+  cluster_size( (cluster_size > 0) ? cluster_size : DEFAULT_CLUSTER_SIZE ) {
+
+  const int size = this->cluster_size;
+  cluster_rows = ( maze.getHeight() + size - 1 ) / size;
+  cluster_columns = ( maze.getWidth() + size - 1 ) / size;
+  clusters = std::vector<Cluster>( cluster_rows * cluster_columns );
+  local_distance = std::vector<int>( size * size );
+  local_parent = std::vector<int>( size * size );
+  local_queue = std::vector<int>( size * size );
+
+  for( int cluster = 0; cluster < (int)clusters.size(); cluster++ ) {
+    /* every cluster starts out dirty */
+    dirty_clusters.push_back( cluster );
+  }
+  rebuild();
+  maze.addListener( this );
+}
+
+/*******************************************************************************
+% Destructor:  ~MazeHPA
+% File:        MazeHPA.cpp
+% Parameters:  None.
+% Description: Stops listening to the maze for wall changes.
+*******************************************************************************/
+MazeHPA::~MazeHPA() {
+  maze.removeListener( this );
+}
+
+/*******************************************************************************
+% Routine Name: rebuild
+% File:         MazeHPA.cpp
+% Parameters:   None.
+% Description:  Recomputes the entrances and intra-cluster edges of every
+%               cluster affected by wall changes since the last rebuild.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeHPA::rebuild() {
+  if( dirty_clusters.empty() ) return;
+  MAZE_TRACE_SCOPE( "MazeHPA::rebuild" );
+  unsigned long start_time = MazeHPAHelper::currentMicros();
+
+  /* entrances first - a cluster's nodes depend on its neighbors' borders */
+  for( int cluster : dirty_clusters ) {
+    if( clusters[ cluster ].right_dirty ) buildTransitions( cluster, true );
+    if( clusters[ cluster ].down_dirty ) buildTransitions( cluster, false );
+  }
+  for( int cluster : dirty_clusters ) {
+    buildCluster( cluster );
+    clusters[ cluster ].dirty = false;
+  }
+  dirty_clusters.clear();
+
+  /* renumber the abstract nodes */
+  node_offset.resize( clusters.size() + 1 );
+  node_offset[ 0 ] = 0;
+  for( size_t cluster = 0; cluster < clusters.size(); cluster++ ) {
+    node_offset[ cluster + 1 ] = node_offset[ cluster ] + clusters[ cluster ].nodes.size();
+  }
+
+  preprocess_time = MazeHPAHelper::currentMicros() - start_time;
+  total_preprocess_time += preprocess_time;
+}
+
+/*******************************************************************************
+% Routine Name: findPath
+% File:         MazeHPA.cpp
+% Parameters:   start - cell the path begins at.
+%               goal  - cell the path ends at.
+% Description:  Connects start and goal to the abstract graph of their
+%               clusters, runs A* over the abstract graph and refines every
+%               abstract edge into cells with cluster-local searches.
+% Return:       The cells of the path from start to goal inclusive, or an
+%               empty list if goal is unreachable.
+*******************************************************************************/
+std::vector<MazeCell *> MazeHPA::findPath( MazeCell * start, MazeCell * goal ) {
+  std::vector<MazeCell *> path;
+  if( start == nullptr || goal == nullptr ) return path;
+  MAZE_TRACE_SCOPE( "MazeHPA::findPath" );
+  rebuild();
+
+  const int width = maze.getWidth();
+  const int source = start->row * width + start->column;
+  const int target = goal->row * width + goal->column;
+  const int target_cluster = clusterOf( target );
+
+  /* connect start and goal to the nodes of their clusters */
+  localSearch( target );
+  std::vector<int> goal_distance( local_distance );
+  localSearch( source );
+  std::vector<int> start_distance( local_distance );
+
+  /* A* over the abstract graph - start and goal are the last two ids */
+  const int node_count = node_offset.back();
+  const int source_id = node_count;
+  const int target_id = node_count + 1;
+  if( (int)search_stamp.size() < node_count + 2 ) {
+    search_stamp.resize( node_count + 2, 0 );
+    search_cost.resize( node_count + 2 );
+    search_parent.resize( node_count + 2 );
+    search_cell.resize( node_count + 2 );
+  }
+  const unsigned stamp = ++search_generation;
+
+  /* entries are (estimate, (cost, id)) */
+  typedef std::pair<int, std::pair<int, int>> Entry;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+
+  auto relax = [&]( int from, int to, int cell, int to_cost ) {
+    if( search_stamp[ to ] == stamp && search_cost[ to ] <= to_cost ) return;
+    search_stamp[ to ] = stamp;
+    search_cost[ to ] = to_cost;
+    search_parent[ to ] = from;
+    search_cell[ to ] = cell;
+    int estimate = std::abs( cell / width - target / width ) +
+                   std::abs( cell % width - target % width );
+    open.push( Entry(to_cost + estimate, std::make_pair(to_cost, to)) );
+  };
+  relax( source_id, source_id, source, 0 );
+
+  while( !open.empty() ) {
+    int current_cost = open.top().second.first;
+    int current = open.top().second.second;
+    open.pop();
+    if( search_cost[ current ] < current_cost ) continue; /* stale entry */
+    MAZE_COUNT( HPA_EXPANSIONS );
+    if( current == target_id ) break;
+
+    int cell = search_cell[ current ];
+    int cluster = clusterOf( cell );
+    Cluster & owner = clusters[ cluster ];
+    const int count = owner.nodes.size();
+    if( current == source_id ) {
+      /* start reaches the nodes of its cluster */
+      for( int index = 0; index < count; index++ ) {
+        int distance = start_distance[ localIndex(owner.nodes[ index ].cell) ];
+        if( distance < 0 ) continue;
+        relax( current, node_offset[ cluster ] + index, owner.nodes[ index ].cell,
+               current_cost + distance );
+      }
+    }
+    else {
+      /* intra-cluster and inter-cluster abstract edges */
+      int index = current - node_offset[ cluster ];
+      for( int other = 0; other < count; other++ ) {
+        int edge_cost = owner.costs[ index * count + other ];
+        if( other == index || edge_cost == INFINITE_COST ) continue;
+        relax( current, node_offset[ cluster ] + other, owner.nodes[ other ].cell,
+               current_cost + edge_cost );
+      }
+      for( int link = 0; link < owner.nodes[ index ].partner_count; link++ ) {
+        int partner = owner.nodes[ index ].partners[ link ];
+        int partner_cluster = clusterOf( partner );
+        int partner_id = node_offset[ partner_cluster ] +
+                         findNode( partner_cluster, partner );
+        relax( current, partner_id, partner, current_cost + 1 );
+      }
+    }
+    if( cluster == target_cluster ) {
+      /* goal is reachable within its own cluster */
+      int distance = goal_distance[ localIndex(cell) ];
+      if( distance >= 0 ) relax( current, target_id, target, current_cost + distance );
+    }
+  }
+  if( search_stamp[ target_id ] != stamp ) return path;
+
+  /* walk back the abstract path */
+  std::vector<int> abstract_path;
+  for( int id = target_id; id != source_id; id = search_parent[ id ] ) {
+    abstract_path.push_back( search_cell[ id ] );
+  }
+  abstract_path.push_back( source );
+
+  /* refine every abstract edge into maze cells */
+  path.push_back( start );
+  for( int index = (int)abstract_path.size() - 1; index > 0; index-- ) {
+    int from = abstract_path[ index ];
+    int to = abstract_path[ index - 1 ];
+    if( clusterOf(from) != clusterOf(to) ) {
+      /* inter-cluster edge between two adjacent cells */
+      path.push_back( maze.at(to / width, to % width) );
+      continue;
+    }
+    localSearch( from );
+    std::vector<MazeCell *> segment;
+    const int cluster = clusterOf( from );
+    for( int local = localIndex( to ); local != localIndex( from );
+         local = local_parent[ local ] ) {
+      int cell = cellIndex( cluster, local );
+      segment.push_back( maze.at(cell / width, cell % width) );
+    }
+    path.insert( path.end(), segment.rbegin(), segment.rend() );
+  }
+  return path;
+}
+
+/*******************************************************************************
+% Routine Name: wallChanged
+% File:         MazeHPA.cpp
+% Parameters:   cell_A - a cell in the maze.
+%               cell_B - a cell in the maze.
+% Description:  Marks the clusters touching the changed wall for
+%               recomputation on the next query, along with every border
+%               either cell lies on - entrance runs depend on the walls along
+%               a border as well as on the walls across it.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeHPA::wallChanged( MazeCell * cell_A, MazeCell * cell_B ) {
+  const int width = maze.getWidth();
+  int row_distance = std::abs( cell_A->row - cell_B->row );
+  int column_distance = std::abs( cell_A->column - cell_B->column );
+  if( row_distance + column_distance != 1 ) return; /* not adjacent */
+
+  markBorders( cell_A->row, cell_A->column );
+  markBorders( cell_B->row, cell_B->column );
+  markDirty( clusterOf(cell_A->row * width + cell_A->column) );
+  markDirty( clusterOf(cell_B->row * width + cell_B->column) );
+}
+
+/*******************************************************************************
+% Routine Name: markBorders
+% File:         MazeHPA.cpp
+% Parameters:   row    - row of the cell.
+%               column - column of the cell.
+% Description:  Flags the right or bottom border of the owning cluster when
+%               the cell lies on one from either side, and marks both
+%               clusters of the border dirty.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeHPA::markBorders( int row, int column ) {
+  const int cluster = clusterOf( row * maze.getWidth() + column );
+  const int cluster_row = cluster / cluster_columns;
+  const int cluster_column = cluster % cluster_columns;
+
+  auto markRight = [&]( int owner ) {
+    clusters[ owner ].right_dirty = true;
+    markDirty( owner );
+    markDirty( owner + 1 );
+  };
+  auto markDown = [&]( int owner ) {
+    clusters[ owner ].down_dirty = true;
+    markDirty( owner );
+    markDirty( owner + cluster_columns );
+  };
+  /* borders of this cluster, then those owned by the clusters left and above
+     - a cell of a 1x1 cluster lies on all four */
+  if( column % cluster_size == cluster_size - 1 &&
+      cluster_column < cluster_columns - 1 ) {
+    markRight( cluster );
+  }
+  if( row % cluster_size == cluster_size - 1 && cluster_row < cluster_rows - 1 ) {
+    markDown( cluster );
+  }
+  if( column % cluster_size == 0 && cluster_column > 0 ) markRight( cluster - 1 );
+  if( row % cluster_size == 0 && cluster_row > 0 ) markDown( cluster - cluster_columns );
+}
+
+/*******************************************************************************
+% Routine Name: markDirty
+% File:         MazeHPA.cpp
+% Parameters:   cluster - index of the cluster.
+% Description:  Flags a cluster to have its abstract edges recomputed.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeHPA::markDirty( int cluster ) {
+  if( clusters[ cluster ].dirty ) return;
+  clusters[ cluster ].dirty = true;
+  dirty_clusters.push_back( cluster );
+}
+
+/*******************************************************************************
+% Routine Name: buildTransitions
+% File:         MazeHPA.cpp
+% Parameters:   cluster      - index of the cluster.
+%               right_border - true for the right border, false for bottom.
+% Description:  Scans a border for maximal runs of open edges whose cells
+%               are also connected along the border on both sides. Short
+%               runs get one transition in their middle, wide runs get one
+%               transition at each end.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeHPA::buildTransitions( int cluster, bool right_border ) {
+  Cluster & owner = clusters[ cluster ];
+  std::vector<Transition> & transitions =
+    right_border ? owner.right_transitions : owner.down_transitions;
+  transitions.clear();
+  if( right_border ) owner.right_dirty = false;
+  else owner.down_dirty = false;
+
+  const int width = maze.getWidth();
+  const int height = maze.getHeight();
+  const int cluster_row = cluster / cluster_columns;
+  const int cluster_column = cluster % cluster_columns;
+  if( right_border && cluster_column == cluster_columns - 1 ) return;
+  if( !right_border && cluster_row == cluster_rows - 1 ) return;
+
+  int first_row = cluster_row * cluster_size;
+  int first_column = cluster_column * cluster_size;
+  int last_row = std::min( first_row + cluster_size, height ) - 1;
+  int last_column = std::min( first_column + cluster_size, width ) - 1;
+  /* the border is walked along its length - step moves to the next cell */
+  int begin = right_border ? first_row : first_column;
+  int end = right_border ? last_row : last_column;
+
+  auto addRun = [&]( int run_start, int run_end ) {
+    int picks[ 2 ] = { (run_start + run_end) / 2, -1 };
+    if( run_end - run_start + 1 >= MAX_ENTRANCE_WIDTH ) {
+      picks[ 0 ] = run_start;
+      picks[ 1 ] = run_end;
+    }
+    for( int pick : picks ) {
+      if( pick < 0 ) continue;
+      Transition transition;
+      if( right_border ) {
+        transition.inside = pick * width + last_column;
+        transition.outside = transition.inside + 1;
+      }
+      else {
+        transition.inside = last_row * width + pick;
+        transition.outside = transition.inside + width;
+      }
+      transitions.push_back( transition );
+    }
+  };
+
+  int run_start = -1;
+  MazeCell * previous = nullptr;
+  for( int position = begin; position <= end; position++ ) {
+    MazeCell * cell = right_border ? maze.at( position, last_column )
+                                   : maze.at( last_row, position );
+    MazeCell * across = right_border ? cell->right : cell->down;
+    /* a run continues only while both sides stay connected along the border */
+    bool joined = previous != nullptr && across != nullptr &&
+      ( right_border ? previous->down == cell : previous->right == cell ) &&
+      ( right_border ? (previous->right)->down == across
+                     : (previous->down)->right == across );
+
+    if( run_start >= 0 && !joined ) {
+      addRun( run_start, position - 1 );
+      run_start = -1;
+    }
+    if( across != nullptr && run_start < 0 ) run_start = position;
+    previous = ( across != nullptr ) ? cell : nullptr;
+  }
+  if( run_start >= 0 ) addRun( run_start, end );
+}
+
+/*******************************************************************************
+% Routine Name: buildCluster
+% File:         MazeHPA.cpp
+% Parameters:   cluster - index of the cluster.
+% Description:  Gathers the abstract nodes from the four borders of a cluster
+%               and computes the intra-cluster distance between every pair.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeHPA::buildCluster( int cluster ) {
+  Cluster & owner = clusters[ cluster ];
+  const int cluster_row = cluster / cluster_columns;
+  const int cluster_column = cluster % cluster_columns;
+  owner.nodes.clear();
+
+  auto attach = [&]( int cell, int partner ) {
+    for( Node & node : owner.nodes ) {
+      if( node.cell == cell ) {
+        node.partners[ node.partner_count++ ] = partner;
+        return;
+      }
+    }
+    Node node;
+    node.cell = cell;
+    node.partners[ 0 ] = partner;
+    node.partner_count = 1;
+    owner.nodes.push_back( node );
+  };
+
+  /* own right and bottom borders, then the borders owned by neighbors */
+  for( Transition & entrance : owner.right_transitions ) {
+    attach( entrance.inside, entrance.outside );
+  }
+  for( Transition & entrance : owner.down_transitions ) {
+    attach( entrance.inside, entrance.outside );
+  }
+  if( cluster_column > 0 ) {
+    for( Transition & entrance : clusters[ cluster - 1 ].right_transitions ) {
+      attach( entrance.outside, entrance.inside );
+    }
+  }
+  if( cluster_row > 0 ) {
+    for( Transition & entrance :
+         clusters[ cluster - cluster_columns ].down_transitions ) {
+      attach( entrance.outside, entrance.inside );
+    }
+  }
+
+  const int count = owner.nodes.size();
+  owner.costs.assign( count * count, INFINITE_COST );
+  for( int from = 0; from < count; from++ ) {
+    localSearch( owner.nodes[ from ].cell );
+    for( int to = 0; to < count; to++ ) {
+      int distance = local_distance[ localIndex(owner.nodes[ to ].cell) ];
+      if( distance >= 0 ) owner.costs[ from * count + to ] = distance;
+    }
+  }
+}
+
+/*******************************************************************************
+% Routine Name: localSearch
+% File:         MazeHPA.cpp
+% Parameters:   cell - index of the cell the search begins at.
+% Description:  Breadth first search from cell that never leaves its cluster.
+%               Results are left in local_distance (-1 if unreachable) and
+%               local_parent, indexed by local cell index.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeHPA::localSearch( int cell ) {
+  const int width = maze.getWidth();
+  const int height = maze.getHeight();
+  const int cluster = clusterOf( cell );
+  const int first_row = ( cluster / cluster_columns ) * cluster_size;
+  const int first_column = ( cluster % cluster_columns ) * cluster_size;
+  const int last_row = std::min( first_row + cluster_size, height ) - 1;
+  const int last_column = std::min( first_column + cluster_size, width ) - 1;
+
+  std::fill( local_distance.begin(), local_distance.end(), -1 );
+  int head = 0;
+  int tail = 0;
+  int origin = localIndex( cell );
+  local_distance[ origin ] = 0;
+  local_parent[ origin ] = origin;
+  local_queue[ tail++ ] = origin;
+
+  while( head < tail ) {
+    int current = local_queue[ head++ ];
+    MAZE_COUNT( HPA_EXPANSIONS );
+    MazeCell * mazeCell = maze.at( first_row + current / cluster_size,
+                                   first_column + current % cluster_size );
+    MazeCell * neighbors[ 4 ] = { mazeCell->up, mazeCell->right,
+                                  mazeCell->down, mazeCell->left };
+    for( MazeCell * neighbor : neighbors ) {
+      if( neighbor == nullptr ) continue;
+      if( neighbor->row < first_row || neighbor->row > last_row ) continue;
+      if( neighbor->column < first_column || neighbor->column > last_column ) {
+        continue;
+      }
+      int local = ( neighbor->row - first_row ) * cluster_size +
+                  ( neighbor->column - first_column );
+      if( local_distance[ local ] >= 0 ) continue;
+      local_distance[ local ] = local_distance[ current ] + 1;
+      local_parent[ local ] = current;
+      local_queue[ tail++ ] = local;
+    }
+  }
+}
+
+/*******************************************************************************
+% Routine Name: clusterOf
+% File:         MazeHPA.cpp
+% Parameters:   cell - index of a cell in the maze.
+% Description:  Computes the cluster a cell belongs to.
+% Return:       Index of the cluster.
+*******************************************************************************/
+int MazeHPA::clusterOf( int cell ) {
+  const int width = maze.getWidth();
+  return ( cell / width / cluster_size ) * cluster_columns +
+         ( cell % width / cluster_size );
+}
+
+/*******************************************************************************
+% Routine Name: localIndex
+% File:         MazeHPA.cpp
+% Parameters:   cell - index of a cell in the maze.
+% Description:  Computes the index of a cell within its cluster.
+% Return:       Local index in [0, cluster_size^2).
+*******************************************************************************/
+int MazeHPA::localIndex( int cell ) {
+  const int width = maze.getWidth();
+  return ( cell / width % cluster_size ) * cluster_size +
+         ( cell % width % cluster_size );
+}
+
+/*******************************************************************************
+% Routine Name: cellIndex
+% File:         MazeHPA.cpp
+% Parameters:   cluster - index of a cluster.
+%               local   - local index of a cell within the cluster.
+% Description:  Inverse of localIndex.
+% Return:       Index of the cell in the maze.
+*******************************************************************************/
+int MazeHPA::cellIndex( int cluster, int local ) {
+  int row = ( cluster / cluster_columns ) * cluster_size + local / cluster_size;
+  int column = ( cluster % cluster_columns ) * cluster_size + local % cluster_size;
+  return row * maze.getWidth() + column;
+}
+
+/*******************************************************************************
+% Routine Name: findNode
+% File:         MazeHPA.cpp
+% Parameters:   cluster - index of a cluster.
+%               cell    - index of a cell in the cluster.
+% Description:  Looks up the abstract node of a cell.
+% Return:       Index of the node in the cluster, -1 if cell is not a node.
+*******************************************************************************/
+int MazeHPA::findNode( int cluster, int cell ) {
+  std::vector<Node> & nodes = clusters[ cluster ].nodes;
+  for( int index = 0; index < (int)nodes.size(); index++ ) {
+    if( nodes[ index ].cell == cell ) return index;
+  }
+  return -1;
+}
+
+/*******************************************************************************
+% Routine Name: getClusterSize
+% File:         MazeHPA.cpp
+% Parameters:   None.
+% Description:  Getter method for the cluster size, in unit cells.
+% Return:       The width and height of a cluster.
+*******************************************************************************/
+int MazeHPA::getClusterSize() {
+  return cluster_size;
+}
+
+/*******************************************************************************
+% Routine Name: getNodeCount
+% File:         MazeHPA.cpp
+% Parameters:   None.
+% Description:  Getter method for the number of abstract graph nodes.
+% Return:       The number of entrance cells over all clusters.
+*******************************************************************************/
+int MazeHPA::getNodeCount() {
+  rebuild();
+  return node_offset.back();
+}
+
+/*******************************************************************************
+% Routine Name: getPreprocessTime
+% File:         MazeHPA.cpp
+% Parameters:   None.
+% Description:  Getter method for the time spent in the last rebuild.
+% Return:       Microseconds of the last full or incremental rebuild.
+*******************************************************************************/
+unsigned long MazeHPA::getPreprocessTime() {
+  return preprocess_time;
+}
+
+/*******************************************************************************
+% Routine Name: getTotalPreprocessTime
+% File:         MazeHPA.cpp
+% Parameters:   None.
+% Description:  Getter method for the time spent in all rebuilds.
+% Return:       Microseconds of every rebuild since construction.
+*******************************************************************************/
+unsigned long MazeHPA::getTotalPreprocessTime() {
+  return total_preprocess_time;
+}
+
+/*******************************************************************************
+% Routine Name: getMemoryUsage
+% File:         MazeHPA.cpp
+% Parameters:   None.
+% Description:  Sums the heap memory held by the abstract graph.
+% Return:       Approximate size in bytes.
+*******************************************************************************/
+size_t MazeHPA::getMemoryUsage() {
+  size_t bytes = clusters.capacity() * sizeof( Cluster );
+  for( Cluster & cluster : clusters ) {
+    bytes += cluster.nodes.capacity() * sizeof( Node );
+    bytes += cluster.costs.capacity() * sizeof( int );
+    bytes += cluster.right_transitions.capacity() * sizeof( Transition );
+    bytes += cluster.down_transitions.capacity() * sizeof( Transition );
+  }
+  bytes += ( dirty_clusters.capacity() + node_offset.capacity() ) * sizeof( int );
+  bytes += search_stamp.capacity() * sizeof( unsigned );
+  bytes += ( search_cost.capacity() + search_parent.capacity() +
+             search_cell.capacity() ) * sizeof( int );
+  bytes += ( local_distance.capacity() + local_parent.capacity() +
+             local_queue.capacity() ) * sizeof( int );
+  return bytes;
+}
+
+/*******************************************************************************
+% Routine Name: currentMicros
+% File:         MazeHPA.cpp
+% Parameters:   None.
+% Description:  Reads a monotonic microsecond clock.
+% Return:       Microseconds since an arbitrary epoch.
+*******************************************************************************/
+unsigned long MazeHPAHelper::currentMicros() {
+  #if defined( ARDUINO )
+    return micros();
+  #else
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now().time_since_epoch() ).count();
+  #endif
+}
@@ -0,0 +1,117 @@
+/*******************************************************************************
+                                                    Jose Jorge Jimenez-Olivas
+                                                    Brandon Cramer
+
+                 University of California, San Diego
+                           IEEE Micromouse
+
+File Name:       MazeHPA.h
+Description:     Hierarchical path-finding (HPA*) abstraction over the maze.
+                 The maze is split into square clusters whose entrances form a
+                 small abstract graph that answers path queries quickly.
+*******************************************************************************/
+#ifndef MAZE_HPA_H
+#define MAZE_HPA_H
+
+#include "Maze.h"
+#include <queue>
+#include <unordered_map>
+#include <functional>
+
+class MazeHPA : public MazeListener {
+private:
+  /* abstract graph vertex - a cell on a cluster border with an entrance */
+  struct Node {
+    int cell;
+    /* one per side - a 1x1 cluster can have an entrance on all four */
+    int partners[ 4 ];
+    int partner_count;
+  };
+  /* entrance pair crossing a cluster border - (inside, outside) cells */
+  struct Transition {
+    int inside;
+    int outside;
+  };
+  struct Cluster {
+    std::vector<Node> nodes;
+    /* intra-cluster shortest distances between every pair of nodes */
+    std::vector<int> costs;
+    /* entrances on the right and bottom borders of this cluster */
+    std::vector<Transition> right_transitions;
+    std::vector<Transition> down_transitions;
+    bool dirty = true;
+    bool right_dirty = true;
+    bool down_dirty = true;
+  };
+
+  Maze & maze;
+  const int cluster_size;
+  int cluster_rows, cluster_columns;
+  std::vector<Cluster> clusters;
+  std::vector<int> dirty_clusters;
+  /* abstract node ids - the nodes of a cluster start at its offset */
+  std::vector<int> node_offset;
+  /* abstract search state - entries are valid when stamped by this query */
+  std::vector<unsigned> search_stamp;
+  std::vector<int> search_cost;
+  std::vector<int> search_parent;
+  std::vector<int> search_cell;
+  unsigned search_generation = 0;
+  /* scratch buffers for cluster-local breadth first searches */
+  std::vector<int> local_distance;
+  std::vector<int> local_parent;
+  std::vector<int> local_queue;
+  unsigned long preprocess_time = 0;
+  unsigned long total_preprocess_time = 0;
+
+  /* flags a cluster to have its abstract edges recomputed */
+  void markDirty( int cluster );
+  /* flags the borders a cell lies on to have their entrances recomputed */
+  void markBorders( int row, int column );
+  /* recomputes the entrances on the right or bottom border of a cluster */
+  void buildTransitions( int cluster, bool right_border );
+  /* recomputes the abstract nodes and intra-cluster edges of a cluster */
+  void buildCluster( int cluster );
+  /* breadth first search from a cell restricted to its cluster */
+  void localSearch( int cell );
+  /* cluster index that a cell belongs to */
+  int clusterOf( int cell );
+  /* local index of a cell within its cluster */
+  int localIndex( int cell );
+  /* cell index from a local index within a cluster */
+  int cellIndex( int cluster, int local );
+  /* finds the abstract node of a cell in a cluster, -1 if absent */
+  int findNode( int cluster, int cell );
+
+public:
+  static const int DEFAULT_CLUSTER_SIZE = 16;
+  static const int MAX_ENTRANCE_WIDTH = 6;
+  static const int INFINITE_COST = INT_MAX;
+
+  /* Builds the abstract graph over the given maze. */
+  MazeHPA( Maze & maze, int cluster_size = DEFAULT_CLUSTER_SIZE );
+  /* Detaches from the maze. */
+  ~MazeHPA();
+  /* Recomputes every cluster affected by wall changes since the last build. */
+  void rebuild();
+  /* Finds a path between two cells through the abstract graph. */
+  std::vector<MazeCell *> findPath( MazeCell * start, MazeCell * goal );
+  /* Marks the clusters touching the changed wall for recomputation. */
+  void wallChanged( MazeCell * cell_A, MazeCell * cell_B ) override;
+  /* Getter method for the cluster size, in unit cells. */
+  int getClusterSize();
+  /* Getter method for the number of abstract graph nodes. */
+  int getNodeCount();
+  /* Getter method for the microseconds spent in the last rebuild. */
+  unsigned long getPreprocessTime();
+  /* Getter method for the microseconds spent in all rebuilds. */
+  unsigned long getTotalPreprocessTime();
+  /* Approximate heap memory, in bytes, held by the abstract graph. */
+  size_t getMemoryUsage();
+};
+
+#ifndef ARDUINO
+  #include "MazeHPA.cpp"
+#endif
+
+#endif /* MAZE_HPA_H */
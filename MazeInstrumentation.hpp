@@ -0,0 +1,457 @@
+/*******************************************************************************
+                                                    Jose Jorge Jimenez-Olivas
+                                                    Brandon Cramer
+
+                 University of California, San Diego
+                           IEEE Micromouse
+
+File Name:       MazeInstrumentation.hpp
+Description:     Compile-time switchable event counters and scoped timers of
+                 the maze library. Define MAZE_INSTRUMENTATION to count calls
+                 to at(), edge mutations, neighbor queries, allocations, nodes
+                 expanded by each solver and bytes serialized, and define
+                 MAZE_TRACING to record timed scopes as a Chrome trace. With
+                 neither defined every macro expands to nothing.
+*******************************************************************************/
+#ifndef MAZE_INSTRUMENTATION_HPP
+#define MAZE_INSTRUMENTATION_HPP
+
+#if defined( MAZE_INSTRUMENTATION ) || defined( MAZE_TRACING )
+
+#if defined( ARDUINO_ARCH_STM32 )
+  #include <Arduino.h>
+#endif
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include <iostream>
+
+#if !defined( ARDUINO )
+  #include <mutex>
+  #include <chrono>
+  #include <fstream>
+#endif
+
+class MazeInstrumentation {
+public:
+  enum Counter {
+    AT_CALLS,
+    EDGE_ADDS,
+    EDGE_REMOVES,
+    NEIGHBOR_QUERIES,
+    ALLOCATIONS,
+    FLOOD_FILL_EXPANSIONS,
+    GOAL_TABLE_EXPANSIONS,
+    HPA_EXPANSIONS,
+    JUNCTION_GRAPH_EXPANSIONS,
+    PLANNER_EXPANSIONS,
+    BYTES_READ,
+    BYTES_WRITTEN,
+    COUNTER_COUNT
+  };
+
+  /* one timed scope - start and duration in clock ticks */
+  struct TraceEvent {
+    const char * name;
+    uint64_t start;
+    uint64_t duration;
+    int thread;
+  };
+
+private:
+  #if !defined( ARDUINO )
+    typedef std::mutex Lock;
+  #else
+    /* boards run the library on a single thread */
+    struct Lock {
+      void lock() {}
+      void unlock() {}
+    };
+  #endif
+
+  /* holds a lock for the enclosing scope */
+  class Guard {
+  private:
+    Lock & held;
+  public:
+    explicit Guard( Lock & lock ) : held( lock ) { held.lock(); }
+    ~Guard() { held.unlock(); }
+  };
+
+  /* counters and trace events of one thread, alone on its own cache lines so
+     that no two threads ever write to the same line */
+  struct alignas( 64 ) ThreadRecord {
+    /* written by the owning thread only - relaxed load and store, no locked
+       read-modify-write */
+    std::atomic<uint64_t> counts[ COUNTER_COUNT ];
+    std::vector<TraceEvent> events;
+    /* guards events against a concurrent writeTrace */
+    Lock events_lock;
+    int thread;
+
+    ThreadRecord() : thread( 0 ) {
+      for( int index = 0; index < COUNTER_COUNT; index++ ) {
+        counts[ index ].store( 0, std::memory_order_relaxed );
+      }
+    }
+  };
+
+  /* every live thread record plus the totals of threads that exited */
+  struct Registry {
+    Lock lock;
+    std::vector<ThreadRecord *> live;
+    uint64_t retired[ COUNTER_COUNT ] = {};
+    std::vector<TraceEvent> retired_events;
+    int next_thread = 1;
+  };
+
+  /*****************************************************************************
+  % Routine Name: registry
+  % File:         MazeInstrumentation.hpp
+  % Parameters:   None.
+  % Description:  Process wide registry of the thread records.
+  % Return:       Reference to the registry.
+  *****************************************************************************/
+  static Registry & registry() {
+    static Registry instance;
+    return instance;
+  }
+
+  #if !defined( ARDUINO )
+    /* registers the record of a thread on its first event and folds it into
+       the retired totals when the thread exits */
+    struct ThreadHandle {
+      ThreadRecord record;
+
+      ThreadHandle() {
+        Registry & shared = registry();
+        Guard guard( shared.lock );
+        record.thread = shared.next_thread++;
+        shared.live.push_back( &record );
+      }
+
+      ~ThreadHandle() {
+        Registry & shared = registry();
+        Guard guard( shared.lock );
+        for( int index = 0; index < COUNTER_COUNT; index++ ) {
+          shared.retired[ index ] +=
+            record.counts[ index ].load( std::memory_order_relaxed );
+        }
+        Guard events_guard( record.events_lock );
+        shared.retired_events.insert( shared.retired_events.end(),
+          record.events.begin(), record.events.end() );
+        for( size_t index = 0; index < shared.live.size(); index++ ) {
+          if( shared.live[ index ] == &record ) {
+            shared.live.erase( shared.live.begin() + index );
+            break;
+          }
+        }
+      }
+    };
+  #endif
+
+  /*****************************************************************************
+  % Routine Name: local
+  % File:         MazeInstrumentation.hpp
+  % Parameters:   None.
+  % Description:  Record of the calling thread.
+  % Return:       Reference to the thread record.
+  *****************************************************************************/
+  static ThreadRecord & local() {
+    #if !defined( ARDUINO )
+      static thread_local ThreadHandle handle;
+      return handle.record;
+    #else
+      static ThreadRecord record;
+      static bool registered = false;
+      if( !registered ) {
+        record.thread = 1;
+        registry().live.push_back( &record );
+        registered = true;
+      }
+      return record;
+    #endif
+  }
+
+  /*****************************************************************************
+  % Routine Name: writeEvent
+  % File:         MazeInstrumentation.hpp
+  % Parameters:   out   - stream to write the event to.
+  %               event - timed scope to write.
+  % Description:  Writes a timed scope as a complete ("X") Chrome trace event
+  %               with timestamps in microseconds.
+  % Return:       Nothing.
+  *****************************************************************************/
+  static void writeEvent( std::ostream & out, const TraceEvent & event ) {
+    out << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"ts\":"
+        << toMicros( event.start ) << ",\"dur\":" << toMicros( event.duration )
+        << ",\"pid\":1,\"tid\":" << event.thread << "}";
+  }
+
+public:
+  /*****************************************************************************
+  % Routine Name: add
+  % File:         MazeInstrumentation.hpp
+  % Parameters:   counter - counter to advance.
+  %               amount  - number of events to count.
+  % Description:  Advances a counter of the calling thread.
+  % Return:       Nothing.
+  *****************************************************************************/
+  static inline void add( Counter counter, uint64_t amount ) {
+    std::atomic<uint64_t> & count = local().counts[ counter ];
+    count.store( count.load( std::memory_order_relaxed ) + amount,
+      std::memory_order_relaxed );
+  }
+
+  /*****************************************************************************
+  % Routine Name: total
+  % File:         MazeInstrumentation.hpp
+  % Parameters:   counter - counter to sum.
+  % Description:  Sums a counter over every thread, live or exited.
+  % Return:       Number of events counted.
+  *****************************************************************************/
+  static uint64_t total( Counter counter ) {
+    Registry & shared = registry();
+    Guard guard( shared.lock );
+    uint64_t sum = shared.retired[ counter ];
+    for( ThreadRecord * record : shared.live ) {
+      sum += record->counts[ counter ].load( std::memory_order_relaxed );
+    }
+    return sum;
+  }
+
+  /*****************************************************************************
+  % Routine Name: reset
+  % File:         MazeInstrumentation.hpp
+  % Parameters:   None.
+  % Description:  Zeroes every counter and drops every trace event. Counts
+  %               made by other threads while resetting may be lost.
+  % Return:       Nothing.
+  *****************************************************************************/
+  static void reset() {
+    Registry & shared = registry();
+    Guard guard( shared.lock );
+    for( int index = 0; index < COUNTER_COUNT; index++ ) {
+      shared.retired[ index ] = 0;
+    }
+    shared.retired_events.clear();
+    for( ThreadRecord * record : shared.live ) {
+      for( int index = 0; index < COUNTER_COUNT; index++ ) {
+        record->counts[ index ].store( 0, std::memory_order_relaxed );
+      }
+      Guard events_guard( record->events_lock );
+      record->events.clear();
+    }
+  }
+
+  /*****************************************************************************
+  % Routine Name: counterName
+  % File:         MazeInstrumentation.hpp
+  % Parameters:   counter - counter to name.
+  % Description:  Printable name of a counter.
+  % Return:       Name of the counter.
+  *****************************************************************************/
+  static const char * counterName( Counter counter ) {
+    static const char * const names[ COUNTER_COUNT ] = {
+      "at_calls", "edge_adds", "edge_removes", "neighbor_queries",
+      "allocations", "flood_fill_expansions", "goal_table_expansions",
+      "hpa_expansions", "junction_graph_expansions", "planner_expansions",
+      "bytes_read", "bytes_written"
+    };
+    return ( counter >= 0 && counter < COUNTER_COUNT ) ? names[ counter ] : "";
+  }
+
+  /*****************************************************************************
+  % Routine Name: report
+  % File:         MazeInstrumentation.hpp
+  % Parameters:   out - stream to write the counters to.
+  % Description:  Writes one "name value" line per counter.
+  % Return:       Nothing.
+  *****************************************************************************/
+  static void report( std::ostream & out ) {
+    for( int index = 0; index < COUNTER_COUNT; index++ ) {
+      out << counterName( (Counter)index ) << " "
+          << total( (Counter)index ) << "\n";
+    }
+  }
+
+  /*****************************************************************************
+  % Routine Name: now
+  % File:         MazeInstrumentation.hpp
+  % Parameters:   None.
+  % Description:  Reads the trace clock - nanoseconds of the steady clock on
+  %               desktop, the DWT cycle counter extended to 64 bits on STM32
+  %               and micros() on other boards.
+  % Return:       Current clock ticks.
+  *****************************************************************************/
+  static inline uint64_t now() {
+    #if !defined( ARDUINO )
+      return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch() ).count();
+    #elif defined( ARDUINO_ARCH_STM32 )
+      static bool started = false;
+      static uint32_t last = 0;
+      static uint64_t high = 0;
+      if( !started ) {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CYCCNT = 0;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+        started = true;
+      }
+      uint32_t cycles = DWT->CYCCNT;
+      /* the counter wraps every few seconds */
+      if( cycles < last ) high += (uint64_t)1 << 32;
+      last = cycles;
+      return high | cycles;
+    #else
+      return micros();
+    #endif
+  }
+
+  /*****************************************************************************
+  % Routine Name: toMicros
+  % File:         MazeInstrumentation.hpp
+  % Parameters:   ticks - clock ticks returned by now().
+  % Description:  Converts clock ticks to microseconds.
+  % Return:       Microseconds.
+  *****************************************************************************/
+  static double toMicros( uint64_t ticks ) {
+    #if !defined( ARDUINO )
+      return ticks / 1000.0;
+    #elif defined( ARDUINO_ARCH_STM32 )
+      return ticks / ( SystemCoreClock / 1000000.0 );
+    #else
+      return (double)ticks;
+    #endif
+  }
+
+  /*****************************************************************************
+  % Routine Name: record
+  % File:         MazeInstrumentation.hpp
+  % Parameters:   name     - static name of the scope.
+  %               start    - clock ticks at the start of the scope.
+  %               duration - clock ticks the scope took.
+  % Description:  Appends a timed scope to the calling thread's trace.
+  % Return:       Nothing.
+  *****************************************************************************/
+  static void record( const char * name, uint64_t start, uint64_t duration ) {
+    ThreadRecord & current = local();
+    Guard guard( current.events_lock );
+    current.events.push_back( { name, start, duration, current.thread } );
+  }
+
+  /*****************************************************************************
+  % Routine Name: writeTrace
+  % File:         MazeInstrumentation.hpp
+  % Parameters:   out - stream to write the trace to.
+  % Description:  Writes every recorded scope, followed by the counter totals
+  %               when counting is compiled in, as Chrome trace JSON for
+  %               chrome://tracing or Perfetto.
+  % Return:       True if the stream is still good.
+  *****************************************************************************/
+  static bool writeTrace( std::ostream & out ) {
+    Registry & shared = registry();
+    Guard guard( shared.lock );
+    const char * separator = "";
+    uint64_t last = 0;
+    /* fixed point microseconds keep nanosecond timestamps exact */
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision( 3 );
+    out.setf( std::ios::fixed, std::ios::floatfield );
+
+    out << "{\"traceEvents\":[";
+    for( const TraceEvent & event : shared.retired_events ) {
+      out << separator << "\n";
+      writeEvent( out, event );
+      separator = ",";
+      if( event.start + event.duration > last ) last = event.start + event.duration;
+    }
+    for( ThreadRecord * current : shared.live ) {
+      Guard events_guard( current->events_lock );
+      for( const TraceEvent & event : current->events ) {
+        out << separator << "\n";
+        writeEvent( out, event );
+        separator = ",";
+        if( event.start + event.duration > last ) last = event.start + event.duration;
+      }
+    }
+
+    #if defined( MAZE_INSTRUMENTATION )
+      /* counter totals as one counter ("C") event at the end of the trace */
+      out << separator << "\n{\"name\":\"maze counters\",\"ph\":\"C\",\"ts\":"
+          << toMicros( last ) << ",\"pid\":1,\"tid\":0,\"args\":{";
+      for( int index = 0; index < COUNTER_COUNT; index++ ) {
+        uint64_t sum = shared.retired[ index ];
+        for( ThreadRecord * current : shared.live ) {
+          sum += current->counts[ index ].load( std::memory_order_relaxed );
+        }
+        out << ( index ? "," : "" ) << "\"" << counterName( (Counter)index )
+            << "\":" << sum;
+      }
+      out << "}}";
+    #endif
+
+    out << "\n]}\n";
+    out.flags( flags );
+    out.precision( precision );
+    return (bool)out;
+  }
+
+  #if !defined( ARDUINO )
+    /***************************************************************************
+    % Routine Name: writeTrace
+    % File:         MazeInstrumentation.hpp
+    % Parameters:   filename - file to write the trace to.
+    % Description:  Writes the Chrome trace JSON to a file.
+    % Return:       True if the whole trace was written.
+    ***************************************************************************/
+    static bool writeTrace( const char * filename ) {
+      std::ofstream out( filename );
+      return out && writeTrace( out );
+    }
+  #endif
+};
+
+/* times the enclosing scope into the calling thread's trace */
+class MazeTraceScope {
+private:
+  const char * name;
+  uint64_t start;
+
+public:
+  explicit MazeTraceScope( const char * name ) : name( name ),
+    start( MazeInstrumentation::now() ) {}
+
+  ~MazeTraceScope() {
+    MazeInstrumentation::record( name, start, MazeInstrumentation::now() - start );
+  }
+
+  MazeTraceScope( const MazeTraceScope & ) = delete;
+  MazeTraceScope & operator=( const MazeTraceScope & ) = delete;
+};
+
+#endif /* MAZE_INSTRUMENTATION || MAZE_TRACING */
+
+/* counting macros - the amount is not evaluated when compiled out */
+#if defined( MAZE_INSTRUMENTATION )
+  #define MAZE_COUNT( counter ) \
+    MazeInstrumentation::add( MazeInstrumentation::counter, 1 )
+  #define MAZE_COUNT_ADD( counter, amount ) \
+    MazeInstrumentation::add( MazeInstrumentation::counter, (uint64_t)(amount) )
+#else
+  #define MAZE_COUNT( counter ) ( (void)0 )
+  #define MAZE_COUNT_ADD( counter, amount ) ( (void)0 )
+#endif
+
+/* tracing macro - name must be a string literal or otherwise outlive the trace */
+#if defined( MAZE_TRACING )
+  #define MAZE_TRACE_CONCAT_INNER( a, b ) a##b
+  #define MAZE_TRACE_CONCAT( a, b ) MAZE_TRACE_CONCAT_INNER( a, b )
+  #define MAZE_TRACE_SCOPE( name ) \
+    MazeTraceScope MAZE_TRACE_CONCAT( maze_trace_scope_, __LINE__ )( name )
+#else
+  #define MAZE_TRACE_SCOPE( name ) ( (void)0 )
+#endif
+
+#endif /* MAZE_INSTRUMENTATION_HPP */
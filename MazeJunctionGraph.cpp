@@ -0,0 +1,441 @@
+/*******************************************************************************
+                                                    Jose Jorge Jimenez-Olivas
+                                                    Brandon Cramer
+
+                 University of California, San Diego
+                           IEEE Micromouse
+
+File Name:       MazeJunctionGraph.cpp
+Description:     Dead-end filling and corridor compression of the maze into a
+                 weighted graph of junctions for fast repeated path queries.
+*******************************************************************************/
+#include "MazeJunctionGraph.h"
+
+/*******************************************************************************
+% Constructor: MazeJunctionGraph
+% File:        MazeJunctionGraph.cpp
+% Parameters:  maze    - maze to preprocess.
+%              protect - cells never filled, such as the start and goals.
+% Description: Runs the preprocessing pass and listens to the maze for wall
+%              changes.
+*******************************************************************************/
+MazeJunctionGraph::MazeJunctionGraph( Maze & maze,
+  const std::vector<MazeCell *> & protect ) : maze( maze ) {
+
+  for( MazeCell * cell : protect ) {
+    if( cell == nullptr ) continue;
+    protected_cells.push_back( cell->row * maze.getWidth() + cell->column );
+  }
+  rebuild();
+  maze.addListener( this );
+}
+
+/*******************************************************************************
+% Destructor:  ~MazeJunctionGraph
+% File:        MazeJunctionGraph.cpp
+% Parameters:  None.
+% Description: Stops listening to the maze for wall changes.
+*******************************************************************************/
+MazeJunctionGraph::~MazeJunctionGraph() {
+  maze.removeListener( this );
+}
+
+/*******************************************************************************
+% Routine Name: rebuild
+% File:         MazeJunctionGraph.cpp
+% Parameters:   None.
+% Description:  Recomputes the dead-end filling and corridor compression if
+%               the maze changed since the last pass. Both run in time linear
+%               in the number of cells.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeJunctionGraph::rebuild() {
+  if( !stale ) return;
+  MAZE_TRACE_SCOPE( "MazeJunctionGraph::rebuild" );
+  const int cells = maze.getWidth() * maze.getHeight();
+  filled.assign( cells, false );
+  degree.assign( cells, 0 );
+  parent.assign( cells, -1 );
+  depth.assign( cells, 0 );
+  anchor.assign( cells, -1 );
+  junction_of.assign( cells, -1 );
+  corridor_of.assign( cells, -1 );
+  offset.assign( cells, 0 );
+  junction_cells.clear();
+  corridors.clear();
+  edges.clear();
+
+  fillDeadEnds();
+  compressCorridors();
+  search_stamp.assign( junction_cells.size(), 0 );
+  search_cost.assign( junction_cells.size(), 0 );
+  stale = false;
+}
+
+/*******************************************************************************
+% Routine Name: fillDeadEnds
+% File:         MazeJunctionGraph.cpp
+% Parameters:   None.
+% Description:  Repeatedly fills unprotected cells with a single open side.
+%               Every filled cell remembers the neighbor it hung off of, so
+%               the filled cells form trees anchored at a core cell.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeJunctionGraph::fillDeadEnds() {
+  const int cells = degree.size();
+  std::vector<bool> locked( cells, false );
+  for( int cell : protected_cells ) locked[ cell ] = true;
+
+  std::vector<int> order;
+  int neighbors[ 4 ];
+  for( int cell = 0; cell < cells; cell++ ) {
+    degree[ cell ] = liveNeighbors( cell, neighbors );
+    if( degree[ cell ] == 1 && !locked[ cell ] ) order.push_back( cell );
+  }
+
+  /* order doubles as the queue of dead ends and the fill order */
+  size_t head = 0;
+  while( head < order.size() ) {
+    int cell = order[ head++ ];
+    if( degree[ cell ] != 1 ) continue; /* last cell of its component */
+    liveNeighbors( cell, neighbors );
+    int next = neighbors[ 0 ];
+    filled[ cell ] = true;
+    parent[ cell ] = next;
+    if( --degree[ next ] == 1 && !locked[ next ] ) order.push_back( next );
+  }
+
+  /* parents are filled after their children, so walk the order backwards */
+  filled_count = 0;
+  for( int index = (int)order.size() - 1; index >= 0; index-- ) {
+    int cell = order[ index ];
+    if( !filled[ cell ] || anchor[ cell ] >= 0 ) continue;
+    int up = parent[ cell ];
+    depth[ cell ] = filled[ up ] ? depth[ up ] + 1 : 1;
+    anchor[ cell ] = filled[ up ] ? anchor[ up ] : up;
+    filled_count++;
+  }
+  for( int cell = 0; cell < cells; cell++ ) {
+    if( !filled[ cell ] ) anchor[ cell ] = cell;
+  }
+}
+
+/*******************************************************************************
+% Routine Name: compressCorridors
+% File:         MazeJunctionGraph.cpp
+% Parameters:   None.
+% Description:  Every core cell that is not a plain corridor cell becomes a
+%               junction, then each chain of corridor cells between two
+%               junctions becomes one weighted edge. Loops without any
+%               junction get one of their cells promoted to a junction.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeJunctionGraph::compressCorridors() {
+  const int cells = degree.size();
+  int neighbors[ 4 ];
+  std::vector<bool> locked( cells, false );
+  for( int cell : protected_cells ) locked[ cell ] = true;
+
+  for( int cell = 0; cell < cells; cell++ ) {
+    if( filled[ cell ] ) continue;
+    if( degree[ cell ] != 2 || locked[ cell ] ) addJunction( cell );
+  }
+  for( int junction = 0; junction < (int)junction_cells.size(); junction++ ) {
+    int count = liveNeighbors( junction_cells[ junction ], neighbors );
+    for( int index = 0; index < count; index++ ) {
+      traceCorridor( junction, neighbors[ index ] );
+    }
+  }
+  for( int cell = 0; cell < cells; cell++ ) {
+    if( filled[ cell ] || junction_of[ cell ] >= 0 || corridor_of[ cell ] >= 0 ) {
+      continue;
+    }
+    /* isolated loop of corridor cells */
+    int junction = addJunction( cell );
+    liveNeighbors( cell, neighbors );
+    traceCorridor( junction, neighbors[ 0 ] );
+  }
+}
+
+/*******************************************************************************
+% Routine Name: traceCorridor
+% File:         MazeJunctionGraph.cpp
+% Parameters:   junction - junction the corridor starts at.
+%               first    - first cell index stepped into from the junction.
+% Description:  Follows corridor cells until the next junction, numbering
+%               them by their offset from the start, and adds the edge.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeJunctionGraph::traceCorridor( int junction, int first ) {
+  if( corridor_of[ first ] >= 0 ) return; /* traced from the other end */
+  if( junction_of[ first ] >= 0 && junction_of[ first ] < junction ) return;
+
+  const int id = corridors.size();
+  int previous = junction_cells[ junction ];
+  int current = first;
+  int length = 0;
+  int neighbors[ 4 ];
+  while( junction_of[ current ] < 0 ) {
+    corridor_of[ current ] = id;
+    offset[ current ] = ++length;
+    liveNeighbors( current, neighbors );
+    int next = ( neighbors[ 0 ] == previous ) ? neighbors[ 1 ] : neighbors[ 0 ];
+    previous = current;
+    current = next;
+  }
+
+  Corridor corridor = { junction, junction_of[ current ], length };
+  corridors.push_back( corridor );
+  Edge forward = { corridor.to, length + 1 };
+  Edge backward = { corridor.from, length + 1 };
+  edges[ corridor.from ].push_back( forward );
+  if( corridor.from != corridor.to ) edges[ corridor.to ].push_back( backward );
+}
+
+/*******************************************************************************
+% Routine Name: distance
+% File:         MazeJunctionGraph.cpp
+% Parameters:   start - a cell in the maze.
+%               goal  - a cell in the maze.
+% Description:  Lifts both cells out of their filled trees onto the core,
+%               enters the junction graph through the ends of their corridors
+%               and runs Dijkstra over the junctions only.
+% Return:       The length of the shortest path, -1 if goal is unreachable.
+*******************************************************************************/
+int MazeJunctionGraph::distance( MazeCell * start, MazeCell * goal ) {
+  if( start == nullptr || goal == nullptr ) return -1;
+  MAZE_TRACE_SCOPE( "MazeJunctionGraph::distance" );
+  rebuild();
+  const int width = maze.getWidth();
+  int source = start->row * width + start->column;
+  int target = goal->row * width + goal->column;
+
+  if( anchor[ source ] == anchor[ target ] ) {
+    /* both cells hang off the same core cell - climb to their meeting */
+    int steps = 0;
+    while( source != target ) {
+      if( depth[ source ] >= depth[ target ] ) {
+        source = parent[ source ];
+        steps++;
+      }
+      else {
+        target = parent[ target ];
+        steps++;
+      }
+    }
+    return steps;
+  }
+
+  const int lifted = depth[ source ] + depth[ target ];
+  source = anchor[ source ];
+  target = anchor[ target ];
+  int best = -1;
+  if( corridor_of[ source ] >= 0 && corridor_of[ source ] == corridor_of[ target ] ) {
+    /* same corridor - walking along it is a candidate */
+    best = std::abs( offset[ source ] - offset[ target ] );
+  }
+
+  /* entry points - (junction, cost) pairs for both ends */
+  int source_junctions[ 2 ][ 2 ];
+  int target_junctions[ 2 ][ 2 ];
+  int source_count = 0;
+  int target_count = 0;
+  auto enter = [&]( int cell, int entries[ 2 ][ 2 ], int & count ) {
+    if( junction_of[ cell ] >= 0 ) {
+      entries[ count ][ 0 ] = junction_of[ cell ];
+      entries[ count++ ][ 1 ] = 0;
+      return;
+    }
+    Corridor & corridor = corridors[ corridor_of[ cell ] ];
+    entries[ count ][ 0 ] = corridor.from;
+    entries[ count++ ][ 1 ] = offset[ cell ];
+    entries[ count ][ 0 ] = corridor.to;
+    entries[ count++ ][ 1 ] = corridor.length + 1 - offset[ cell ];
+  };
+  enter( source, source_junctions, source_count );
+  enter( target, target_junctions, target_count );
+
+  /* Dijkstra over junctions - entries are (cost, junction) */
+  typedef std::pair<int, int> Entry;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+  const unsigned stamp = ++search_generation;
+  auto relax = [&]( int junction, int cost ) {
+    if( search_stamp[ junction ] == stamp && search_cost[ junction ] <= cost ) return;
+    search_stamp[ junction ] = stamp;
+    search_cost[ junction ] = cost;
+    open.push( Entry(cost, junction) );
+  };
+  for( int index = 0; index < source_count; index++ ) {
+    relax( source_junctions[ index ][ 0 ], source_junctions[ index ][ 1 ] );
+  }
+  while( !open.empty() ) {
+    int cost = open.top().first;
+    int junction = open.top().second;
+    open.pop();
+    if( best >= 0 && cost >= best ) break;
+    if( search_cost[ junction ] < cost ) continue; /* stale entry */
+    MAZE_COUNT( JUNCTION_GRAPH_EXPANSIONS );
+    for( int index = 0; index < target_count; index++ ) {
+      if( target_junctions[ index ][ 0 ] != junction ) continue;
+      int total = cost + target_junctions[ index ][ 1 ];
+      if( best < 0 || total < best ) best = total;
+    }
+    for( Edge & edge : edges[ junction ] ) {
+      relax( edge.to, cost + edge.weight );
+    }
+  }
+  return ( best < 0 ) ? -1 : best + lifted;
+}
+
+/*******************************************************************************
+% Routine Name: wallChanged
+% File:         MazeJunctionGraph.cpp
+% Parameters:   cell_A - a cell in the maze.
+%               cell_B - a cell in the maze.
+% Description:  Any wall change can turn dead ends into corridors, so the
+%               whole pass is redone lazily on the next query.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeJunctionGraph::wallChanged( MazeCell *, MazeCell * ) {
+  stale = true;
+}
+
+/*******************************************************************************
+% Routine Name: wallsChanged
+% File:         MazeJunctionGraph.cpp
+% Parameters:   maze    - maze whose walls changed.
+%               changes - passages that flipped.
+%               count   - number of changes.
+% Description:  Any batch of wall changes invalidates the whole pass, as a
+%               single wallChanged would.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeJunctionGraph::wallsChanged( Maze &, const WallChange *, int ) {
+  stale = true;
+}
+
+/*******************************************************************************
+% Routine Name: liveNeighbors
+% File:         MazeJunctionGraph.cpp
+% Parameters:   cell      - index of a cell in the maze.
+%               neighbors - output array of at least four cell indices.
+% Description:  Collects the open neighbors of a cell that are not filled.
+% Return:       The number of neighbors written.
+*******************************************************************************/
+int MazeJunctionGraph::liveNeighbors( int cell, int * neighbors ) {
+  const int width = maze.getWidth();
+  MazeCell * mazeCell = maze.at( cell / width, cell % width );
+  MazeCell * open[ 4 ] = { mazeCell->up, mazeCell->right,
+                           mazeCell->down, mazeCell->left };
+  int count = 0;
+  for( MazeCell * neighbor : open ) {
+    if( neighbor == nullptr ) continue;
+    int index = neighbor->row * width + neighbor->column;
+    if( !filled[ index ] ) neighbors[ count++ ] = index;
+  }
+  return count;
+}
+
+/*******************************************************************************
+% Routine Name: addJunction
+% File:         MazeJunctionGraph.cpp
+% Parameters:   cell - index of a core cell.
+% Description:  Registers a core cell as a vertex of the junction graph.
+% Return:       The junction id.
+*******************************************************************************/
+int MazeJunctionGraph::addJunction( int cell ) {
+  junction_of[ cell ] = junction_cells.size();
+  junction_cells.push_back( cell );
+  edges.push_back( std::vector<Edge>() );
+  return junction_of[ cell ];
+}
+
+/*******************************************************************************
+% Routine Name: getJunctionCell
+% File:         MazeJunctionGraph.cpp
+% Parameters:   junction - junction id.
+% Description:  Getter method for the maze cell of a junction.
+% Return:       The cell, nullptr for an invalid id.
+*******************************************************************************/
+MazeCell * MazeJunctionGraph::getJunctionCell( int junction ) {
+  rebuild();
+  if( junction < 0 || junction >= (int)junction_cells.size() ) return nullptr;
+  const int width = maze.getWidth();
+  return maze.at( junction_cells[ junction ] / width,
+                  junction_cells[ junction ] % width );
+}
+
+/*******************************************************************************
+% Routine Name: getEdges
+% File:         MazeJunctionGraph.cpp
+% Parameters:   junction - a valid junction id.
+% Description:  Getter method for the edges leaving a junction.
+% Return:       The edges, weighted by their path length in cells.
+*******************************************************************************/
+const std::vector<MazeJunctionGraph::Edge> & MazeJunctionGraph::getEdges(
+  int junction ) {
+
+  rebuild();
+  return edges[ junction ];
+}
+
+/*******************************************************************************
+% Routine Name: getCellCount
+% File:         MazeJunctionGraph.cpp
+% Parameters:   None.
+% Description:  Getter method for the number of cells in the maze.
+% Return:       Width times height of the maze.
+*******************************************************************************/
+int MazeJunctionGraph::getCellCount() {
+  return maze.getWidth() * maze.getHeight();
+}
+
+/*******************************************************************************
+% Routine Name: getFilledCount
+% File:         MazeJunctionGraph.cpp
+% Parameters:   None.
+% Description:  Getter method for the number of cells removed by dead-end
+%               filling.
+% Return:       The number of filled cells.
+*******************************************************************************/
+int MazeJunctionGraph::getFilledCount() {
+  rebuild();
+  return filled_count;
+}
+
+/*******************************************************************************
+% Routine Name: getJunctionCount
+% File:         MazeJunctionGraph.cpp
+% Parameters:   None.
+% Description:  Getter method for the number of junction graph vertices.
+% Return:       The number of junctions.
+*******************************************************************************/
+int MazeJunctionGraph::getJunctionCount() {
+  rebuild();
+  return junction_cells.size();
+}
+
+/*******************************************************************************
+% Routine Name: getEdgeCount
+% File:         MazeJunctionGraph.cpp
+% Parameters:   None.
+% Description:  Getter method for the number of junction graph edges.
+% Return:       The number of corridors.
+*******************************************************************************/
+int MazeJunctionGraph::getEdgeCount() {
+  rebuild();
+  return corridors.size();
+}
+
+/*******************************************************************************
+% Routine Name: getShrinkRatio
+% File:         MazeJunctionGraph.cpp
+% Parameters:   None.
+% Description:  Measures how much smaller the junction graph is than the maze.
+% Return:       Maze cells per junction graph vertex.
+*******************************************************************************/
+double MazeJunctionGraph::getShrinkRatio() {
+  rebuild();
+  if( junction_cells.empty() ) return getCellCount();
+  return (double)getCellCount() / junction_cells.size();
+}
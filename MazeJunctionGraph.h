@@ -0,0 +1,103 @@
+/*******************************************************************************
+                                                    Jose Jorge Jimenez-Olivas
+                                                    Brandon Cramer
+
+                 University of California, San Diego
+                           IEEE Micromouse
+
+File Name:       MazeJunctionGraph.h
+Description:     Dead-end filling and corridor compression of the maze into a
+                 weighted graph of junctions for fast repeated path queries.
+*******************************************************************************/
+#ifndef MAZE_JUNCTION_GRAPH_H
+#define MAZE_JUNCTION_GRAPH_H
+
+#include "Maze.h"
+#include <queue>
+#include <functional>
+
+class MazeJunctionGraph : public MazeListener {
+public:
+  /* weighted edge of the junction graph - one per corridor */
+  struct Edge {
+    int to;
+    int weight;
+  };
+
+private:
+  /* chain of degree-2 cells between two junctions */
+  struct Corridor {
+    int from;
+    int to;
+    int length;
+  };
+
+  Maze & maze;
+  std::vector<int> protected_cells;
+  bool stale = true;
+  /* per cell - filled cells hang off the core in trees */
+  std::vector<bool> filled;
+  std::vector<int> degree;
+  std::vector<int> parent;
+  std::vector<int> depth;
+  std::vector<int> anchor;
+  /* per core cell - junction id, or corridor id and offset from its start */
+  std::vector<int> junction_of;
+  std::vector<int> corridor_of;
+  std::vector<int> offset;
+  /* junction graph */
+  std::vector<int> junction_cells;
+  std::vector<Corridor> corridors;
+  std::vector<std::vector<Edge>> edges;
+  int filled_count = 0;
+  /* scratch for junction graph searches */
+  std::vector<unsigned> search_stamp;
+  std::vector<int> search_cost;
+  unsigned search_generation = 0;
+
+  /* removes dead ends until only loops, junctions and protected cells remain */
+  void fillDeadEnds();
+  /* collapses the remaining degree-2 chains into weighted edges */
+  void compressCorridors();
+  /* walks a corridor from a junction through the given first cell */
+  void traceCorridor( int junction, int first );
+  /* open neighbor cell indices of a cell that have not been filled */
+  int liveNeighbors( int cell, int * neighbors );
+  /* adds a junction for a core cell */
+  int addJunction( int cell );
+
+public:
+  /* Fills dead ends and compresses corridors of the given maze. */
+  MazeJunctionGraph( Maze & maze,
+    const std::vector<MazeCell *> & protect = std::vector<MazeCell *>() );
+  /* Detaches from the maze. */
+  ~MazeJunctionGraph();
+  /* Recomputes the preprocessing pass if the maze has changed. */
+  void rebuild();
+  /* Shortest path length between two cells of the maze. */
+  int distance( MazeCell * start, MazeCell * goal );
+  /* Marks the graph for recomputation on the next query. */
+  void wallChanged( MazeCell * cell_A, MazeCell * cell_B ) override;
+  /* Marks the graph stale once for a batch of wall changes. */
+  void wallsChanged( Maze & maze, const WallChange * changes, int count ) override;
+  /* Getter method for the maze cell of a junction. */
+  MazeCell * getJunctionCell( int junction );
+  /* Getter method for the edges leaving a junction. */
+  const std::vector<Edge> & getEdges( int junction );
+  /* Getter method for the number of cells in the maze. */
+  int getCellCount();
+  /* Getter method for the number of cells removed by dead-end filling. */
+  int getFilledCount();
+  /* Getter method for the number of junctions. */
+  int getJunctionCount();
+  /* Getter method for the number of corridors, counted as edges. */
+  int getEdgeCount();
+  /* Ratio of maze cells to junction graph vertices. */
+  double getShrinkRatio();
+};
+
+#ifndef ARDUINO
+  #include "MazeJunctionGraph.cpp"
+#endif
+
+#endif /* MAZE_JUNCTION_GRAPH_H */
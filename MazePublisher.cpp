@@ -0,0 +1,208 @@
+/*******************************************************************************
+                                                    Jose Jorge Jimenez-Olivas
+                                                    Brandon Cramer
+
+                 University of California, San Diego
+                           IEEE Micromouse
+
+File Name:       MazePublisher.cpp
+Description:     Publishes snapshots of a maze mutated by one writer thread,
+                 such as the sensor path, to wait-free reader threads.
+*******************************************************************************/
+#include "MazePublisher.h"
+
+const int MazePublisher::MAX_READERS;
+const uint64_t MazePublisher::IDLE_EPOCH;
+
+/*******************************************************************************
+% Constructor: MazePublisher
+% File:        MazePublisher.cpp
+% Parameters:  maze - maze mutated by the writer thread.
+% Description: Publishes the current walls as version 1 and listens to the
+%              maze for wall changes.
+*******************************************************************************/
+MazePublisher::MazePublisher( Maze & maze ) : maze( maze ), epoch( 1 ) {
+  for( int reader = 0; reader < MAX_READERS; reader++ ) {
+    reader_epochs[ reader ].store( IDLE_EPOCH );
+    reader_used[ reader ].store( false );
+  }
+  PublishedVersion * version = new PublishedVersion();
+  version->snapshot = maze.snapshot();
+  version->version = 1;
+  current.store( version );
+  maze.addListener( this );
+}
+
+/*******************************************************************************
+% Destructor:  ~MazePublisher
+% File:        MazePublisher.cpp
+% Parameters:  None.
+% Description: Stops listening to the maze and frees every version. No reader
+%              may hold a snapshot at this point.
+*******************************************************************************/
+MazePublisher::~MazePublisher() {
+  maze.removeListener( this );
+  for( PublishedVersion * version : retired ) delete version;
+  delete current.load();
+}
+
+/*******************************************************************************
+% Routine Name: wallChanged
+% File:         MazePublisher.cpp
+% Parameters:   cell_A - a cell in the maze.
+%               cell_B - a cell in the maze.
+% Description:  Marks the published walls as out of date. Runs on the writer
+%               thread, the only one allowed to mutate the maze.
+% Return:       Nothing.
+*******************************************************************************/
+void MazePublisher::wallChanged( MazeCell *, MazeCell * ) {
+  pending = true;
+}
+
+/*******************************************************************************
+% Routine Name: wallsChanged
+% File:         MazePublisher.cpp
+% Parameters:   maze    - maze whose walls changed.
+%               changes - passages that flipped.
+%               count   - number of changes.
+% Description:  Marks the published walls as out of date once for the whole
+%               batch.
+% Return:       Nothing.
+*******************************************************************************/
+void MazePublisher::wallsChanged( Maze &, const WallChange *, int ) {
+  pending = true;
+}
+
+/*******************************************************************************
+% Routine Name: publish
+% File:         MazePublisher.cpp
+% Parameters:   None.
+% Description:  Makes the walls of the maze visible to readers. The new
+%               snapshot copies only the row blocks changed since the last
+%               one and is installed with a single atomic store, so readers
+%               see either all or none of the changes since the previous
+%               publication. The replaced version is retired with the epoch
+%               it was replaced in and freed once every reader has moved
+%               past that epoch. Writer thread only.
+% Return:       True if a new version was published.
+*******************************************************************************/
+bool MazePublisher::publish() {
+  if( !pending ) {
+    reclaim();
+    return false;
+  }
+  pending = false;
+  PublishedVersion * version = new PublishedVersion();
+  version->snapshot = maze.snapshot();
+
+  PublishedVersion * previous = current.load();
+  version->version = previous->version + 1;
+  current.store( version );
+  /* readers announcing an earlier epoch may have loaded the previous one */
+  previous->retired_epoch = epoch.fetch_add( 1 ) + 1;
+  retired.push_back( previous );
+  reclaim();
+  return true;
+}
+
+/*******************************************************************************
+% Routine Name: reclaim
+% File:         MazePublisher.cpp
+% Parameters:   None.
+% Description:  Frees every retired version that no reader can still hold.
+%               A reader pins a version by announcing the epoch it read
+%               before loading the current version, so a version retired in
+%               epoch E is only reachable by readers announcing less than E.
+% Return:       Nothing.
+*******************************************************************************/
+void MazePublisher::reclaim() {
+  uint64_t oldest = IDLE_EPOCH;
+  for( int reader = 0; reader < MAX_READERS; reader++ ) {
+    oldest = std::min( oldest, reader_epochs[ reader ].load() );
+  }
+  size_t kept = 0;
+  for( size_t index = 0; index < retired.size(); index++ ) {
+    if( retired[ index ]->retired_epoch <= oldest ) delete retired[ index ];
+    else retired[ kept++ ] = retired[ index ];
+  }
+  retired.resize( kept );
+}
+
+/*******************************************************************************
+% Routine Name: registerReader
+% File:         MazePublisher.cpp
+% Parameters:   None.
+% Description:  Claims the first free one of the MAX_READERS reader slots.
+%               Every reader thread uses its own slot for acquire and
+%               release, and returns it with unregisterReader when done.
+% Return:       The reader slot, or -1 if all slots are taken.
+*******************************************************************************/
+int MazePublisher::registerReader() {
+  for( int reader = 0; reader < MAX_READERS; reader++ ) {
+    bool used = false;
+    if( reader_used[ reader ].compare_exchange_strong(used, true) ) return reader;
+  }
+  return -1;
+}
+
+/*******************************************************************************
+% Routine Name: unregisterReader
+% File:         MazePublisher.cpp
+% Parameters:   reader - slot returned by registerReader.
+% Description:  Returns a reader slot so that another thread can claim it.
+%               Any snapshot still pinned by the slot is released first.
+% Return:       Nothing.
+*******************************************************************************/
+void MazePublisher::unregisterReader( int reader ) {
+  reader_epochs[ reader ].store( IDLE_EPOCH );
+  reader_used[ reader ].store( false );
+}
+
+/*******************************************************************************
+% Routine Name: acquire
+% File:         MazePublisher.cpp
+% Parameters:   reader - slot returned by registerReader.
+% Description:  Pins the newest published snapshot until release. Takes two
+%               loads and a store - it never blocks on or retries against
+%               the writer, and the snapshot never changes while pinned.
+% Return:       The pinned snapshot.
+*******************************************************************************/
+const MazeSnapshot & MazePublisher::acquire( int reader ) {
+  reader_epochs[ reader ].store( epoch.load() );
+  return current.load()->snapshot;
+}
+
+/*******************************************************************************
+% Routine Name: release
+% File:         MazePublisher.cpp
+% Parameters:   reader - slot returned by registerReader.
+% Description:  Unpins the snapshot returned by acquire, which must not be
+%               used afterwards.
+% Return:       Nothing.
+*******************************************************************************/
+void MazePublisher::release( int reader ) {
+  reader_epochs[ reader ].store( IDLE_EPOCH );
+}
+
+/*******************************************************************************
+% Routine Name: getVersion
+% File:         MazePublisher.cpp
+% Parameters:   None.
+% Description:  Getter method for the version of the newest publication.
+% Return:       Number of versions published, starting at 1.
+*******************************************************************************/
+uint64_t MazePublisher::getVersion() const {
+  return current.load()->version;
+}
+
+/*******************************************************************************
+% Routine Name: getRetiredCount
+% File:         MazePublisher.cpp
+% Parameters:   None.
+% Description:  Getter method for the replaced versions still waiting for
+%               readers to move on. Writer thread only.
+% Return:       Number of retired versions not yet freed.
+*******************************************************************************/
+int MazePublisher::getRetiredCount() const {
+  return retired.size();
+}
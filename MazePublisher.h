@@ -0,0 +1,74 @@
+/*******************************************************************************
+                                                    Jose Jorge Jimenez-Olivas
+                                                    Brandon Cramer
+
+                 University of California, San Diego
+                           IEEE Micromouse
+
+File Name:       MazePublisher.h
+Description:     Publishes snapshots of a maze mutated by one writer thread,
+                 such as the sensor path, to wait-free reader threads.
+*******************************************************************************/
+#ifndef MAZE_PUBLISHER_H
+#define MAZE_PUBLISHER_H
+
+#include "Maze.h"
+#include <atomic>
+
+/* published snapshot and the epoch it was replaced in */
+struct PublishedVersion {
+  MazeSnapshot snapshot;
+  uint64_t version = 0;
+  uint64_t retired_epoch = 0;
+};
+
+class MazePublisher : public MazeListener {
+public:
+  static const int MAX_READERS = 8;
+  static const uint64_t IDLE_EPOCH = UINT64_MAX;
+
+private:
+  Maze & maze;
+  std::atomic<PublishedVersion *> current;
+  std::atomic<uint64_t> epoch;
+  /* epoch announced by every reader slot - IDLE_EPOCH when not reading */
+  std::atomic<uint64_t> reader_epochs[ MAX_READERS ];
+  /* whether each reader slot is claimed by a thread */
+  std::atomic<bool> reader_used[ MAX_READERS ];
+  /* replaced versions some reader may still hold - writer only */
+  std::vector<PublishedVersion *> retired;
+  bool pending = false;
+
+  /* frees the retired versions no reader can still hold */
+  void reclaim();
+
+public:
+  /* Publishes the current walls and listens to the maze for changes. */
+  MazePublisher( Maze & maze );
+  /* Stops listening and frees every version. */
+  ~MazePublisher();
+  /* Marks the published walls as out of date. */
+  void wallChanged( MazeCell * cell_A, MazeCell * cell_B ) override;
+  /* Marks the published walls as out of date once per batch. */
+  void wallsChanged( Maze & maze, const WallChange * changes, int count ) override;
+  /* Publishes the walls of the maze if they changed - writer thread only. */
+  bool publish();
+  /* Claims a reader slot for the calling thread. */
+  int registerReader();
+  /* Returns a reader slot so another thread can claim it. */
+  void unregisterReader( int reader );
+  /* Pins and returns the newest published snapshot - wait-free. */
+  const MazeSnapshot & acquire( int reader );
+  /* Unpins the snapshot returned by acquire. */
+  void release( int reader );
+  /* Getter method for the number of publications so far. */
+  uint64_t getVersion() const;
+  /* Getter method for the number of replaced versions not yet freed. */
+  int getRetiredCount() const;
+};
+
+#ifndef ARDUINO
+  #include "MazePublisher.cpp"
+#endif
+
+#endif /* MAZE_PUBLISHER_H */
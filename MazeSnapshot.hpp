@@ -0,0 +1,196 @@
+/*******************************************************************************
+                                                    Jose Jorge Jimenez-Olivas
+                                                    Brandon Cramer
+
+                 University of California, San Diego
+                           IEEE Micromouse
+
+File Name:       MazeSnapshot.hpp
+Description:     Immutable copy-on-write snapshot of the maze walls. Snapshots
+                 share every block of rows that did not change between them.
+*******************************************************************************/
+#ifndef MAZESNAPSHOT_HPP
+#define MAZESNAPSHOT_HPP
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+/* passage planes of a band of consecutive rows */
+struct SnapshotBlock {
+  std::vector<uint64_t> right;
+  std::vector<uint64_t> down;
+};
+
+class MazeSnapshot {
+public:
+  friend class Maze;
+  static const int BLOCK_ROWS = 16;
+  /* the four sides of a cell, as bits of an open side mask */
+  static const int UP = 0x1;
+  static const int RIGHT = 0x2;
+  static const int DOWN = 0x4;
+  static const int LEFT = 0x8;
+
+  /*****************************************************************************
+  % Routine Name: getWidth
+  % File:         MazeSnapshot.hpp
+  % Parameters:   None.
+  % Description:  Getter method for the width, in unit cells, of the maze.
+  % Return:       The width of the maze at the time of the snapshot.
+  *****************************************************************************/
+  int getWidth() const {
+    return width;
+  }
+
+  /*****************************************************************************
+  % Routine Name: getHeight
+  % File:         MazeSnapshot.hpp
+  % Parameters:   None.
+  % Description:  Getter method for the height, in unit cells, of the maze.
+  % Return:       The height of the maze at the time of the snapshot.
+  *****************************************************************************/
+  int getHeight() const {
+    return height;
+  }
+
+  /*****************************************************************************
+  % Routine Name: getHash
+  % File:         MazeSnapshot.hpp
+  % Parameters:   None.
+  % Description:  Getter method for the maze hash at the time of the snapshot.
+  % Return:       The value Maze::getHash() returned.
+  *****************************************************************************/
+  uint64_t getHash() const {
+    return hash;
+  }
+
+  /*****************************************************************************
+  % Routine Name: passageOpen
+  % File:         MazeSnapshot.hpp
+  % Parameters:   row         - row of the cell.
+  %               column      - column of the cell.
+  %               orientation - 0 for the passage right of the cell, 1 for
+  %                             the passage below it.
+  % Description:  Reads one passage bit from the shared row blocks.
+  % Return:       True if the passage is open.
+  *****************************************************************************/
+  bool passageOpen( int row, int column, int orientation ) const {
+    if( row < 0 || row >= height || column < 0 || column >= width ) return false;
+    const SnapshotBlock & block = *blocks[ row / BLOCK_ROWS ];
+    const std::vector<uint64_t> & plane = orientation ? block.down : block.right;
+    size_t word = (size_t)( row % BLOCK_ROWS ) * stride + column / 64;
+    return ( plane[ word ] >> (column % 64) ) & 1;
+  }
+
+  /*****************************************************************************
+  % Routine Name: openSides
+  % File:         MazeSnapshot.hpp
+  % Parameters:   row    - row of the cell.
+  %               column - column of the cell.
+  % Description:  Collects the open sides of a cell, the snapshot counterpart
+  %               of MazeCell::getNeighborList.
+  % Return:       Mask of UP, RIGHT, DOWN and LEFT.
+  *****************************************************************************/
+  int openSides( int row, int column ) const {
+    int sides = 0;
+    if( passageOpen(row - 1, column, 1) ) sides |= UP;
+    if( passageOpen(row, column, 0) ) sides |= RIGHT;
+    if( passageOpen(row, column, 1) ) sides |= DOWN;
+    if( passageOpen(row, column - 1, 0) ) sides |= LEFT;
+    return sides;
+  }
+
+  /*****************************************************************************
+  % Routine Name: wallBetween
+  % File:         MazeSnapshot.hpp
+  % Parameters:   row_A    - row of the first cell.
+  %               column_A - column of the first cell.
+  %               row_B    - row of the second cell.
+  %               column_B - column of the second cell.
+  % Description:  Checks if a wall separates two cells, as Maze::wallBetween.
+  % Return:       True unless the cells are adjacent with an open passage.
+  *****************************************************************************/
+  bool wallBetween( int row_A, int column_A, int row_B, int column_B ) const {
+    if( row_A == row_B && column_A + 1 == column_B ) return !passageOpen( row_A, column_A, 0 );
+    if( row_A == row_B && column_B + 1 == column_A ) return !passageOpen( row_B, column_B, 0 );
+    if( column_A == column_B && row_A + 1 == row_B ) return !passageOpen( row_A, column_A, 1 );
+    if( column_A == column_B && row_B + 1 == row_A ) return !passageOpen( row_B, column_B, 1 );
+    return true;
+  }
+
+  /*****************************************************************************
+  % Routine Name: sharedBlocks
+  % File:         MazeSnapshot.hpp
+  % Parameters:   other - another snapshot.
+  % Description:  Counts the row blocks both snapshots point to.
+  % Return:       Number of blocks stored once for both snapshots.
+  *****************************************************************************/
+  int sharedBlocks( const MazeSnapshot & other ) const {
+    int shared = 0;
+    for( size_t block = 0; block < blocks.size() && block < other.blocks.size(); block++ ) {
+      if( blocks[ block ] == other.blocks[ block ] ) shared++;
+    }
+    return shared;
+  }
+
+  /*****************************************************************************
+  % Routine Name: encodedSize
+  % File:         MazeSnapshot.hpp
+  % Parameters:   None.
+  % Description:  Size of the snapshot in the format of Maze::save - the big
+  %               endian width and height, then a 2-bit codeword per cell.
+  % Return:       Number of bytes encode produces in total.
+  *****************************************************************************/
+  size_t encodedSize() const {
+    return 2 * sizeof( uint32_t ) + ( 2 * (size_t)width * height + 7 ) / 8;
+  }
+
+  /*****************************************************************************
+  % Routine Name: encode
+  % File:         MazeSnapshot.hpp
+  % Parameters:   offset   - position in the encoded file of the first byte.
+  %               out      - buffer to fill.
+  %               capacity - size of the buffer.
+  % Description:  Encodes a chunk of the file Maze::save would write for the
+  %               snapshot, byte for byte. Chunks may be encoded in any order
+  %               and from any thread, so a board can fill a DMA buffer per
+  %               control cycle while a desktop worker writes large ones.
+  % Return:       Number of bytes written to out - 0 once offset reaches the
+  %               encoded size.
+  *****************************************************************************/
+  size_t encode( size_t offset, uint8_t * out, size_t capacity ) const {
+    const size_t header = 2 * sizeof( uint32_t );
+    const size_t cells = (size_t)width * height;
+    const size_t size = encodedSize();
+    size_t written = 0;
+    for( ; offset < size && written < capacity; offset++ ) {
+      if( offset < header ) {
+        const uint32_t field = ( offset < sizeof(uint32_t) ) ? width : height;
+        out[ written++ ] = field >> ( 8 * (3 - offset % sizeof(uint32_t)) );
+        continue;
+      }
+      /* four codewords per byte from the top - down bit, then right bit */
+      uint8_t byte = 0;
+      size_t cell = ( offset - header ) * 4;
+      for( int slot = 0; slot < 4 && cell < cells; slot++, cell++ ) {
+        const int row = cell / width;
+        const int column = cell % width;
+        const int codeword = passageOpen( row, column, 1 ) << 1 |
+                             passageOpen( row, column, 0 );
+        byte |= codeword << ( 6 - 2 * slot );
+      }
+      out[ written++ ] = byte;
+    }
+    return written;
+  }
+
+private:
+  int width = 0;
+  int height = 0;
+  int stride = 0;
+  uint64_t hash = 0;
+  std::vector<std::shared_ptr<const SnapshotBlock>> blocks;
+};
+#endif
@@ -0,0 +1,292 @@
+/*******************************************************************************
+                                                    Jose Jorge Jimenez-Olivas
+                                                    Brandon Cramer
+
+                 University of California, San Diego
+                           IEEE Micromouse
+
+File Name:       MazeSymmetry.cpp
+Description:     Rotations and reflections of the packed maze walls, and the
+                 canonical orientation of a maze under those 8 symmetries.
+*******************************************************************************/
+#include "MazeSymmetry.h"
+
+const int MazeSymmetry::SYMMETRIES;
+const int MazeSymmetry::FLIP_COLUMNS;
+const int MazeSymmetry::FLIP_ROWS;
+const int MazeSymmetry::TRANSPOSE;
+
+/* Helper Functions */
+namespace MazeSymmetryHelper {
+  uint64_t reverseWord( uint64_t word );
+}
+
+/*******************************************************************************
+% Routine Name: planesOf
+% File:         MazeSymmetry.cpp
+% Parameters:   maze - maze of interest.
+% Description:  Copies the passage planes of a maze.
+% Return:       The passage planes and their shape.
+*******************************************************************************/
+PassagePlanes MazeSymmetry::planesOf( const Maze & maze ) {
+  PassagePlanes planes;
+  planes.width = maze.getWidth();
+  planes.height = maze.getHeight();
+  planes.stride = maze.getPlaneStride();
+  planes.right = maze.getRightPlane();
+  planes.down = maze.getDownPlane();
+  return planes;
+}
+
+/*******************************************************************************
+% Routine Name: transform
+% File:         MazeSymmetry.cpp
+% Parameters:   planes   - passage planes of a maze.
+%               symmetry - combination of TRANSPOSE, FLIP_ROWS and
+%                          FLIP_COLUMNS, applied in that order.
+% Description:  Maps the walls of a maze through one of its 8 symmetries.
+%               Transposition swaps the two planes and transposes them in
+%               64x64 bit blocks, column flips reverse the bits of every row
+%               and row flips move whole rows.
+% Return:       Passage planes of the transformed maze.
+*******************************************************************************/
+PassagePlanes MazeSymmetry::transform( const PassagePlanes & planes, int symmetry ) {
+  PassagePlanes result = planes;
+
+  if( symmetry & TRANSPOSE ) {
+    /* a passage to the right becomes a passage below and vice versa */
+    transposePlane( planes.down, planes.height, planes.width, result.right );
+    transposePlane( planes.right, planes.height, planes.width, result.down );
+    result.width = planes.height;
+    result.height = planes.width;
+    result.stride = ( result.width + 63 ) / 64;
+  }
+
+  const int stride = result.stride;
+  if( symmetry & FLIP_COLUMNS ) {
+    std::vector<uint64_t> row_buffer( stride );
+    for( int row = 0; row < result.height; row++ ) {
+      uint64_t * right_row = &result.right[ (size_t)row * stride ];
+      uint64_t * down_row = &result.down[ (size_t)row * stride ];
+      /* passages right of cells span one bit fewer than the width */
+      reverseRow( right_row, row_buffer.data(), stride, result.width - 1 );
+      std::copy( row_buffer.begin(), row_buffer.end(), right_row );
+      reverseRow( down_row, row_buffer.data(), stride, result.width );
+      std::copy( row_buffer.begin(), row_buffer.end(), down_row );
+    }
+  }
+
+  if( symmetry & FLIP_ROWS ) {
+    std::vector<uint64_t> right( result.right.size(), 0 );
+    std::vector<uint64_t> down( result.down.size(), 0 );
+    for( int row = 0; row < result.height; row++ ) {
+      /* passages below cells span one row fewer than the height */
+      std::copy( &result.right[ (size_t)row * stride ],
+                 &result.right[ (size_t)row * stride ] + stride,
+                 &right[ (size_t)(result.height - 1 - row) * stride ] );
+      if( row == result.height - 1 ) continue;
+      std::copy( &result.down[ (size_t)row * stride ],
+                 &result.down[ (size_t)row * stride ] + stride,
+                 &down[ (size_t)(result.height - 2 - row) * stride ] );
+    }
+    result.right.swap( right );
+    result.down.swap( down );
+  }
+  return result;
+}
+
+/*******************************************************************************
+% Routine Name: canonicalize
+% File:         MazeSymmetry.cpp
+% Parameters:   maze - maze of interest.
+% Description:  Applies all 8 symmetries and keeps the smallest result, so
+%               every rotation and mirror image of a maze shares one form.
+% Return:       The canonical orientation, the symmetry that produced it and
+%               its hash.
+*******************************************************************************/
+CanonicalForm MazeSymmetry::canonicalize( const Maze & maze ) {
+  PassagePlanes planes = planesOf( maze );
+  CanonicalForm form;
+  form.planes = planes;
+  for( int symmetry = 1; symmetry < SYMMETRIES; symmetry++ ) {
+    PassagePlanes candidate = transform( planes, symmetry );
+    if( lessThan(candidate, form.planes) ) {
+      form.planes.right.swap( candidate.right );
+      form.planes.down.swap( candidate.down );
+      form.planes.width = candidate.width;
+      form.planes.height = candidate.height;
+      form.planes.stride = candidate.stride;
+      form.symmetry = symmetry;
+    }
+  }
+  form.hash = hashOf( form.planes );
+  return form;
+}
+
+/*******************************************************************************
+% Routine Name: canonicalHash
+% File:         MazeSymmetry.cpp
+% Parameters:   maze - maze of interest.
+% Description:  Hash shared by a maze and all its rotations and reflections.
+% Return:       Zobrist hash of the canonical orientation.
+*******************************************************************************/
+uint64_t MazeSymmetry::canonicalHash( const Maze & maze ) {
+  return canonicalize( maze ).hash;
+}
+
+/*******************************************************************************
+% Routine Name: hashOf
+% File:         MazeSymmetry.cpp
+% Parameters:   planes - passage planes of a maze.
+% Description:  Toggles the key of every open passage into the hash of a
+%               walled-in maze, visiting only set bits.
+% Return:       The hash Maze::getHash() reports for these walls.
+*******************************************************************************/
+uint64_t MazeSymmetry::hashOf( const PassagePlanes & planes ) {
+  uint64_t hash = Maze::wallsHash( planes.width, planes.height );
+  for( int orientation = 0; orientation < 2; orientation++ ) {
+    const std::vector<uint64_t> & plane = ( orientation == 0 ) ? planes.right
+                                                               : planes.down;
+    for( size_t index = 0; index < plane.size(); index++ ) {
+      uint64_t bits = plane[ index ];
+      while( bits ) {
+        int row = index / planes.stride;
+        int column = ( index % planes.stride ) * 64 + __builtin_ctzll( bits );
+        bits &= bits - 1;
+        hash ^= Maze::passageKey( planes.width, row, column, orientation );
+      }
+    }
+  }
+  return hash;
+}
+
+/*******************************************************************************
+% Routine Name: restore
+% File:         MazeSymmetry.cpp
+% Parameters:   planes - passage planes of a maze.
+%               maze   - maze with the same dimensions as the planes.
+% Description:  Writes passage planes, such as a canonical form, into a maze.
+% Return:       False if the dimensions do not match.
+*******************************************************************************/
+bool MazeSymmetry::restore( const PassagePlanes & planes, Maze & maze ) {
+  if( planes.width != maze.getWidth() || planes.height != maze.getHeight() ) return false;
+  return maze.setPassagePlanes( planes.right, planes.down );
+}
+
+/*******************************************************************************
+% Routine Name: reverseRow
+% File:         MazeSymmetry.cpp
+% Parameters:   in     - packed row of stride words.
+%               out    - packed row of stride words to write.
+%               stride - words per row.
+%               bits   - number of meaningful bits in the row.
+% Description:  Mirrors the first bits of a row, bit i moves to bits - 1 - i.
+%               Whole words are bit-reversed in reverse order, then the row
+%               is shifted down over the padding.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeSymmetry::reverseRow( const uint64_t * in, uint64_t * out, int stride,
+  int bits ) {
+
+  std::fill( out, out + stride, 0 );
+  if( bits <= 0 ) return;
+  std::vector<uint64_t> reversed( stride + 1, 0 );
+  for( int word = 0; word < stride; word++ ) {
+    reversed[ word ] = MazeSymmetryHelper::reverseWord( in[ stride - 1 - word ] );
+  }
+  int shift = stride * 64 - bits;
+  int words = shift / 64;
+  int offset = shift % 64;
+  for( int word = 0; word + words < stride; word++ ) {
+    out[ word ] = reversed[ word + words ] >> offset;
+    if( offset ) out[ word ] |= reversed[ word + words + 1 ] << ( 64 - offset );
+  }
+}
+
+/*******************************************************************************
+% Routine Name: transposeBlock
+% File:         MazeSymmetry.cpp
+% Parameters:   block - 64 rows of 64 bits, bit c of row r is element (r, c).
+% Description:  Transposes a 64x64 bit matrix in place by recursively
+%               swapping off-diagonal sub-blocks of halving size.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeSymmetry::transposeBlock( uint64_t * block ) {
+  uint64_t mask = 0x00000000FFFFFFFFULL;
+  for( int width = 32; width != 0; width >>= 1, mask ^= ( mask << width ) ) {
+    for( int row = 0; row < 64; row = ((row | width) + 1) & ~width ) {
+      uint64_t swap = ( (block[ row ] >> width) ^ block[ row | width ] ) & mask;
+      block[ row ] ^= swap << width;
+      block[ row | width ] ^= swap;
+    }
+  }
+}
+
+/*******************************************************************************
+% Routine Name: transposePlane
+% File:         MazeSymmetry.cpp
+% Parameters:   in      - packed plane of rows x columns bits.
+%               rows    - rows of the input plane.
+%               columns - meaningful bits per input row.
+%               out     - packed plane of columns x rows bits to write.
+% Description:  Transposes a packed bit plane one 64x64 block at a time.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeSymmetry::transposePlane( const std::vector<uint64_t> & in, int rows,
+  int columns, std::vector<uint64_t> & out ) {
+
+  const int in_stride = ( columns + 63 ) / 64;
+  const int out_stride = ( rows + 63 ) / 64;
+  out.assign( (size_t)columns * out_stride, 0 );
+  uint64_t block[ 64 ];
+
+  for( int block_row = 0; block_row < out_stride; block_row++ ) {
+    for( int block_column = 0; block_column < in_stride; block_column++ ) {
+      for( int index = 0; index < 64; index++ ) {
+        int row = block_row * 64 + index;
+        block[ index ] = ( row < rows ) ? in[ (size_t)row * in_stride + block_column ] : 0;
+      }
+      transposeBlock( block );
+      for( int index = 0; index < 64; index++ ) {
+        int column = block_column * 64 + index;
+        if( column >= columns ) break;
+        out[ (size_t)column * out_stride + block_row ] = block[ index ];
+      }
+    }
+  }
+}
+
+/*******************************************************************************
+% Routine Name: lessThan
+% File:         MazeSymmetry.cpp
+% Parameters:   planes_A - passage planes of a maze.
+%               planes_B - passage planes of a maze.
+% Description:  Strict ordering by dimensions, then the down plane, then the
+%               right plane, compared word by word.
+% Return:       True if planes_A orders before planes_B.
+*******************************************************************************/
+bool MazeSymmetry::lessThan( const PassagePlanes & planes_A,
+  const PassagePlanes & planes_B ) {
+
+  if( planes_A.width != planes_B.width ) return planes_A.width < planes_B.width;
+  if( planes_A.height != planes_B.height ) return planes_A.height < planes_B.height;
+  if( planes_A.down != planes_B.down ) return planes_A.down < planes_B.down;
+  return planes_A.right < planes_B.right;
+}
+
+/*******************************************************************************
+% Routine Name: reverseWord
+% File:         MazeSymmetry.cpp
+% Parameters:   word - 64-bit word.
+% Description:  Reverses the bit order of a word by swapping halves of
+%               decreasing size.
+% Return:       The reversed word.
+*******************************************************************************/
+uint64_t MazeSymmetryHelper::reverseWord( uint64_t word ) {
+  word = ( (word >> 1) & 0x5555555555555555ULL ) | ( (word & 0x5555555555555555ULL) << 1 );
+  word = ( (word >> 2) & 0x3333333333333333ULL ) | ( (word & 0x3333333333333333ULL) << 2 );
+  word = ( (word >> 4) & 0x0F0F0F0F0F0F0F0FULL ) | ( (word & 0x0F0F0F0F0F0F0F0FULL) << 4 );
+  word = ( (word >> 8) & 0x00FF00FF00FF00FFULL ) | ( (word & 0x00FF00FF00FF00FFULL) << 8 );
+  word = ( (word >> 16) & 0x0000FFFF0000FFFFULL ) | ( (word & 0x0000FFFF0000FFFFULL) << 16 );
+  return ( word >> 32 ) | ( word << 32 );
+}
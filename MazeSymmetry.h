@@ -0,0 +1,71 @@
+/*******************************************************************************
+                                                    Jose Jorge Jimenez-Olivas
+                                                    Brandon Cramer
+
+                 University of California, San Diego
+                           IEEE Micromouse
+
+File Name:       MazeSymmetry.h
+Description:     Rotations and reflections of the packed maze walls, and the
+                 canonical orientation of a maze under those 8 symmetries.
+*******************************************************************************/
+#ifndef MAZE_SYMMETRY_H
+#define MAZE_SYMMETRY_H
+
+#include "Maze.h"
+
+/* packed passage planes of a maze, laid out as in Maze */
+struct PassagePlanes {
+  int width = 0;
+  int height = 0;
+  int stride = 0;
+  std::vector<uint64_t> right;
+  std::vector<uint64_t> down;
+};
+
+/* maze walls in canonical orientation */
+struct CanonicalForm {
+  /* symmetry that maps the maze onto its canonical orientation */
+  int symmetry = 0;
+  PassagePlanes planes;
+  /* Zobrist hash of the canonical orientation - as Maze::getHash() */
+  uint64_t hash = 0;
+};
+
+class MazeSymmetry {
+private:
+  /* reverses the first bits of a packed row */
+  static void reverseRow( const uint64_t * in, uint64_t * out, int stride, int bits );
+  /* transposes a 64x64 bit matrix in place */
+  static void transposeBlock( uint64_t * block );
+  /* transposes a packed bit plane of rows x columns bits */
+  static void transposePlane( const std::vector<uint64_t> & in, int rows,
+    int columns, std::vector<uint64_t> & out );
+  /* orders passage planes of possibly different shapes */
+  static bool lessThan( const PassagePlanes & planes_A, const PassagePlanes & planes_B );
+
+public:
+  static const int SYMMETRIES = 8;
+  static const int FLIP_COLUMNS = 0x1;
+  static const int FLIP_ROWS = 0x2;
+  static const int TRANSPOSE = 0x4;
+
+  /* Copies the passage planes of a maze. */
+  static PassagePlanes planesOf( const Maze & maze );
+  /* Applies one of the 8 symmetries to passage planes. */
+  static PassagePlanes transform( const PassagePlanes & planes, int symmetry );
+  /* Finds the smallest orientation of a maze over all 8 symmetries. */
+  static CanonicalForm canonicalize( const Maze & maze );
+  /* Hash of the canonical orientation of a maze. */
+  static uint64_t canonicalHash( const Maze & maze );
+  /* Zobrist hash of passage planes, equal to Maze::getHash() of that maze. */
+  static uint64_t hashOf( const PassagePlanes & planes );
+  /* Writes passage planes into a maze of matching dimensions. */
+  static bool restore( const PassagePlanes & planes, Maze & maze );
+};
+
+#ifndef ARDUINO
+  #include "MazeSymmetry.cpp"
+#endif
+
+#endif /* MAZE_SYMMETRY_H */
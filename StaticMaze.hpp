@@ -0,0 +1,421 @@
+/*******************************************************************************
+                                                    Jose Jorge Jimenez-Olivas
+                                                    Brandon Cramer
+
+                 University of California, San Diego
+                           IEEE Micromouse
+
+File Name:       StaticMaze.hpp
+Description:     Fixed-size maze with bit-packed walls and a flood fill, sized
+                 at compile time - no heap allocation and no iostream.
+*******************************************************************************/
+#ifndef STATICMAZE_HPP
+#define STATICMAZE_HPP
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+/* cell location in a StaticMaze */
+struct StaticCell {
+  int row;
+  int column;
+
+  constexpr StaticCell( int row = 0, int column = 0 ) : row( row ), column( column ) {}
+
+  constexpr bool operator==( const StaticCell & cell ) const {
+    return row == cell.row && column == cell.column;
+  }
+
+  constexpr bool operator!=( const StaticCell & cell ) const {
+    return !( *this == cell );
+  }
+};
+
+template <int W, int H>
+class StaticMaze {
+  static_assert( W > 0 && H > 0, "StaticMaze dimensions must be positive" );
+
+public:
+  static constexpr int CELLS = W * H;
+  /* sides of a cell, as bits of a wall mask - as in Maze */
+  static constexpr int WALL_UP = 0x1;
+  static constexpr int WALL_RIGHT = 0x2;
+  static constexpr int WALL_DOWN = 0x4;
+  static constexpr int WALL_LEFT = 0x8;
+  static constexpr int ALL_SIDES = 0xF;
+  /* error codes of applyWalls - as in Maze */
+  static constexpr int INVALID_CELL = -1;
+  static constexpr int OPEN_BOUNDARY = -2;
+  /* smallest unsigned type holding a cell index */
+  typedef typename std::conditional<( CELLS <= 256 ), uint8_t,
+    typename std::conditional<( CELLS <= 65536 ), uint16_t, uint32_t>::type>::type index_type;
+
+private:
+  static constexpr int WORDS = ( CELLS + 31 ) / 32;
+  /* bit row * W + column is set if the passage right of / below it is open */
+  std::array<uint32_t, WORDS> right_plane;
+  std::array<uint32_t, WORDS> down_plane;
+
+  /*****************************************************************************
+  % Routine Name: passage
+  % File:         StaticMaze.hpp
+  % Parameters:   cell_A - a cell in the maze.
+  %               cell_B - a cell in the maze.
+  %               index  - set to the bit of the passage between the cells.
+  % Description:  Finds the plane and bit of the passage between two cells.
+  % Return:       The plane, or nullptr if the cells are not adjacent.
+  *****************************************************************************/
+  std::array<uint32_t, WORDS> * passage( StaticCell cell_A, StaticCell cell_B,
+    int & index ) {
+
+    return const_cast<std::array<uint32_t, WORDS> *>(
+      static_cast<const StaticMaze *>( this )->passage( cell_A, cell_B, index ) );
+  }
+
+  const std::array<uint32_t, WORDS> * passage( StaticCell cell_A,
+    StaticCell cell_B, int & index ) const {
+
+    if( outOfBounds(cell_A.row, cell_A.column) ||
+        outOfBounds(cell_B.row, cell_B.column) ) return nullptr;
+    const StaticCell & first = ( cell_A.row + cell_A.column < cell_B.row + cell_B.column )
+                               ? cell_A : cell_B;
+    const StaticCell & second = ( &first == &cell_A ) ? cell_B : cell_A;
+    index = indexOf( first.row, first.column );
+    if( first.row == second.row && first.column + 1 == second.column ) return &right_plane;
+    if( first.column == second.column && first.row + 1 == second.row ) return &down_plane;
+    return nullptr;
+  }
+
+  /*****************************************************************************
+  % Routine Name: bit
+  % File:         StaticMaze.hpp
+  % Parameters:   plane - passage plane.
+  %               index - cell index.
+  % Description:  Reads one passage bit.
+  % Return:       True if the passage is open.
+  *****************************************************************************/
+  static bool bit( const std::array<uint32_t, WORDS> & plane, int index ) {
+    return ( plane[ index >> 5 ] >> (index & 31) ) & 1;
+  }
+
+  /*****************************************************************************
+  % Routine Name: setBit
+  % File:         StaticMaze.hpp
+  % Parameters:   plane - passage plane.
+  %               index - cell index.
+  %               open  - true for an open passage, false for a wall.
+  % Description:  Writes one passage bit without branching on its value.
+  % Return:       True if the bit flipped.
+  *****************************************************************************/
+  static bool setBit( std::array<uint32_t, WORDS> & plane, int index, bool open ) {
+    uint32_t & word = plane[ index >> 5 ];
+    const uint32_t mask = (uint32_t)1 << ( index & 31 );
+    const uint32_t flip = ( word ^ (0u - (uint32_t)open) ) & mask;
+    word ^= flip;
+    return flip != 0;
+  }
+
+public:
+  /*****************************************************************************
+  % Constructor:  StaticMaze
+  % File:         StaticMaze.hpp
+  % Parameters:   None.
+  % Description:  Creates a maze with every cell walled in, as Maze does.
+  *****************************************************************************/
+  StaticMaze() {
+    clear();
+  }
+
+  /*****************************************************************************
+  % Routine Name: getWidth
+  % File:         StaticMaze.hpp
+  % Parameters:   None.
+  % Description:  Getter method for the width, in unit cells, of the maze.
+  % Return:       W.
+  *****************************************************************************/
+  constexpr int getWidth() const {
+    return W;
+  }
+
+  /*****************************************************************************
+  % Routine Name: getHeight
+  % File:         StaticMaze.hpp
+  % Parameters:   None.
+  % Description:  Getter method for the height, in unit cells, of the maze.
+  % Return:       H.
+  *****************************************************************************/
+  constexpr int getHeight() const {
+    return H;
+  }
+
+  /*****************************************************************************
+  % Routine Name: at
+  % File:         StaticMaze.hpp
+  % Parameters:   row    - row of the cell.
+  %               column - column of the cell.
+  % Description:  Accessor for a cell of the maze. Cells are plain locations,
+  %               the walls live in the bit planes.
+  % Return:       The cell at (row, column).
+  *****************************************************************************/
+  constexpr StaticCell at( int row, int column ) const {
+    return StaticCell( row, column );
+  }
+
+  /*****************************************************************************
+  % Routine Name: outOfBounds
+  % File:         StaticMaze.hpp
+  % Parameters:   row    - row of the cell.
+  %               column - column of the cell.
+  % Description:  Checks if the (row, column) coordinate is not in the maze.
+  % Return:       True if the coordinate is outside the maze.
+  *****************************************************************************/
+  constexpr bool outOfBounds( int row, int column ) const {
+    return row < 0 || row >= H || column < 0 || column >= W;
+  }
+
+  /*****************************************************************************
+  % Routine Name: indexOf
+  % File:         StaticMaze.hpp
+  % Parameters:   row    - row of the cell.
+  %               column - column of the cell.
+  % Description:  Row-major index of a cell.
+  % Return:       row * W + column.
+  *****************************************************************************/
+  static constexpr int indexOf( int row, int column ) {
+    return row * W + column;
+  }
+
+  /*****************************************************************************
+  % Routine Name: clear
+  % File:         StaticMaze.hpp
+  % Parameters:   None.
+  % Description:  Walls in every cell of the maze.
+  % Return:       Nothing.
+  *****************************************************************************/
+  void clear() {
+    right_plane.fill( 0 );
+    down_plane.fill( 0 );
+  }
+
+  /*****************************************************************************
+  % Routine Name: clearWalls
+  % File:         StaticMaze.hpp
+  % Parameters:   None.
+  % Description:  Clears the maze such that no walls will exist between two
+  %               cells. The planes are filled a word at a time, then the
+  %               passages through the right boundary are closed per row.
+  % Return:       Nothing.
+  *****************************************************************************/
+  void clearWalls() {
+    clear();
+    /* every cell but the last row opens down, every cell but the last column
+       opens right */
+    for( int word = 0; word < WORDS; word++ ) {
+      const int bits = CELLS - word * 32;
+      const uint32_t mask = ( bits >= 32 ) ? ~(uint32_t)0 : ( ((uint32_t)1 << bits) - 1 );
+      const int down_bits = ( H - 1 ) * W - word * 32;
+      right_plane[ word ] = mask;
+      down_plane[ word ] = ( down_bits >= 32 ) ? ~(uint32_t)0 : ( down_bits <= 0 ) ? 0 :
+                           ( ((uint32_t)1 << down_bits) - 1 );
+    }
+    for( int row = 0; row < H; row++ ) {
+      setBit( right_plane, indexOf(row, W - 1), false );
+    }
+  }
+
+  /*****************************************************************************
+  % Routine Name: addWall
+  % File:         StaticMaze.hpp
+  % Parameters:   cell_A - a cell in the maze.
+  %               cell_B - a cell adjacent to cell_A.
+  % Description:  Creates a wall between two neighbor cells in maze.
+  % Return:       False if the cells are not adjacent cells of the maze.
+  *****************************************************************************/
+  bool addWall( StaticCell cell_A, StaticCell cell_B ) {
+    int index;
+    std::array<uint32_t, WORDS> * plane = passage( cell_A, cell_B, index );
+    if( plane == nullptr ) return false;
+    setBit( *plane, index, false );
+    return true;
+  }
+
+  /*****************************************************************************
+  % Routine Name: removeWall
+  % File:         StaticMaze.hpp
+  % Parameters:   cell_A - a cell in the maze.
+  %               cell_B - a cell adjacent to cell_A.
+  % Description:  Removes the wall between two neighbor cells in maze.
+  % Return:       False if the cells are not adjacent cells of the maze.
+  *****************************************************************************/
+  bool removeWall( StaticCell cell_A, StaticCell cell_B ) {
+    int index;
+    std::array<uint32_t, WORDS> * plane = passage( cell_A, cell_B, index );
+    if( plane == nullptr ) return false;
+    setBit( *plane, index, true );
+    return true;
+  }
+
+  /*****************************************************************************
+  % Routine Name: wallBetween
+  % File:         StaticMaze.hpp
+  % Parameters:   cell_A - a cell in the maze.
+  %               cell_B - a cell in the maze.
+  % Description:  Evaluates if a wall exists between two cells in the maze.
+  % Return:       True unless the cells are adjacent with an open passage.
+  *****************************************************************************/
+  bool wallBetween( StaticCell cell_A, StaticCell cell_B ) const {
+    int index;
+    const std::array<uint32_t, WORDS> * plane = passage( cell_A, cell_B, index );
+    return plane == nullptr || !bit( *plane, index );
+  }
+
+  /*****************************************************************************
+  % Routine Name: openSides
+  % File:         StaticMaze.hpp
+  % Parameters:   cell - a cell in the maze.
+  % Description:  Collects the open sides of a cell.
+  % Return:       Mask of WALL_UP, WALL_RIGHT, WALL_DOWN and WALL_LEFT.
+  *****************************************************************************/
+  int openSides( StaticCell cell ) const {
+    const int index = indexOf( cell.row, cell.column );
+    return ( cell.row > 0 && bit(down_plane, index - W) ) * WALL_UP |
+           bit( right_plane, index ) * WALL_RIGHT |
+           bit( down_plane, index ) * WALL_DOWN |
+           ( cell.column > 0 && bit(right_plane, index - 1) ) * WALL_LEFT;
+  }
+
+  /*****************************************************************************
+  % Routine Name: getNeighborList
+  % File:         StaticMaze.hpp
+  % Parameters:   cell      - a cell in the maze.
+  %               neighbors - room for four cells.
+  % Description:  Gets the open neighbors of a cell in the order up, right,
+  %               down, left, as MazeCell::getNeighborList.
+  % Return:       Number of neighbors written.
+  *****************************************************************************/
+  int getNeighborList( StaticCell cell, StaticCell * neighbors ) const {
+    const int sides = openSides( cell );
+    int count = 0;
+    if( sides & WALL_UP ) neighbors[ count++ ] = StaticCell( cell.row - 1, cell.column );
+    if( sides & WALL_RIGHT ) neighbors[ count++ ] = StaticCell( cell.row, cell.column + 1 );
+    if( sides & WALL_DOWN ) neighbors[ count++ ] = StaticCell( cell.row + 1, cell.column );
+    if( sides & WALL_LEFT ) neighbors[ count++ ] = StaticCell( cell.row, cell.column - 1 );
+    return count;
+  }
+
+  /*****************************************************************************
+  % Routine Name: applyWalls
+  % File:         StaticMaze.hpp
+  % Parameters:   cell   - a cell in the maze.
+  %               walls  - mask of the sides with a wall.
+  %               sensed - mask of the sides the walls mask reports on.
+  % Description:  Applies one sensor reading around a cell, as
+  %               Maze::applyWalls.
+  % Return:       Number of walls that changed, INVALID_CELL or OPEN_BOUNDARY.
+  *****************************************************************************/
+  int applyWalls( StaticCell cell, int walls, int sensed = ALL_SIDES ) {
+    if( outOfBounds(cell.row, cell.column) ) return INVALID_CELL;
+    const int boundary = ( cell.row == 0 ) * WALL_UP | ( cell.column == W - 1 ) * WALL_RIGHT |
+                         ( cell.row == H - 1 ) * WALL_DOWN | ( cell.column == 0 ) * WALL_LEFT;
+    const int open = ~walls & sensed & ALL_SIDES;
+    if( open & boundary ) return OPEN_BOUNDARY;
+    sensed &= ~boundary;
+
+    const int index = indexOf( cell.row, cell.column );
+    int count = 0;
+    if( sensed & WALL_UP ) count += setBit( down_plane, index - W, open & WALL_UP );
+    if( sensed & WALL_RIGHT ) count += setBit( right_plane, index, open & WALL_RIGHT );
+    if( sensed & WALL_DOWN ) count += setBit( down_plane, index, open & WALL_DOWN );
+    if( sensed & WALL_LEFT ) count += setBit( right_plane, index - 1, open & WALL_LEFT );
+    return count;
+  }
+};
+
+template <int W, int H> constexpr int StaticMaze<W, H>::CELLS;
+template <int W, int H> constexpr int StaticMaze<W, H>::WALL_UP;
+template <int W, int H> constexpr int StaticMaze<W, H>::WALL_RIGHT;
+template <int W, int H> constexpr int StaticMaze<W, H>::WALL_DOWN;
+template <int W, int H> constexpr int StaticMaze<W, H>::WALL_LEFT;
+template <int W, int H> constexpr int StaticMaze<W, H>::ALL_SIDES;
+template <int W, int H> constexpr int StaticMaze<W, H>::INVALID_CELL;
+template <int W, int H> constexpr int StaticMaze<W, H>::OPEN_BOUNDARY;
+template <int W, int H> constexpr int StaticMaze<W, H>::WORDS;
+
+template <int W, int H>
+class StaticFloodFill {
+public:
+  typedef typename StaticMaze<W, H>::index_type index_type;
+  /* smallest unsigned type holding every distance and UNREACHED */
+  typedef typename std::conditional<( W * H < 255 ), uint8_t,
+    typename std::conditional<( W * H < 65535 ), uint16_t, uint32_t>::type>::type distance_type;
+  static constexpr distance_type UNREACHED = (distance_type)~(distance_type)0;
+
+private:
+  std::array<distance_type, W * H> distance;
+  /* breadth first queue - every cell enters it at most once */
+  std::array<index_type, W * H> queue;
+
+public:
+  /*****************************************************************************
+  % Constructor:  StaticFloodFill
+  % File:         StaticMaze.hpp
+  % Parameters:   None.
+  % Description:  Creates a flood fill with every cell unreached.
+  *****************************************************************************/
+  StaticFloodFill() {
+    distance.fill( UNREACHED );
+  }
+
+  /*****************************************************************************
+  % Routine Name: run
+  % File:         StaticMaze.hpp
+  % Parameters:   maze  - maze to flood.
+  %               goals - cells the distances are measured to.
+  %               count - number of goals.
+  % Description:  Breadth first flood fill from the goals over the open
+  %               passages of the maze.
+  % Return:       Number of cells reached.
+  *****************************************************************************/
+  int run( const StaticMaze<W, H> & maze, const StaticCell * goals, int count ) {
+    distance.fill( UNREACHED );
+    int head = 0;
+    int tail = 0;
+    for( int goal = 0; goal < count; goal++ ) {
+      if( maze.outOfBounds(goals[ goal ].row, goals[ goal ].column) ) continue;
+      const int index = StaticMaze<W, H>::indexOf( goals[ goal ].row, goals[ goal ].column );
+      if( distance[ index ] == UNREACHED ) {
+        distance[ index ] = 0;
+        queue[ tail++ ] = index;
+      }
+    }
+    while( head < tail ) {
+      const int index = queue[ head++ ];
+      const int sides = maze.openSides( StaticCell(index / W, index % W) );
+      const distance_type next = distance[ index ] + 1;
+      const int neighbor[ 4 ] = { index - W, index + 1, index + W, index - 1 };
+      for( int side = 0; side < 4; side++ ) {
+        if( !((sides >> side) & 1) || distance[ neighbor[ side ] ] != UNREACHED ) continue;
+        distance[ neighbor[ side ] ] = next;
+        queue[ tail++ ] = neighbor[ side ];
+      }
+    }
+    return tail;
+  }
+
+  /*****************************************************************************
+  % Routine Name: getDistance
+  % File:         StaticMaze.hpp
+  % Parameters:   cell - a cell in the maze.
+  % Description:  Distance from a cell to the nearest goal of the last run.
+  % Return:       The distance, or UNREACHED.
+  *****************************************************************************/
+  distance_type getDistance( StaticCell cell ) const {
+    return distance[ StaticMaze<W, H>::indexOf( cell.row, cell.column ) ];
+  }
+};
+
+template <int W, int H>
+constexpr typename StaticFloodFill<W, H>::distance_type StaticFloodFill<W, H>::UNREACHED;
+
+#endif
@@ -0,0 +1,184 @@
+/*******************************************************************************
+                                                    Jose Jorge Jimenez-Olivas
+                                                    Brandon Cramer
+
+                 University of California, San Diego
+                           IEEE Micromouse
+
+File Name:       LayoutBenchmark.cpp
+Description:     Breadth first search time and cache misses of the row-major,
+                 tiled and Morton cell layouts on mazes of growing size.
+
+Build:           g++ -std=c++11 -O2 -I../.. LayoutBenchmark.cpp -o layout_benchmark
+Usage:           layout_benchmark [megabytes ...]    (default 1 16 256 1024)
+Output:          One line per maze size and layout - size, dimensions, layout,
+                 BFS time and hardware cache and dTLB misses when the kernel
+                 exposes performance counters ("n/a" otherwise).
+*******************************************************************************/
+#include "Maze.h"
+#include <chrono>
+#include <random>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+/* Helper Functions */
+namespace LayoutBenchmarkHelper {
+  int openCounter( uint32_t type, uint64_t config );
+  void randomPassages( int width, int height, unsigned seed,
+    std::vector<uint64_t> & right, std::vector<uint64_t> & down );
+  long search( Maze & maze, std::vector<MazeCell *> & queue );
+  std::string counterValue( int counter );
+}
+
+/*******************************************************************************
+% Routine Name: main
+% File:         LayoutBenchmark.cpp
+% Parameters:   argc - number of arguments.
+%               argv - maze sizes in megabytes of cell storage.
+% Description:  Builds a square maze of each size with the same random walls
+%               under every layout and times a breadth first search from the
+%               center over the cell links.
+% Return:       0 on success, 1 on bad usage.
+*******************************************************************************/
+int main( int argc, char * argv[] ) {
+  std::vector<long> sizes;
+  for( int index = 1; index < argc; index++ ) {
+    long megabytes = std::atol( argv[ index ] );
+    if( megabytes <= 0 ) {
+      std::cerr << "Usage: " << argv[ 0 ] << " [megabytes ...]" << std::endl;
+      return 1;
+    }
+    sizes.push_back( megabytes );
+  }
+  if( sizes.empty() ) sizes = { 1, 16, 256, 1024 };
+
+  const char * names[] = { "row-major", "tiled", "morton" };
+  std::cout << "MB\tdimensions\tlayout\tbfs_ms\tcache_misses\tdtlb_misses" << std::endl;
+  for( long megabytes : sizes ) {
+    const long cells = megabytes * 1024 * 1024 / sizeof( MazeCell );
+    const int side = std::max( 1, (int)std::sqrt( (double)cells ) );
+    std::vector<uint64_t> right, down;
+    LayoutBenchmarkHelper::randomPassages( side, side, megabytes, right, down );
+
+    for( int layout = Maze::ROW_MAJOR; layout <= Maze::MORTON; layout++ ) {
+      Maze maze( side, side, (Maze::Layout)layout );
+      maze.setPassagePlanes( right, down );
+      std::vector<MazeCell *> queue( (size_t)side * side );
+
+      int cache_misses = LayoutBenchmarkHelper::openCounter( PERF_TYPE_HARDWARE,
+        PERF_COUNT_HW_CACHE_MISSES );
+      int tlb_misses = LayoutBenchmarkHelper::openCounter( PERF_TYPE_HW_CACHE,
+        PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+        (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) );
+      for( int counter : { cache_misses, tlb_misses } ) {
+        if( counter >= 0 ) ioctl( counter, PERF_EVENT_IOC_ENABLE, 0 );
+      }
+      auto start = std::chrono::steady_clock::now();
+      long reached = LayoutBenchmarkHelper::search( maze, queue );
+      auto stop = std::chrono::steady_clock::now();
+      for( int counter : { cache_misses, tlb_misses } ) {
+        if( counter >= 0 ) ioctl( counter, PERF_EVENT_IOC_DISABLE, 0 );
+      }
+
+      std::cout << megabytes << "\t" << side << "x" << side << "\t" << names[ layout ]
+                << "\t" << std::chrono::duration<double, std::milli>( stop - start ).count()
+                << "\t" << LayoutBenchmarkHelper::counterValue( cache_misses )
+                << "\t" << LayoutBenchmarkHelper::counterValue( tlb_misses ) << std::endl;
+      if( reached <= 0 ) std::cerr << "search reached no cells" << std::endl;
+    }
+  }
+  return 0;
+}
+
+/*******************************************************************************
+% Routine Name: openCounter
+% File:         LayoutBenchmark.cpp
+% Parameters:   type   - perf event type.
+%               config - perf event configuration.
+% Description:  Opens a disabled hardware counter for the calling thread.
+% Return:       The counter file descriptor, or -1 if unavailable.
+*******************************************************************************/
+int LayoutBenchmarkHelper::openCounter( uint32_t type, uint64_t config ) {
+  struct perf_event_attr attributes;
+  std::memset( &attributes, 0, sizeof(attributes) );
+  attributes.size = sizeof( attributes );
+  attributes.type = type;
+  attributes.config = config;
+  attributes.disabled = 1;
+  attributes.exclude_kernel = 1;
+  attributes.exclude_hv = 1;
+  return syscall( __NR_perf_event_open, &attributes, 0, -1, -1, 0 );
+}
+
+/*******************************************************************************
+% Routine Name: counterValue
+% File:         LayoutBenchmark.cpp
+% Parameters:   counter - counter file descriptor, or -1.
+% Description:  Reads and closes a counter.
+% Return:       The count, or "n/a" if the counter is unavailable.
+*******************************************************************************/
+std::string LayoutBenchmarkHelper::counterValue( int counter ) {
+  if( counter < 0 ) return "n/a";
+  long long value = 0;
+  bool ok = read( counter, &value, sizeof(value) ) == sizeof( value );
+  close( counter );
+  return ok ? std::to_string( value ) : "n/a";
+}
+
+/*******************************************************************************
+% Routine Name: randomPassages
+% File:         LayoutBenchmark.cpp
+% Parameters:   width  - width of the maze.
+%               height - height of the maze.
+%               seed   - random seed.
+%               right  - set to the plane of passages right of cells.
+%               down   - set to the plane of passages below cells.
+% Description:  Opens about 3 in 4 passages at random, which leaves one
+%               large connected region for the search to cover.
+% Return:       Nothing.
+*******************************************************************************/
+void LayoutBenchmarkHelper::randomPassages( int width, int height, unsigned seed,
+  std::vector<uint64_t> & right, std::vector<uint64_t> & down ) {
+
+  std::mt19937_64 generator( seed );
+  const size_t words = (size_t)height * ( (width + 63) / 64 );
+  right.resize( words );
+  down.resize( words );
+  for( size_t word = 0; word < words; word++ ) {
+    right[ word ] = generator() | generator();
+    down[ word ] = generator() | generator();
+  }
+}
+
+/*******************************************************************************
+% Routine Name: search
+% File:         LayoutBenchmark.cpp
+% Parameters:   maze  - maze to search.
+%               queue - room for every cell of the maze.
+% Description:  Breadth first search from the center cell that keeps its
+%               state in the cells, so every step touches cell storage.
+% Return:       Number of cells reached.
+*******************************************************************************/
+long LayoutBenchmarkHelper::search( Maze & maze, std::vector<MazeCell *> & queue ) {
+  for( MazeCell * cell : maze ) cell->setVisited( false );
+  size_t head = 0;
+  size_t tail = 0;
+  MazeCell * start = maze.at( maze.getHeight() / 2, maze.getWidth() / 2 );
+  start->setVisited( true );
+  start->setDistance( 0 );
+  queue[ tail++ ] = start;
+  while( head < tail ) {
+    MazeCell * cell = queue[ head++ ];
+    for( MazeCell * neighbor : { cell->up, cell->right, cell->down, cell->left } ) {
+      if( neighbor == nullptr || neighbor->visited ) continue;
+      neighbor->visited = true;
+      neighbor->distance = cell->distance + 1;
+      neighbor->prev = cell;
+      queue[ tail++ ] = neighbor;
+    }
+  }
+  return tail;
+}
@@ -0,0 +1,460 @@
+/*******************************************************************************
+                                                    Jose Jorge Jimenez-Olivas
+                                                    Brandon Cramer
+
+                 University of California, San Diego
+                           IEEE Micromouse
+
+File Name:       MazeBenchmark.cpp
+Description:     Benchmark suite of the core Maze operations and every solver
+                 on seeded random mazes of growing size.
+
+Build:           make -C .. benchmark/maze_benchmark, or
+                 g++ -std=c++11 -O2 -pthread -I../.. MazeBenchmark.cpp -o maze_benchmark
+Usage:           maze_benchmark [options]
+                   --sizes N,N,...   maze sides (default 16,64,256,1024 - sides
+                                     up to 16384 need about 100 bytes per cell)
+                   --ops NAME,...    run only these operations (default all)
+                   --seed N          seed of the random mazes (default 1)
+                   --min-time S      seconds to repeat each operation (default 0.2)
+                   --format FORMAT   tsv (default), csv or json
+                   --label TEXT      version label copied into every record
+Output:          One record per maze size and operation - iterations, ns/op,
+                 cells/s, bytes allocated per op and the peak RSS of the
+                 process so far.
+*******************************************************************************/
+#include "Maze.h"
+#include "MazeFloodFill.h"
+#include "MazeHPA.h"
+#include "MazeJunctionGraph.h"
+#include "MazeAnalytics.h"
+#include "MazeExplorationPlanner.h"
+#include "StaticMaze.hpp"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <new>
+#include <random>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/resource.h>
+
+/* bytes handed out by operator new since the start of the program */
+static std::atomic<unsigned long long> allocated_bytes( 0 );
+
+/* counted allocation behind every form of new and delete */
+namespace MazeBenchmarkAllocation {
+  void * allocate( size_t size ) noexcept __attribute__(( noinline ));
+  void release( void * memory ) noexcept __attribute__(( noinline ));
+}
+
+/*******************************************************************************
+% Routine Name: allocate
+% File:         MazeBenchmark.cpp
+% Parameters:   size - bytes requested.
+% Description:  Counts and allocates the memory of every form of operator
+%               new. Kept out of line so that the compiler pairs every new
+%               with a delete rather than with malloc and free.
+% Return:       The allocated memory, or nullptr if none is left.
+*******************************************************************************/
+void * MazeBenchmarkAllocation::allocate( size_t size ) noexcept {
+  allocated_bytes += size;
+  return std::malloc( size ? size : 1 );
+}
+
+/*******************************************************************************
+% Routine Name: release
+% File:         MazeBenchmark.cpp
+% Parameters:   memory - memory from allocate.
+% Description:  Releases the memory of every form of operator delete.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeBenchmarkAllocation::release( void * memory ) noexcept {
+  std::free( memory );
+}
+
+/* every replaceable form of new and delete goes through the counted pair */
+void * operator new( size_t size ) {
+  void * memory = MazeBenchmarkAllocation::allocate( size );
+  if( memory == nullptr ) throw std::bad_alloc();
+  return memory;
+}
+void * operator new[]( size_t size ) {
+  void * memory = MazeBenchmarkAllocation::allocate( size );
+  if( memory == nullptr ) throw std::bad_alloc();
+  return memory;
+}
+void * operator new( size_t size, const std::nothrow_t & ) noexcept {
+  return MazeBenchmarkAllocation::allocate( size );
+}
+void * operator new[]( size_t size, const std::nothrow_t & ) noexcept {
+  return MazeBenchmarkAllocation::allocate( size );
+}
+void operator delete( void * memory ) noexcept {
+  MazeBenchmarkAllocation::release( memory );
+}
+void operator delete[]( void * memory ) noexcept {
+  MazeBenchmarkAllocation::release( memory );
+}
+void operator delete( void * memory, const std::nothrow_t & ) noexcept {
+  MazeBenchmarkAllocation::release( memory );
+}
+void operator delete[]( void * memory, const std::nothrow_t & ) noexcept {
+  MazeBenchmarkAllocation::release( memory );
+}
+#if __cplusplus >= 201402L
+void operator delete( void * memory, size_t ) noexcept {
+  MazeBenchmarkAllocation::release( memory );
+}
+void operator delete[]( void * memory, size_t ) noexcept {
+  MazeBenchmarkAllocation::release( memory );
+}
+#endif
+
+/* one measured operation */
+struct BenchmarkRecord {
+  int side;
+  std::string operation;
+  long iterations;
+  double ns_per_op;
+  double cells_per_second;
+  double bytes_per_op;
+  long peak_rss_kb;
+};
+
+/* Helper Functions */
+namespace MazeBenchmarkHelper {
+  void randomPassages( Maze & maze, unsigned seed );
+  BenchmarkRecord measure( int side, const std::string & operation, long ops_per_call,
+    double cells_per_op, double min_time, const std::function<void()> & body );
+  std::vector<int> parseList( const std::string & text );
+  bool quietly( const std::function<bool()> & call );
+  long peakRSS();
+}
+
+/*******************************************************************************
+% Routine Name: main
+% File:         MazeBenchmark.cpp
+% Parameters:   argc - number of arguments.
+%               argv - options.
+% Description:  Builds one seeded maze per size and measures every selected
+%               operation on it.
+% Return:       0 on success, 1 on bad usage.
+*******************************************************************************/
+int main( int argc, char * argv[] ) {
+  std::vector<int> sides = { 16, 64, 256, 1024 };
+  std::vector<std::string> selected;
+  unsigned seed = 1;
+  double min_time = 0.2;
+  std::string format = "tsv";
+  std::string label;
+  bool bad_usage = false;
+
+  for( int index = 1; index < argc; index++ ) {
+    std::string option = argv[ index ];
+    bool has_value = index + 1 < argc;
+    if( option == "--sizes" && has_value ) sides = MazeBenchmarkHelper::parseList( argv[ ++index ] );
+    else if( option == "--seed" && has_value ) seed = std::atoi( argv[ ++index ] );
+    else if( option == "--min-time" && has_value ) min_time = std::atof( argv[ ++index ] );
+    else if( option == "--format" && has_value ) format = argv[ ++index ];
+    else if( option == "--label" && has_value ) label = argv[ ++index ];
+    else if( option == "--ops" && has_value ) {
+      std::string list = argv[ ++index ];
+      for( size_t begin = 0, end; begin <= list.size(); begin = end + 1 ) {
+        end = std::min( list.find(',', begin), list.size() );
+        if( end > begin ) selected.push_back( list.substr(begin, end - begin) );
+      }
+    }
+    else bad_usage = true;
+  }
+  for( int side : sides ) bad_usage |= ( side < 2 );
+  if( bad_usage || sides.empty() || min_time < 0 ||
+      (format != "tsv" && format != "csv" && format != "json") ) {
+    std::cerr << "Usage: " << argv[ 0 ] << " [--sizes N,...] [--ops NAME,...] [--seed N]"
+              << " [--min-time S] [--format tsv|csv|json] [--label TEXT]" << std::endl;
+    return 1;
+  }
+  auto wanted = [&]( const char * operation ) {
+    return selected.empty() ||
+           std::find( selected.begin(), selected.end(), operation ) != selected.end();
+  };
+
+  char file_template[] = "/tmp/maze_benchmark_XXXXXX";
+  const int file_descriptor = mkstemp( file_template );
+  if( file_descriptor >= 0 ) close( file_descriptor );
+
+  std::vector<BenchmarkRecord> records;
+  volatile long sink = 0;
+  for( int side : sides ) {
+    const double cells = (double)side * side;
+    std::mt19937 generator( seed + side );
+    std::uniform_int_distribution<int> coordinate( 0, side - 2 );
+    /* random cells and their right neighbors, for the per cell operations */
+    const int SAMPLES = 1024;
+    std::vector<std::pair<int, int>> samples( SAMPLES );
+    for( auto & sample : samples ) sample = { coordinate(generator), coordinate(generator) };
+
+    auto record = [&]( const char * operation, long ops_per_call, double cells_per_op,
+      const std::function<void()> & body ) {
+      if( !wanted(operation) ) return;
+      records.push_back( MazeBenchmarkHelper::measure(side, operation, ops_per_call,
+        cells_per_op, min_time, body) );
+      std::cerr << side << "x" << side << " " << operation << " done" << std::endl;
+    };
+
+    record( "construct", 1, cells, [&] {
+      Maze maze( side, side );
+      sink += maze.getWidth();
+    } );
+
+    Maze maze( side, side );
+    MazeBenchmarkHelper::randomPassages( maze, seed + side );
+    MazeCell * start = maze.at( side - 1, 0 );
+    MazeCell * goal = maze.at( side / 2, side / 2 );
+
+    record( "at", SAMPLES, 1, [&] {
+      for( const auto & sample : samples ) sink += maze.at( sample.first, sample.second )->row;
+    } );
+    record( "add_remove_wall", 2 * SAMPLES, 1, [&] {
+      for( const auto & sample : samples ) {
+        MazeCell * cell = maze.at( sample.first, sample.second );
+        MazeCell * right = maze.at( sample.first, sample.second + 1 );
+        bool wall = maze.wallBetween( cell, right );
+        maze.addWall( cell, right );
+        maze.removeWall( cell, right );
+        if( wall ) maze.addWall( cell, right );
+      }
+    } );
+    record( "wall_between", SAMPLES, 1, [&] {
+      for( const auto & sample : samples ) {
+        sink += maze.wallBetween( maze.at(sample.first, sample.second),
+                                  maze.at(sample.first + 1, sample.second) );
+      }
+    } );
+    record( "get_neighbor_list", SAMPLES, 1, [&] {
+      for( const auto & sample : samples ) {
+        sink += maze.at( sample.first, sample.second )->getNeighborList().size();
+      }
+    } );
+    if( wanted("clear_walls") ) {
+      Maze scratch( maze );
+      record( "clear_walls", 1, cells, [&] { scratch.clearWalls(); } );
+    }
+    if( wanted("equality") ) {
+      Maze copy( maze );
+      record( "equality", 1, cells, [&] { sink += ( maze == copy ); } );
+    }
+    record( "save", 1, cells, [&] {
+      sink += MazeBenchmarkHelper::quietly( [&] { return maze.save( file_template ); } );
+    } );
+    if( wanted("load") || wanted("decode") ) {
+      MazeBenchmarkHelper::quietly( [&] { return maze.save( file_template ); } );
+      Maze loaded( side, side );
+      record( "load", 1, cells, [&] {
+        sink += MazeBenchmarkHelper::quietly( [&] { return loaded.load( file_template ); } );
+      } );
+      /* the same bytes decoded in memory, without the file or any progress */
+      std::ifstream instream( file_template, std::ios::in | std::ios::binary );
+      const std::vector<uint8_t> bytes( (std::istreambuf_iterator<char>(instream)),
+                                        std::istreambuf_iterator<char>() );
+      record( "decode", 1, cells, [&] { sink += loaded.decode( bytes.data(), bytes.size() ); } );
+    }
+    record( "to_string", 1, cells, [&] {
+      sink += std::strlen( (const char *) maze );
+    } );
+
+    /* solvers - each op answers one start to center query from scratch */
+    if( wanted("flood_fill") ) {
+      MazeFloodFill flood( maze, { goal } );
+      record( "flood_fill", 1, cells, [&] {
+        flood.setGoals( { goal } );
+        flood.step( INT_MAX );
+        sink += flood.getDistance( start );
+      } );
+    }
+    record( "goal_table", 1, cells, [&] {
+      sink += maze.goalDistance( maze.addGoalSet({ goal }), start );
+      maze.clearGoalSets();
+    } );
+    record( "hpa", 1, cells, [&] {
+      MazeHPA hpa( maze );
+      sink += hpa.findPath( start, goal ).size();
+    } );
+    record( "junction_graph", 1, cells, [&] {
+      MazeJunctionGraph graph( maze, { start, goal } );
+      sink += graph.distance( start, goal );
+    } );
+    record( "analytics", 1, cells, [&] {
+      MazeAnalytics analytics( maze, 1 );
+      analytics.analyze( start );
+      sink += analytics.getComponentCount();
+    } );
+    if( wanted("exploration_planner") ) {
+      /* fully sensed map - the planner proves the path from its fields */
+      Maze map( side, side );
+      MazeExplorationPlanner planner( map, { map.at(side / 2, side / 2) },
+        map.at(side - 1, 0) );
+      for( MazeCell * cell : maze ) {
+        int walls = ( cell->up == nullptr ) * Maze::WALL_UP |
+                    ( cell->right == nullptr ) * Maze::WALL_RIGHT |
+                    ( cell->down == nullptr ) * Maze::WALL_DOWN |
+                    ( cell->left == nullptr ) * Maze::WALL_LEFT;
+        planner.sense( map.at(cell->row, cell->column), walls );
+      }
+      record( "exploration_planner", 1, cells, [&] {
+        planner.wallsChanged( map, nullptr, 0 );
+        sink += planner.isProven();
+      } );
+    }
+    if( side == 16 && wanted("static_flood_fill") ) {
+      StaticMaze<16, 16> fixed;
+      for( MazeCell * cell : maze ) {
+        int walls = ( cell->up == nullptr ) * Maze::WALL_UP |
+                    ( cell->right == nullptr ) * Maze::WALL_RIGHT |
+                    ( cell->down == nullptr ) * Maze::WALL_DOWN |
+                    ( cell->left == nullptr ) * Maze::WALL_LEFT;
+        fixed.applyWalls( StaticCell(cell->row, cell->column), walls );
+      }
+      StaticFloodFill<16, 16> flood;
+      const StaticCell center( side / 2, side / 2 );
+      record( "static_flood_fill", 1, cells, [&] {
+        sink += flood.run( fixed, &center, 1 );
+      } );
+    }
+  }
+  std::remove( file_template );
+
+  const char separator = ( format == "csv" ) ? ',' : '\t';
+  if( format == "json" ) std::cout << "[";
+  else {
+    std::cout << "label" << separator << "side" << separator << "operation" << separator
+              << "iterations" << separator << "ns_per_op" << separator << "cells_per_s"
+              << separator << "bytes_per_op" << separator << "peak_rss_kb" << "\n";
+  }
+  for( size_t index = 0; index < records.size(); index++ ) {
+    const BenchmarkRecord & record = records[ index ];
+    if( format == "json" ) {
+      std::cout << ( index ? ",\n " : "\n " ) << "{\"label\": \"" << label
+                << "\", \"side\": " << record.side << ", \"operation\": \""
+                << record.operation << "\", \"iterations\": " << record.iterations
+                << ", \"ns_per_op\": " << record.ns_per_op << ", \"cells_per_s\": "
+                << record.cells_per_second << ", \"bytes_per_op\": " << record.bytes_per_op
+                << ", \"peak_rss_kb\": " << record.peak_rss_kb << "}";
+      continue;
+    }
+    std::cout << label << separator << record.side << separator << record.operation
+              << separator << record.iterations << separator << record.ns_per_op
+              << separator << record.cells_per_second << separator << record.bytes_per_op
+              << separator << record.peak_rss_kb << "\n";
+  }
+  if( format == "json" ) std::cout << "\n]\n";
+  return 0;
+}
+
+/*******************************************************************************
+% Routine Name: measure
+% File:         MazeBenchmark.cpp
+% Parameters:   side         - side of the maze.
+%               operation    - name of the operation.
+%               ops_per_call - operations one call of the body performs.
+%               cells_per_op - cells one operation covers.
+%               min_time     - seconds to keep repeating the body.
+%               body         - performs the operations.
+% Description:  Calls the body once to warm up, then repeatedly, doubling
+%               the batch, until the minimum time has passed.
+% Return:       The measured record.
+*******************************************************************************/
+BenchmarkRecord MazeBenchmarkHelper::measure( int side, const std::string & operation,
+  long ops_per_call, double cells_per_op, double min_time,
+  const std::function<void()> & body ) {
+
+  body();
+  long calls = 0;
+  double seconds = 0.0;
+  unsigned long long bytes = 0;
+  for( long batch = 1; seconds < min_time || calls == 0; batch *= 2 ) {
+    const unsigned long long bytes_before = allocated_bytes;
+    auto start = std::chrono::steady_clock::now();
+    for( long call = 0; call < batch; call++ ) body();
+    auto stop = std::chrono::steady_clock::now();
+    bytes += allocated_bytes - bytes_before;
+    seconds += std::chrono::duration<double>( stop - start ).count();
+    calls += batch;
+  }
+  const double ops = (double)calls * ops_per_call;
+  BenchmarkRecord record;
+  record.side = side;
+  record.operation = operation;
+  record.iterations = calls * ops_per_call;
+  record.ns_per_op = seconds * 1e9 / ops;
+  record.cells_per_second = ops * cells_per_op / seconds;
+  record.bytes_per_op = bytes / ops;
+  record.peak_rss_kb = peakRSS();
+  return record;
+}
+
+/*******************************************************************************
+% Routine Name: randomPassages
+% File:         MazeBenchmark.cpp
+% Parameters:   maze - maze to fill.
+%               seed - random seed.
+% Description:  Opens about 3 in 4 passages at random in one bulk update, so
+%               even the largest mazes are built in seconds.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeBenchmarkHelper::randomPassages( Maze & maze, unsigned seed ) {
+  std::mt19937_64 generator( seed );
+  std::vector<uint64_t> right( maze.getRightPlane().size() );
+  std::vector<uint64_t> down( maze.getDownPlane().size() );
+  for( size_t word = 0; word < right.size(); word++ ) {
+    right[ word ] = generator() | generator();
+    down[ word ] = generator() | generator();
+  }
+  maze.setPassagePlanes( right, down );
+}
+
+/*******************************************************************************
+% Routine Name: parseList
+% File:         MazeBenchmark.cpp
+% Parameters:   text - comma separated numbers.
+% Description:  Parses the list of maze sides.
+% Return:       The numbers, with 0 for anything unparsable.
+*******************************************************************************/
+std::vector<int> MazeBenchmarkHelper::parseList( const std::string & text ) {
+  std::vector<int> numbers;
+  for( size_t begin = 0, end; begin <= text.size(); begin = end + 1 ) {
+    end = std::min( text.find(',', begin), text.size() );
+    numbers.push_back( std::atoi(text.substr(begin, end - begin).c_str()) );
+  }
+  return numbers;
+}
+
+/*******************************************************************************
+% Routine Name: quietly
+% File:         MazeBenchmark.cpp
+% Parameters:   call - library call that reports progress on std::cerr.
+% Description:  Runs a call with std::cerr silenced, then restores the stream
+%               and its state, so that the progress of the benchmark itself
+%               still prints.
+% Return:       The result of the call.
+*******************************************************************************/
+bool MazeBenchmarkHelper::quietly( const std::function<bool()> & call ) {
+  std::streambuf * buffer = std::cerr.rdbuf( nullptr );
+  const bool result = call();
+  std::cerr.rdbuf( buffer );
+  std::cerr.clear();
+  return result;
+}
+
+/*******************************************************************************
+% Routine Name: peakRSS
+% File:         MazeBenchmark.cpp
+% Parameters:   None.
+% Description:  Reads the high water mark of the resident set of the process.
+% Return:       Peak resident set size in kilobytes.
+*******************************************************************************/
+long MazeBenchmarkHelper::peakRSS() {
+  struct rusage usage;
+  getrusage( RUSAGE_SELF, &usage );
+  return usage.ru_maxrss;
+}
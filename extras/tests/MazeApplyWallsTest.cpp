@@ -0,0 +1,300 @@
+/*******************************************************************************
+                                                    Jose Jorge Jimenez-Olivas
+                                                    Brandon Cramer
+
+                 University of California, San Diego
+                           IEEE Micromouse
+
+File Name:       MazeApplyWallsTest.cpp
+Description:     Regression check of the batch wall updates. Every sensor
+                 reading and block import must leave the maze equal to one
+                 built wall by wall, return the number of walls it changed
+                 and notify listeners once. Readings outside the maze, open
+                 boundaries and blocks that disagree with themselves must be
+                 refused with their error code and change nothing.
+
+Build:           g++ -std=c++11 -O2 -I../.. MazeApplyWallsTest.cpp -o maze_apply_walls_test
+Usage:           maze_apply_walls_test
+Output:          One line per failed check, then a summary. Exits with 1 if
+                 any check failed.
+*******************************************************************************/
+#include "Maze.h"
+#include <random>
+
+/* Counts the notifications of a maze */
+class MazeApplyWallsTestListener : public MazeListener {
+public:
+  int batches = 0;
+  int changes = 0;
+  void wallChanged( MazeCell *, MazeCell * ) override {}
+  void wallsChanged( Maze &, const WallChange *, int count ) override {
+    batches++;
+    changes += count;
+  }
+};
+
+/* Helper Functions */
+namespace MazeApplyWallsTestHelper {
+  void randomWalls( Maze & maze, std::mt19937 & random );
+  void setWall( Maze & maze, MazeCell * cell, MazeCell * neighbor, bool wall );
+  int wallMask( Maze & maze, int row, int column );
+  int differingWalls( Maze & maze_A, Maze & maze_B );
+  bool expect( bool condition, const char * what, Maze & maze );
+}
+
+/*******************************************************************************
+% Routine Name: main
+% File:         MazeApplyWallsTest.cpp
+% Parameters:   None.
+% Description:  Applies random sensor readings and blocks of wall masks to
+%               random mazes, then every kind of invalid one.
+% Return:       0 if every check passed, 1 otherwise.
+*******************************************************************************/
+int main() {
+  int checks = 0;
+  int failures = 0;
+  std::mt19937 random( 17 );
+
+  /* single readings against the same walls set one by one */
+  for( int trial = 0; trial < 20; trial++ ) {
+    const int width = 1 + random() % 40;
+    const int height = 1 + random() % 40;
+    Maze maze( width, height );
+    MazeApplyWallsTestHelper::randomWalls( maze, random );
+    MazeApplyWallsTestListener listener;
+    maze.addListener( &listener );
+    for( int reading = 0; reading < 100; reading++ ) {
+      const int row = random() % height;
+      const int column = random() % width;
+      const int sensed = random() & Maze::ALL_SIDES;
+      MazeCell * cell = maze.at( row, column );
+      MazeCell * neighbors[ 4 ] = { maze.at(row - 1, column), maze.at(row, column + 1),
+                                    maze.at(row + 1, column), maze.at(row, column - 1) };
+      /* openings are only reported where there is a neighbor */
+      int walls = random() & Maze::ALL_SIDES;
+      for( int side = 0; side < 4; side++ ) {
+        if( neighbors[ side ] == nullptr ) walls |= 1 << side;
+      }
+      Maze expected( maze );
+      for( int side = 0; side < 4; side++ ) {
+        if( !(sensed >> side & 1) || neighbors[ side ] == nullptr ) continue;
+        MazeApplyWallsTestHelper::setWall( expected, expected.at(row, column),
+          expected.at(neighbors[ side ]->row, neighbors[ side ]->column), walls >> side & 1 );
+      }
+      const int changed = MazeApplyWallsTestHelper::differingWalls( maze, expected );
+      const int batches = listener.batches;
+      const int result = maze.applyWalls( cell, walls, sensed );
+      checks += 3;
+      if( !MazeApplyWallsTestHelper::expect(maze == expected && maze.getHash() ==
+            expected.getHash(), "reading differs from single walls", maze) ) {
+        failures++;
+      }
+      if( !MazeApplyWallsTestHelper::expect(result == changed, "reading count", maze) ) {
+        failures++;
+      }
+      if( !MazeApplyWallsTestHelper::expect(listener.batches == batches + (changed > 0),
+            "reading notifications", maze) ) {
+        failures++;
+      }
+    }
+    maze.removeListener( &listener );
+  }
+
+  /* blocks of wall masks taken from another maze */
+  for( int trial = 0; trial < 40; trial++ ) {
+    const int width = 1 + random() % 40;
+    const int height = 1 + random() % 40;
+    Maze source( width, height );
+    Maze maze( width, height );
+    MazeApplyWallsTestHelper::randomWalls( source, random );
+    MazeApplyWallsTestHelper::randomWalls( maze, random );
+    const int first_row = random() % height;
+    const int first_column = random() % width;
+    const int rows = 1 + random() % ( height - first_row );
+    const int columns = 1 + random() % ( width - first_column );
+    std::vector<uint8_t> walls;
+    Maze expected( maze );
+    for( int row = first_row; row < first_row + rows; row++ ) {
+      for( int column = first_column; column < first_column + columns; column++ ) {
+        walls.push_back( MazeApplyWallsTestHelper::wallMask(source, row, column) );
+        MazeCell * cell = source.at( row, column );
+        for( MazeCell * neighbor : source.getAdjacentCellList(cell) ) {
+          MazeApplyWallsTestHelper::setWall( expected, expected.at(row, column),
+            expected.at(neighbor->row, neighbor->column), source.wallBetween(cell, neighbor) );
+        }
+      }
+    }
+    const int changed = MazeApplyWallsTestHelper::differingWalls( maze, expected );
+    MazeApplyWallsTestListener listener;
+    maze.addListener( &listener );
+    const int result = maze.applyWalls( first_row, first_column, rows, columns, walls.data() );
+    checks += 3;
+    if( !MazeApplyWallsTestHelper::expect(maze == expected && maze.getHash() ==
+          expected.getHash(), "block differs from single walls", maze) ) {
+      failures++;
+    }
+    if( !MazeApplyWallsTestHelper::expect(result == changed, "block count", maze) ) {
+      failures++;
+    }
+    if( !MazeApplyWallsTestHelper::expect(listener.batches == (changed > 0) &&
+          listener.changes == changed, "block notifications", maze) ) {
+      failures++;
+    }
+    maze.removeListener( &listener );
+  }
+
+  /* invalid readings and blocks are refused and change nothing */
+  for( int trial = 0; trial < 20; trial++ ) {
+    const int width = 2 + random() % 30;
+    const int height = 2 + random() % 30;
+    Maze maze( width, height );
+    Maze other( width, height );
+    MazeApplyWallsTestHelper::randomWalls( maze, random );
+    const Maze before( maze );
+    MazeApplyWallsTestListener listener;
+    maze.addListener( &listener );
+    std::vector<uint8_t> walls;
+    for( int row = 0; row < height; row++ ) {
+      for( int column = 0; column < width; column++ ) {
+        walls.push_back( MazeApplyWallsTestHelper::wallMask(maze, row, column) );
+      }
+    }
+    std::vector<uint8_t> inconsistent( walls );
+    inconsistent[ random() % width ] ^= Maze::WALL_DOWN;
+    std::vector<uint8_t> open_boundary( walls );
+    open_boundary[ (height - 1) * width + random() % width ] &= ~Maze::WALL_DOWN;
+
+    const int row = random() % height;
+    checks += 10;
+    if( !MazeApplyWallsTestHelper::expect(maze.applyWalls(nullptr, 0) == Maze::INVALID_CELL,
+          "reading of no cell", maze) ) {
+      failures++;
+    }
+    if( !MazeApplyWallsTestHelper::expect(maze.applyWalls(other.at(0, 0), 0) ==
+          Maze::INVALID_CELL, "reading of a cell of another maze", maze) ) {
+      failures++;
+    }
+    if( !MazeApplyWallsTestHelper::expect(maze.applyWalls(maze.at(row, width - 1),
+          Maze::WALL_UP | Maze::WALL_DOWN) == Maze::OPEN_BOUNDARY, "open boundary reading", maze) ) {
+      failures++;
+    }
+    maze.applyWalls( 0, 0, height, width, walls.data() );
+    if( !MazeApplyWallsTestHelper::expect(maze.applyWalls(0, 0, height, width + 1,
+          walls.data()) == Maze::INVALID_CELL, "block wider than the maze", maze) ) {
+      failures++;
+    }
+    if( !MazeApplyWallsTestHelper::expect(maze.applyWalls(-1, 0, 1, 1, walls.data()) ==
+          Maze::INVALID_CELL, "block above the maze", maze) ) {
+      failures++;
+    }
+    if( !MazeApplyWallsTestHelper::expect(maze.applyWalls(0, 0, 1, 1, nullptr) ==
+          Maze::INVALID_CELL, "block of no masks", maze) ) {
+      failures++;
+    }
+    if( !MazeApplyWallsTestHelper::expect(maze.applyWalls(0, 0, height, width,
+          inconsistent.data()) == Maze::INCONSISTENT_WALLS, "inconsistent block", maze) ) {
+      failures++;
+    }
+    if( !MazeApplyWallsTestHelper::expect(maze.applyWalls(0, 0, height, width,
+          open_boundary.data()) == Maze::OPEN_BOUNDARY, "open boundary block", maze) ) {
+      failures++;
+    }
+    if( !MazeApplyWallsTestHelper::expect(maze == before && maze.getHash() == before.getHash()
+          && listener.batches == 0, "refused update changed the maze", maze) ) {
+      failures++;
+    }
+    /* an opening only counts against the boundary on a sensed side */
+    if( !MazeApplyWallsTestHelper::expect(maze.applyWalls(maze.at(row, width - 1), 0,
+          Maze::WALL_LEFT) >= 0, "unsensed boundary", maze) ) {
+      failures++;
+    }
+    maze.removeListener( &listener );
+  }
+
+  std::cout << checks << " checks, " << failures << " failed" << std::endl;
+  return failures ? 1 : 0;
+}
+
+/*******************************************************************************
+% Routine Name: randomWalls
+% File:         MazeApplyWallsTest.cpp
+% Parameters:   maze   - maze with every wall up.
+%               random - source of the passages.
+% Description:  Opens about half of the passages of the maze.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeApplyWallsTestHelper::randomWalls( Maze & maze, std::mt19937 & random ) {
+  for( int row = 0; row < maze.getHeight(); row++ ) {
+    for( int column = 0; column < maze.getWidth(); column++ ) {
+      if( random() & 1 ) maze.removeWall( maze.at(row, column), maze.at(row, column + 1) );
+      if( random() & 1 ) maze.removeWall( maze.at(row, column), maze.at(row + 1, column) );
+    }
+  }
+}
+
+/*******************************************************************************
+% Routine Name: setWall
+% File:         MazeApplyWallsTest.cpp
+% Parameters:   maze     - the maze.
+%               cell     - a cell in the maze.
+%               neighbor - a neighbor of the cell.
+%               wall     - true for a wall, false for a passage.
+% Description:  Adds or removes the wall between two cells.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeApplyWallsTestHelper::setWall( Maze & maze, MazeCell * cell, MazeCell * neighbor,
+  bool wall ) {
+
+  if( wall ) maze.addWall( cell, neighbor );
+  else maze.removeWall( cell, neighbor );
+}
+
+/*******************************************************************************
+% Routine Name: wallMask
+% File:         MazeApplyWallsTest.cpp
+% Parameters:   maze   - the maze.
+%               row    - row of a cell.
+%               column - column of the cell.
+% Description:  Builds the wall mask of a cell, with the maze boundary walled.
+% Return:       Mask of WALL_UP, WALL_RIGHT, WALL_DOWN and WALL_LEFT.
+*******************************************************************************/
+int MazeApplyWallsTestHelper::wallMask( Maze & maze, int row, int column ) {
+  MazeCell * cell = maze.at( row, column );
+  MazeCell * neighbors[ 4 ] = { maze.at(row - 1, column), maze.at(row, column + 1),
+                                maze.at(row + 1, column), maze.at(row, column - 1) };
+  int mask = 0;
+  for( int side = 0; side < 4; side++ ) {
+    if( neighbors[ side ] == nullptr || maze.wallBetween(cell, neighbors[ side ]) ) {
+      mask |= 1 << side;
+    }
+  }
+  return mask;
+}
+
+/*******************************************************************************
+% Routine Name: differingWalls
+% File:         MazeApplyWallsTest.cpp
+% Parameters:   maze_A - a maze.
+%               maze_B - a maze of the same dimensions.
+% Description:  Counts the passages open in one maze and walled in the other.
+% Return:       Number of differing walls.
+*******************************************************************************/
+int MazeApplyWallsTestHelper::differingWalls( Maze & maze_A, Maze & maze_B ) {
+  return Maze::diff( maze_A, maze_B ).size();
+}
+
+/*******************************************************************************
+% Routine Name: expect
+% File:         MazeApplyWallsTest.cpp
+% Parameters:   condition - result of the check.
+%               what      - description of the failure.
+%               maze      - maze checked.
+% Description:  Reports a failed check.
+% Return:       The condition.
+*******************************************************************************/
+bool MazeApplyWallsTestHelper::expect( bool condition, const char * what, Maze & maze ) {
+  if( !condition ) {
+    std::cout << maze.getWidth() << "x" << maze.getHeight() << ": " << what << std::endl;
+  }
+  return condition;
+}
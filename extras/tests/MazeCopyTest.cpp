@@ -0,0 +1,232 @@
+/*******************************************************************************
+                                                    Jose Jorge Jimenez-Olivas
+                                                    Brandon Cramer
+
+                 University of California, San Diego
+                           IEEE Micromouse
+
+File Name:       MazeCopyTest.cpp
+Description:     Regression check of maze copies, moves and snapshots. A copy
+                 must equal its original, link only its own cells, carry the
+                 search data and goal tables over, and stay independent of it
+                 afterwards. A move must keep the cell addresses and leave the
+                 source empty. A snapshot must keep the walls it was taken of
+                 and share the row blocks that did not change since.
+
+Build:           g++ -std=c++11 -O2 -I../.. MazeCopyTest.cpp -o maze_copy_test
+Usage:           maze_copy_test
+Output:          One line per failed check, then a summary. Exits with 1 if
+                 any check failed.
+*******************************************************************************/
+#include "Maze.h"
+#include <random>
+
+/* Helper Functions */
+namespace MazeCopyTestHelper {
+  void flipWall( Maze & maze, std::mt19937 & random );
+  bool ownLinks( Maze & maze );
+  bool sameWalls( Maze & maze, const MazeSnapshot & snapshot );
+  bool expect( bool condition, const char * what, Maze & maze );
+}
+
+/*******************************************************************************
+% Routine Name: main
+% File:         MazeCopyTest.cpp
+% Parameters:   None.
+% Description:  Copies, assigns, moves and snapshots random mazes, changing
+%               the walls on either side afterwards.
+% Return:       0 if every check passed, 1 otherwise.
+*******************************************************************************/
+int main() {
+  int checks = 0;
+  int failures = 0;
+  std::mt19937 random( 13 );
+
+  for( int trial = 0; trial < 20; trial++ ) {
+    const int width = 1 + random() % 70;
+    const int height = 1 + random() % 40;
+    Maze maze( width, height );
+    for( int flip = 0; flip < width * height; flip++ ) {
+      MazeCopyTestHelper::flipWall( maze, random );
+    }
+    maze.at( 0, 0 )->setDistance( 7 );
+    maze.at( 0, 0 )->setVisited( true );
+    maze.at( height - 1, width - 1 )->prev = maze.at( 0, 0 );
+    std::vector<MazeCell *> goals( 1, maze.at(height / 2, width / 2) );
+    const int goal_set = maze.addGoalSet( goals );
+    const int goal_distance = maze.goalDistance( goal_set, 0, 0 );
+
+    /* copies equal the original, with their own links and search data */
+    Maze copy( maze );
+    Maze assigned( 1, 1 );
+    assigned = maze;
+    checks += 5;
+    if( !MazeCopyTestHelper::expect(copy == maze && assigned == maze &&
+          copy.getHash() == maze.getHash(), "copy differs", maze) ) {
+      failures++;
+    }
+    if( !MazeCopyTestHelper::expect(MazeCopyTestHelper::ownLinks(copy) &&
+          MazeCopyTestHelper::ownLinks(assigned), "copy links into another maze", maze) ) {
+      failures++;
+    }
+    MazeCell * corner = copy.at( height - 1, width - 1 );
+    if( !MazeCopyTestHelper::expect(copy.at(0, 0)->getDistance() == 7 &&
+          copy.at(0, 0)->getVisited() && corner->prev == copy.at(0, 0),
+          "search data not copied", maze) ) {
+      failures++;
+    }
+    if( !MazeCopyTestHelper::expect(copy.goalDistance(goal_set, 0, 0) == goal_distance,
+                                    "goal table not copied", maze) ) {
+      failures++;
+    }
+
+    /* changes to a copy never reach the original, nor the other way */
+    const uint64_t hash = maze.getHash();
+    MazeSnapshot snapshot = maze.snapshot();
+    for( int flip = 0; flip < 10; flip++ ) MazeCopyTestHelper::flipWall( copy, random );
+    for( int flip = 0; flip < 10; flip++ ) MazeCopyTestHelper::flipWall( assigned, random );
+    if( !MazeCopyTestHelper::expect(maze.getHash() == hash &&
+          MazeCopyTestHelper::sameWalls(maze, snapshot), "original changed by a copy", maze) ) {
+      failures++;
+    }
+    Maze kept( maze );
+    for( int flip = 0; flip < 10; flip++ ) MazeCopyTestHelper::flipWall( maze, random );
+    checks += 2;
+    if( !MazeCopyTestHelper::expect(MazeCopyTestHelper::sameWalls(kept, snapshot) &&
+          kept.getHash() == hash, "copy changed by the original", maze) ) {
+      failures++;
+    }
+    if( !MazeCopyTestHelper::expect(Maze(snapshot) == kept && snapshot.getHash() == hash,
+                                    "snapshot changed by the original", maze) ) {
+      failures++;
+    }
+
+    /* a snapshot shares the row blocks that did not change */
+    MazeSnapshot before = maze.snapshot();
+    MazeCell * cell = maze.at( 0, 0 );
+    if( width > 1 ) {
+      if( maze.wallBetween(cell, maze.at(0, 1)) ) maze.removeWall( cell, maze.at(0, 1) );
+      else maze.addWall( cell, maze.at(0, 1) );
+    }
+    MazeSnapshot after = maze.snapshot();
+    const int blocks = ( height + MazeSnapshot::BLOCK_ROWS - 1 ) / MazeSnapshot::BLOCK_ROWS;
+    checks += 2;
+    if( !MazeCopyTestHelper::expect(before.sharedBlocks(after) == blocks - (width > 1),
+                                    "unchanged row blocks not shared", maze) ) {
+      failures++;
+    }
+    if( !MazeCopyTestHelper::expect(MazeCopyTestHelper::sameWalls(maze, after),
+                                    "snapshot differs", maze) ) {
+      failures++;
+    }
+
+    /* moves keep the cells and leave the source empty */
+    MazeCell * first = maze.at( 0, 0 );
+    Maze expected( maze );
+    Maze moved( std::move(maze) );
+    checks += 3;
+    if( !MazeCopyTestHelper::expect(moved == expected && moved.at(0, 0) == first &&
+          MazeCopyTestHelper::ownLinks(moved), "move constructed maze differs", moved) ) {
+      failures++;
+    }
+    Maze target( 2, 2 );
+    target = std::move( moved );
+    if( !MazeCopyTestHelper::expect(target == expected && target.at(0, 0) == first,
+                                    "move assigned maze differs", target) ) {
+      failures++;
+    }
+    if( !MazeCopyTestHelper::expect(maze.getWidth() == 0 && maze.getHeight() == 0 &&
+          moved.getWidth() == 0 && moved.getHeight() == 0 && maze.begin() == maze.end(),
+          "moved from maze not empty", target) ) {
+      failures++;
+    }
+
+    /* a copy of a cleared maze has no passage to bring back */
+    target.clear();
+    Maze cleared( target );
+    Maze walled( width, height );
+    checks++;
+    if( !MazeCopyTestHelper::expect(cleared == walled && target == walled &&
+          cleared.getHash() == walled.getHash() &&
+          Maze::diff(cleared, walled).empty(), "copy of a cleared maze", target) ) {
+      failures++;
+    }
+  }
+
+  std::cout << checks << " checks, " << failures << " failed" << std::endl;
+  return failures ? 1 : 0;
+}
+
+/*******************************************************************************
+% Routine Name: flipWall
+% File:         MazeCopyTest.cpp
+% Parameters:   maze   - the maze.
+%               random - source of the wall to flip.
+% Description:  Adds or removes the wall right of or below a random cell.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeCopyTestHelper::flipWall( Maze & maze, std::mt19937 & random ) {
+  MazeCell * cell = maze.at( random() % maze.getHeight(), random() % maze.getWidth() );
+  MazeCell * neighbor = ( random() & 1 ) ? maze.at( cell->row, cell->column + 1 )
+                                         : maze.at( cell->row + 1, cell->column );
+  if( neighbor == nullptr ) return;
+  if( maze.wallBetween(cell, neighbor) ) maze.removeWall( cell, neighbor );
+  else maze.addWall( cell, neighbor );
+}
+
+/*******************************************************************************
+% Routine Name: ownLinks
+% File:         MazeCopyTest.cpp
+% Parameters:   maze - the maze.
+% Description:  Checks that every neighbor link of every cell points to the
+%               cell of this maze at the neighboring location.
+% Return:       True if no link leaves the maze.
+*******************************************************************************/
+bool MazeCopyTestHelper::ownLinks( Maze & maze ) {
+  for( MazeCell * cell : maze ) {
+    MazeCell * links[ 4 ] = { cell->up, cell->right, cell->down, cell->left };
+    for( MazeCell * link : links ) {
+      if( link != nullptr && maze.at(link->row, link->column) != link ) return false;
+    }
+  }
+  return true;
+}
+
+/*******************************************************************************
+% Routine Name: sameWalls
+% File:         MazeCopyTest.cpp
+% Parameters:   maze     - the maze.
+%               snapshot - snapshot of a maze of the same dimensions.
+% Description:  Compares the walls of a maze with those of a snapshot.
+% Return:       True if every wall matches.
+*******************************************************************************/
+bool MazeCopyTestHelper::sameWalls( Maze & maze, const MazeSnapshot & snapshot ) {
+  if( maze.getWidth() != snapshot.getWidth() || maze.getHeight() != snapshot.getHeight() ) {
+    return false;
+  }
+  for( MazeCell * cell : maze ) {
+    for( MazeCell * neighbor : maze.getAdjacentCellList(cell) ) {
+      if( maze.wallBetween(cell, neighbor) != snapshot.wallBetween(cell->row, cell->column,
+            neighbor->row, neighbor->column) ) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/*******************************************************************************
+% Routine Name: expect
+% File:         MazeCopyTest.cpp
+% Parameters:   condition - result of the check.
+%               what      - description of the failure.
+%               maze      - maze checked.
+% Description:  Reports a failed check.
+% Return:       The condition.
+*******************************************************************************/
+bool MazeCopyTestHelper::expect( bool condition, const char * what, Maze & maze ) {
+  if( !condition ) {
+    std::cout << maze.getWidth() << "x" << maze.getHeight() << ": " << what << std::endl;
+  }
+  return condition;
+}
@@ -0,0 +1,218 @@
+/*******************************************************************************
+                                                    Jose Jorge Jimenez-Olivas
+                                                    Brandon Cramer
+
+                 University of California, San Diego
+                           IEEE Micromouse
+
+File Name:       MazeFormatsTest.cpp
+Description:     Regression check of the text and .maz importers and
+                 exporters. Every drawing and .maz file written from a random
+                 maze must read back into an equal maze and be written again
+                 byte for byte, in memory and through files, and input of the
+                 wrong dimensions must be refused without touching the maze.
+
+Build:           g++ -std=c++11 -O2 -I../.. MazeFormatsTest.cpp -o maze_formats_test
+Usage:           maze_formats_test
+Output:          One line per failed check, then a summary. Exits with 1 if
+                 any check failed.
+*******************************************************************************/
+#include "MazeFormats.h"
+#include <random>
+#include <cstdio>
+
+/* Helper Functions */
+namespace MazeFormatsTestHelper {
+  void randomWalls( Maze & maze, std::mt19937 & random );
+  std::string fileBytes( const char * filename );
+  bool expect( bool condition, const char * what, Maze & maze );
+}
+
+/*******************************************************************************
+% Routine Name: main
+% File:         MazeFormatsTest.cpp
+% Parameters:   None.
+% Description:  Round-trips random mazes through both text styles and .maz,
+%               then checks a hand-drawn maze and input of other dimensions.
+% Return:       0 if every check passed, 1 otherwise.
+*******************************************************************************/
+int main() {
+  const char * text_file = "maze_formats_test.txt";
+  const char * maz_file = "maze_formats_test.maz";
+  const MazeFormats::TextStyle styles[] = { MazeFormats::POSTS, MazeFormats::DRAWING };
+  int checks = 0;
+  int failures = 0;
+  std::mt19937 random( 19 );
+
+  for( int trial = 0; trial < 40; trial++ ) {
+    const int width = 1 + random() % 40;
+    const int height = ( trial % 2 ) ? width : 1 + random() % 40;
+    Maze maze( width, height );
+    MazeFormatsTestHelper::randomWalls( maze, random );
+
+    /* both text styles, in memory */
+    for( MazeFormats::TextStyle style : styles ) {
+      const std::string text = MazeFormats::writeText( maze, style );
+      int read_width = 0;
+      int read_height = 0;
+      Maze read( width, height );
+      const bool dimensions = MazeFormats::textDimensions( text.data(), text.size(),
+                                                           read_width, read_height );
+      checks += 3;
+      if( !MazeFormatsTestHelper::expect(dimensions && read_width == width &&
+            read_height == height, "text dimensions", maze) ) {
+        failures++;
+      }
+      if( !MazeFormatsTestHelper::expect(MazeFormats::readText(text.data(), text.size(), read)
+            && read == maze, "text read back differs", maze) ) {
+        failures++;
+      }
+      if( !MazeFormatsTestHelper::expect(MazeFormats::writeText(read, style) == text,
+            "text written again differs", maze) ) {
+        failures++;
+      }
+    }
+
+    /* text through a file */
+    Maze loaded( width, height );
+    int file_width = 0;
+    int file_height = 0;
+    checks += 2;
+    if( !MazeFormatsTestHelper::expect(MazeFormats::save(text_file, maze) &&
+          MazeFormatsTestHelper::fileBytes(text_file) == MazeFormats::writeText(maze),
+          "text file differs", maze) ) {
+      failures++;
+    }
+    if( !MazeFormatsTestHelper::expect(MazeFormats::fileDimensions(text_file, file_width,
+          file_height) && file_width == width && file_height == height &&
+          MazeFormats::load(text_file, loaded) && loaded == maze, "text file read back", maze) ) {
+      failures++;
+    }
+
+    /* .maz holds square mazes only */
+    const std::vector<uint8_t> maz = MazeFormats::writeMaz( maze );
+    checks++;
+    if( width != height ) {
+      if( !MazeFormatsTestHelper::expect(maz.empty() && !MazeFormats::save(maz_file, maze),
+            "maz of a maze not square", maze) ) {
+        failures++;
+      }
+      continue;
+    }
+    if( !MazeFormatsTestHelper::expect(maz.size() == (size_t)width * width &&
+          MazeFormats::mazDimensions(maz.size(), file_width, file_height) &&
+          file_width == width && file_height == width, "maz dimensions", maze) ) {
+      failures++;
+    }
+    Maze read( width, width );
+    Maze file_read( width, width );
+    checks += 4;
+    if( !MazeFormatsTestHelper::expect(MazeFormats::readMaz(maz.data(), maz.size(), read) &&
+          read == maze, "maz read back differs", maze) ) {
+      failures++;
+    }
+    if( !MazeFormatsTestHelper::expect(MazeFormats::writeMaz(read) == maz,
+          "maz written again differs", maze) ) {
+      failures++;
+    }
+    const std::string maz_bytes( maz.begin(), maz.end() );
+    if( !MazeFormatsTestHelper::expect(MazeFormats::save(maz_file, maze) &&
+          MazeFormatsTestHelper::fileBytes(maz_file) == maz_bytes, "maz file differs", maze) ) {
+      failures++;
+    }
+    if( !MazeFormatsTestHelper::expect(MazeFormats::load(maz_file, file_read) &&
+          file_read == maze, "maz file read back", maze) ) {
+      failures++;
+    }
+  }
+  std::remove( text_file );
+  std::remove( maz_file );
+
+  /* a drawing in the layout of the public collections, byte for byte */
+  const std::string drawn =
+    "o---o---o---o\n"
+    "|       |   |\n"
+    "o   o---o   o\n"
+    "|           |\n"
+    "o---o---o---o\n";
+  Maze maze( 3, 2 );
+  checks += 2;
+  if( !MazeFormatsTestHelper::expect(MazeFormats::readText(drawn.data(), drawn.size(), maze) &&
+        !maze.wallBetween(maze.at(0, 0), maze.at(0, 1)) &&
+        maze.wallBetween(maze.at(0, 1), maze.at(0, 2)) &&
+        !maze.wallBetween(maze.at(0, 0), maze.at(1, 0)) &&
+        maze.wallBetween(maze.at(0, 1), maze.at(1, 1)), "hand-drawn maze walls", maze) ) {
+    failures++;
+  }
+  if( !MazeFormatsTestHelper::expect(MazeFormats::writeText(maze) == drawn,
+        "hand-drawn maze written again", maze) ) {
+    failures++;
+  }
+
+  /* input of other dimensions is refused and leaves the maze as it was */
+  const Maze before( maze );
+  Maze square( 4, 4 );
+  const std::string other_text = MazeFormats::writeText( square );
+  const std::vector<uint8_t> other_maz = MazeFormats::writeMaz( square );
+  checks += 3;
+  if( !MazeFormatsTestHelper::expect(!MazeFormats::readText(other_text.data(),
+        other_text.size(), maze), "text of other dimensions", maze) ) {
+    failures++;
+  }
+  if( !MazeFormatsTestHelper::expect(!MazeFormats::readMaz(other_maz.data(),
+        other_maz.size() - 1, square), "maz of a size not square", square) ) {
+    failures++;
+  }
+  if( !MazeFormatsTestHelper::expect(maze == before, "refused input changed the maze", maze) ) {
+    failures++;
+  }
+
+  std::cout << checks << " checks, " << failures << " failed" << std::endl;
+  return failures ? 1 : 0;
+}
+
+/*******************************************************************************
+% Routine Name: randomWalls
+% File:         MazeFormatsTest.cpp
+% Parameters:   maze   - maze with every wall up.
+%               random - source of the passages.
+% Description:  Opens about half of the passages of the maze.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeFormatsTestHelper::randomWalls( Maze & maze, std::mt19937 & random ) {
+  for( int row = 0; row < maze.getHeight(); row++ ) {
+    for( int column = 0; column < maze.getWidth(); column++ ) {
+      if( random() & 1 ) maze.removeWall( maze.at(row, column), maze.at(row, column + 1) );
+      if( random() & 1 ) maze.removeWall( maze.at(row, column), maze.at(row + 1, column) );
+    }
+  }
+}
+
+/*******************************************************************************
+% Routine Name: fileBytes
+% File:         MazeFormatsTest.cpp
+% Parameters:   filename - file to read.
+% Description:  Reads a whole file.
+% Return:       The bytes of the file.
+*******************************************************************************/
+std::string MazeFormatsTestHelper::fileBytes( const char * filename ) {
+  std::ifstream instream( filename, std::ios::in | std::ios::binary );
+  return std::string( std::istreambuf_iterator<char>(instream),
+                      std::istreambuf_iterator<char>() );
+}
+
+/*******************************************************************************
+% Routine Name: expect
+% File:         MazeFormatsTest.cpp
+% Parameters:   condition - result of the check.
+%               what      - description of the failure.
+%               maze      - maze checked.
+% Description:  Reports a failed check.
+% Return:       The condition.
+*******************************************************************************/
+bool MazeFormatsTestHelper::expect( bool condition, const char * what, Maze & maze ) {
+  if( !condition ) {
+    std::cout << maze.getWidth() << "x" << maze.getHeight() << ": " << what << std::endl;
+  }
+  return condition;
+}
@@ -0,0 +1,209 @@
+/*******************************************************************************
+                                                    Jose Jorge Jimenez-Olivas
+                                                    Brandon Cramer
+
+                 University of California, San Diego
+                           IEEE Micromouse
+
+File Name:       MazeGoalTableTest.cpp
+Description:     Regression check of the goal distance tables. Walls are
+                 flipped at random, and after every flip each table lookup
+                 must match a breadth first search from the goal set - a
+                 table that missed its invalidation shows up as a wrong
+                 distance. Saved tables must load back for the same walls,
+                 and be rebuilt when the walls changed in between.
+
+Build:           g++ -std=c++11 -O2 -I../.. MazeGoalTableTest.cpp -o maze_goal_table_test
+Usage:           maze_goal_table_test
+Output:          One line per failed check, then a summary. Exits with 1 if
+                 any check failed.
+*******************************************************************************/
+#include "Maze.h"
+#include <random>
+#include <queue>
+#include <cstdio>
+
+/* Helper Functions */
+namespace MazeGoalTableTestHelper {
+  std::vector<int> distances( Maze & maze, const std::vector<MazeCell *> & goals );
+  bool sameDistances( Maze & maze, int goal_set, const std::vector<MazeCell *> & goals,
+                      const char * what );
+  void flipWall( Maze & maze, std::mt19937 & random );
+  void copyWalls( Maze & source, Maze & destination );
+}
+
+/*******************************************************************************
+% Routine Name: main
+% File:         MazeGoalTableTest.cpp
+% Parameters:   None.
+% Description:  Checks lookups after random wall flips, then saving and
+%               loading tables of every entry size.
+% Return:       0 if every check passed, 1 otherwise.
+*******************************************************************************/
+int main() {
+  const char * filename = "maze_goal_table_test.tbl";
+  int checks = 0;
+  int failures = 0;
+  std::mt19937 random( 7 );
+
+  /* lookups stay exact across wall flips - 1 and 2 byte entries */
+  for( int trial = 0; trial < 30; trial++ ) {
+    const int width = 2 + random() % 24;
+    const int height = 2 + random() % 24;
+    Maze maze( width, height );
+    maze.clearWalls();
+    std::vector<MazeCell *> center = { maze.at(height / 2, width / 2) };
+    std::vector<MazeCell *> corners = { maze.at(0, 0), maze.at(height - 1, width - 1) };
+    int center_set = maze.addGoalSet( center );
+    int corner_set = maze.addGoalSet( corners );
+    for( int flip = 0; flip < 80; flip++ ) {
+      MazeGoalTableTestHelper::flipWall( maze, random );
+      checks += 2;
+      if( !MazeGoalTableTestHelper::sameDistances(maze, center_set, center, "center") ) {
+        failures++;
+      }
+      if( !MazeGoalTableTestHelper::sameDistances(maze, corner_set, corners, "corners") ) {
+        failures++;
+      }
+    }
+  }
+
+  /* saved tables load back - 1, 2 and 4 byte entries */
+  const int sides[] = { 8, 40, 260 };
+  for( int side : sides ) {
+    Maze maze( side, side );
+    maze.clearWalls();
+    for( int flip = 0; flip < side * side / 2; flip++ ) {
+      MazeGoalTableTestHelper::flipWall( maze, random );
+    }
+    std::vector<MazeCell *> goals = { maze.at(side / 2, side / 2), maze.at(0, side - 1) };
+    maze.addGoalSet( goals );
+    checks += 4;
+    if( !maze.saveGoalTables(filename) ) failures++;
+
+    Maze loaded( side, side );
+    MazeGoalTableTestHelper::copyWalls( maze, loaded );
+    std::vector<MazeCell *> loaded_goals = { loaded.at(side / 2, side / 2),
+                                             loaded.at(0, side - 1) };
+    if( !loaded.loadGoalTables(filename) ) failures++;
+    else if( !MazeGoalTableTestHelper::sameDistances(loaded, 0, loaded_goals, "loaded") ) {
+      failures++;
+    }
+    /* walls changed since the save */
+    for( int flip = 0; flip < side; flip++ ) {
+      MazeGoalTableTestHelper::flipWall( loaded, random );
+    }
+    loaded.loadGoalTables( filename );
+    if( !MazeGoalTableTestHelper::sameDistances(loaded, 0, loaded_goals, "reloaded") ) {
+      failures++;
+    }
+    Maze other( side + 1, side );
+    if( other.loadGoalTables(filename) ) {
+      std::cout << "loaded tables of a " << side << "x" << side << " maze into a "
+                << side + 1 << "x" << side << " maze" << std::endl;
+      failures++;
+    }
+  }
+  std::remove( filename );
+
+  std::cout << checks << " checks, " << failures << " failed" << std::endl;
+  return failures ? 1 : 0;
+}
+
+/*******************************************************************************
+% Routine Name: distances
+% File:         MazeGoalTableTest.cpp
+% Parameters:   maze  - the maze.
+%               goals - cells of a goal set.
+% Description:  Multi-source breadth first search over the open passages.
+% Return:       Row-major distances to the nearest goal, -1 if unreachable.
+*******************************************************************************/
+std::vector<int> MazeGoalTableTestHelper::distances( Maze & maze,
+  const std::vector<MazeCell *> & goals ) {
+
+  std::vector<int> distance( maze.getWidth() * maze.getHeight(), -1 );
+  std::queue<MazeCell *> frontier;
+  for( MazeCell * goal : goals ) {
+    distance[ goal->row * maze.getWidth() + goal->column ] = 0;
+    frontier.push( goal );
+  }
+  while( !frontier.empty() ) {
+    MazeCell * cell = frontier.front();
+    frontier.pop();
+    for( MazeCell * neighbor : maze.getAdjacentCellList(cell) ) {
+      int & next = distance[ neighbor->row * maze.getWidth() + neighbor->column ];
+      if( next >= 0 || maze.wallBetween(cell, neighbor) ) continue;
+      next = distance[ cell->row * maze.getWidth() + cell->column ] + 1;
+      frontier.push( neighbor );
+    }
+  }
+  return distance;
+}
+
+/*******************************************************************************
+% Routine Name: sameDistances
+% File:         MazeGoalTableTest.cpp
+% Parameters:   maze     - the maze.
+%               goal_set - identifier of the goal set in the maze.
+%               goals    - cells of the goal set.
+%               what     - name of the check for the report.
+% Description:  Compares every table lookup of a goal set with a breadth first
+%               search, and reports the first mismatch.
+% Return:       True if every distance matched.
+*******************************************************************************/
+bool MazeGoalTableTestHelper::sameDistances( Maze & maze, int goal_set,
+  const std::vector<MazeCell *> & goals, const char * what ) {
+
+  std::vector<int> expected = distances( maze, goals );
+  for( int row = 0; row < maze.getHeight(); row++ ) {
+    for( int column = 0; column < maze.getWidth(); column++ ) {
+      int found = maze.goalDistance( goal_set, row, column );
+      if( found == expected[ row * maze.getWidth() + column ] ) continue;
+      std::cout << what << ", " << maze.getWidth() << "x" << maze.getHeight()
+                << ": (" << row << "," << column << ") at " << found
+                << ", expected " << expected[ row * maze.getWidth() + column ]
+                << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+/*******************************************************************************
+% Routine Name: flipWall
+% File:         MazeGoalTableTest.cpp
+% Parameters:   maze   - the maze.
+%               random - source of the wall to flip.
+% Description:  Adds or removes the wall right of or below a random cell.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeGoalTableTestHelper::flipWall( Maze & maze, std::mt19937 & random ) {
+  MazeCell * cell = maze.at( random() % maze.getHeight(), random() % maze.getWidth() );
+  MazeCell * neighbor = ( random() & 1 ) ? maze.at( cell->row, cell->column + 1 )
+                                         : maze.at( cell->row + 1, cell->column );
+  if( neighbor == nullptr ) return;
+  if( maze.wallBetween(cell, neighbor) ) maze.removeWall( cell, neighbor );
+  else maze.addWall( cell, neighbor );
+}
+
+/*******************************************************************************
+% Routine Name: copyWalls
+% File:         MazeGoalTableTest.cpp
+% Parameters:   source      - maze to copy the walls of.
+%               destination - maze of the same dimensions.
+% Description:  Makes the walls of destination those of source.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeGoalTableTestHelper::copyWalls( Maze & source, Maze & destination ) {
+  for( int row = 0; row < source.getHeight(); row++ ) {
+    for( int column = 0; column < source.getWidth(); column++ ) {
+      MazeCell * cell = source.at( row, column );
+      for( MazeCell * neighbor : source.getAdjacentCellList(cell) ) {
+        MazeCell * cell_copy = destination.at( row, column );
+        MazeCell * neighbor_copy = destination.at( neighbor->row, neighbor->column );
+        if( source.wallBetween(cell, neighbor) ) destination.addWall( cell_copy, neighbor_copy );
+        else destination.removeWall( cell_copy, neighbor_copy );
+      }
+    }
+  }
+}
@@ -0,0 +1,260 @@
+/*******************************************************************************
+                                                    Jose Jorge Jimenez-Olivas
+                                                    Brandon Cramer
+
+                 University of California, San Diego
+                           IEEE Micromouse
+
+File Name:       MazeHPATest.cpp
+Description:     Regression check of MazeHPA paths. Every path must run from
+                 start to goal through open passages, and be empty exactly when
+                 the goal is unreachable. In perfect mazes, and with single
+                 cell clusters, paths must be shortest; elsewhere HPA* may
+                 detour, but the incrementally updated abstraction must match
+                 one built from scratch after every wall flip.
+
+Build:           g++ -std=c++11 -O2 -I../.. MazeHPATest.cpp -o maze_hpa_test
+Usage:           maze_hpa_test
+Output:          One line per failed query, then a summary. Exits with 1 if
+                 any query failed.
+*******************************************************************************/
+#include "MazeHPA.h"
+#include <random>
+#include <queue>
+
+/* Helper Functions */
+namespace MazeHPATestHelper {
+  void carvePerfect( Maze & maze, std::mt19937 & random );
+  int shortestDistance( Maze & maze, MazeCell * start, MazeCell * goal );
+  bool checkPath( Maze & maze, MazeHPA & hpa, int cluster_size, MazeCell * start,
+                  MazeCell * goal, bool shortest );
+  bool samePath( Maze & maze, MazeHPA & updated, int cluster_size,
+                 MazeCell * start, MazeCell * goal );
+}
+
+/*******************************************************************************
+% Routine Name: main
+% File:         MazeHPATest.cpp
+% Parameters:   None.
+% Description:  Runs the border wall case that once left stale entrances, a
+%               walled off goal, queries over perfect mazes, then random wall
+%               flips on random mazes, for cluster sizes down to single cells.
+% Return:       0 if every query passed, 1 otherwise.
+*******************************************************************************/
+int main() {
+  int queries = 0;
+  int failures = 0;
+
+  /* walls along the border columns inside each cluster */
+  {
+    Maze maze( 8, 4 );
+    maze.clearWalls();
+    MazeHPA hpa( maze, 4 );
+    hpa.findPath( maze.at(0, 0), maze.at(3, 7) );
+    maze.addWall( maze.at(1, 3), maze.at(2, 3) );
+    maze.addWall( maze.at(1, 4), maze.at(2, 4) );
+    queries++;
+    if( !MazeHPATestHelper::samePath(maze, hpa, 4, maze.at(3, 3), maze.at(2, 4)) ) {
+      failures++;
+    }
+  }
+
+  /* goal walled off after the abstraction was built */
+  for( int cluster_size = 1; cluster_size <= 4; cluster_size++ ) {
+    Maze maze( 9, 7 );
+    maze.clearWalls();
+    MazeHPA hpa( maze, cluster_size );
+    hpa.findPath( maze.at(0, 0), maze.at(6, 8) );
+    MazeCell * goal = maze.at( 3, 4 );
+    for( MazeCell * neighbor : maze.getAdjacentCellList(goal) ) {
+      maze.addWall( goal, neighbor );
+    }
+    queries += 2;
+    if( !MazeHPATestHelper::checkPath(maze, hpa, cluster_size, maze.at(0, 0), goal, true) ) {
+      failures++;
+    }
+    if( !MazeHPATestHelper::checkPath(maze, hpa, cluster_size, goal, goal, true) ) {
+      failures++;
+    }
+  }
+
+  /* perfect mazes have one path between any two cells */
+  std::mt19937 random( 1 );
+  for( int cluster_size = 1; cluster_size <= 5; cluster_size++ ) {
+    for( int trial = 0; trial < 10; trial++ ) {
+      const int width = 2 + random() % 20;
+      const int height = 2 + random() % 20;
+      Maze maze( width, height );
+      MazeHPATestHelper::carvePerfect( maze, random );
+      MazeHPA hpa( maze, cluster_size );
+      for( int query = 0; query < 20; query++ ) {
+        MazeCell * start = maze.at( random() % height, random() % width );
+        MazeCell * goal = maze.at( random() % height, random() % width );
+        queries++;
+        if( !MazeHPATestHelper::checkPath(maze, hpa, cluster_size, start, goal, true) ) {
+          failures++;
+        }
+      }
+    }
+  }
+
+  /* loops and unreachable regions from random wall flips */
+  for( int cluster_size = 1; cluster_size <= 5; cluster_size++ ) {
+    for( int trial = 0; trial < 20; trial++ ) {
+      const int width = 3 + random() % 12;
+      const int height = 3 + random() % 12;
+      Maze maze( width, height );
+      maze.clearWalls();
+      MazeHPA hpa( maze, cluster_size );
+      for( int flip = 0; flip < 60; flip++ ) {
+        MazeCell * cell = maze.at( random() % height, random() % width );
+        MazeCell * neighbor = ( random() & 1 ) ? maze.at( cell->row, cell->column + 1 )
+                                               : maze.at( cell->row + 1, cell->column );
+        if( neighbor == nullptr ) continue;
+        if( maze.wallBetween(cell, neighbor) ) maze.removeWall( cell, neighbor );
+        else maze.addWall( cell, neighbor );
+
+        MazeCell * start = maze.at( random() % height, random() % width );
+        MazeCell * goal = maze.at( random() % height, random() % width );
+        queries++;
+        if( !MazeHPATestHelper::checkPath(maze, hpa, cluster_size, start, goal,
+                                          cluster_size == 1) ||
+            !MazeHPATestHelper::samePath(maze, hpa, cluster_size, start, goal) ) {
+          failures++;
+        }
+      }
+    }
+  }
+
+  std::cout << queries << " queries, " << failures << " failed" << std::endl;
+  return failures ? 1 : 0;
+}
+
+/*******************************************************************************
+% Routine Name: carvePerfect
+% File:         MazeHPATest.cpp
+% Parameters:   maze   - maze with every wall up.
+%               random - source of the carving order.
+% Description:  Carves a perfect maze - a spanning tree of the cells - with a
+%               randomized depth first search.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeHPATestHelper::carvePerfect( Maze & maze, std::mt19937 & random ) {
+  std::vector<bool> carved( maze.getWidth() * maze.getHeight(), false );
+  std::vector<MazeCell *> stack( 1, maze.at(0, 0) );
+  carved[ 0 ] = true;
+  while( !stack.empty() ) {
+    std::vector<MazeCell *> fresh;
+    for( MazeCell * neighbor : maze.getAdjacentCellList(stack.back()) ) {
+      if( !carved[ neighbor->row * maze.getWidth() + neighbor->column ] ) {
+        fresh.push_back( neighbor );
+      }
+    }
+    if( fresh.empty() ) {
+      stack.pop_back();
+      continue;
+    }
+    MazeCell * next = fresh[ random() % fresh.size() ];
+    carved[ next->row * maze.getWidth() + next->column ] = true;
+    maze.removeWall( stack.back(), next );
+    stack.push_back( next );
+  }
+}
+
+/*******************************************************************************
+% Routine Name: shortestDistance
+% File:         MazeHPATest.cpp
+% Parameters:   maze  - the maze.
+%               start - first cell.
+%               goal  - last cell.
+% Description:  Breadth first search over the open passages of the maze.
+% Return:       Number of moves from start to goal, -1 if unreachable.
+*******************************************************************************/
+int MazeHPATestHelper::shortestDistance( Maze & maze, MazeCell * start, MazeCell * goal ) {
+  std::vector<int> distance( maze.getWidth() * maze.getHeight(), -1 );
+  std::queue<MazeCell *> frontier;
+  distance[ start->row * maze.getWidth() + start->column ] = 0;
+  frontier.push( start );
+  while( !frontier.empty() ) {
+    MazeCell * cell = frontier.front();
+    frontier.pop();
+    if( cell == goal ) break;
+    for( MazeCell * neighbor : maze.getAdjacentCellList(cell) ) {
+      int & next = distance[ neighbor->row * maze.getWidth() + neighbor->column ];
+      if( next >= 0 || maze.wallBetween(cell, neighbor) ) continue;
+      next = distance[ cell->row * maze.getWidth() + cell->column ] + 1;
+      frontier.push( neighbor );
+    }
+  }
+  return distance[ goal->row * maze.getWidth() + goal->column ];
+}
+
+/*******************************************************************************
+% Routine Name: checkPath
+% File:         MazeHPATest.cpp
+% Parameters:   maze         - the maze.
+%               hpa          - abstraction under test.
+%               cluster_size - cluster size of the abstraction.
+%               start        - first cell of the path.
+%               goal         - last cell of the path.
+%               shortest     - the path must also be a shortest one.
+% Description:  Checks that the path runs from start to goal between open
+%               neighbors, that it is empty only when the goal is unreachable,
+%               and that it is no shorter - or, when asked, no longer - than
+%               the breadth first search distance. Reports a failure.
+% Return:       True if the path passed.
+*******************************************************************************/
+bool MazeHPATestHelper::checkPath( Maze & maze, MazeHPA & hpa, int cluster_size,
+  MazeCell * start, MazeCell * goal, bool shortest ) {
+
+  std::vector<MazeCell *> path = hpa.findPath( start, goal );
+  const int distance = shortestDistance( maze, start, goal );
+  const char * problem = nullptr;
+  if( distance < 0 ) {
+    if( !path.empty() ) problem = "path to an unreachable goal";
+  }
+  else if( path.empty() ) problem = "no path to a reachable goal";
+  else if( path.front() != start || path.back() != goal ) problem = "wrong endpoints";
+  else if( (int)path.size() - 1 < distance ) problem = "shorter than possible";
+  else if( shortest && (int)path.size() - 1 != distance ) problem = "not shortest";
+  for( size_t step = 1; problem == nullptr && step < path.size(); step++ ) {
+    MazeCell * from = path[ step - 1 ];
+    MazeCell * to = path[ step ];
+    if( std::abs(from->row - to->row) + std::abs(from->column - to->column) != 1 ||
+        maze.wallBetween(from, to) ) {
+      problem = "steps through a wall";
+    }
+  }
+  if( problem == nullptr ) return true;
+  std::cout << "cluster size " << cluster_size << ", " << maze.getWidth() << "x"
+            << maze.getHeight() << ": (" << start->row << "," << start->column
+            << ") -> (" << goal->row << "," << goal->column << ") " << problem
+            << " - " << path.size() << " cells, distance " << distance << std::endl;
+  return false;
+}
+
+/*******************************************************************************
+% Routine Name: samePath
+% File:         MazeHPATest.cpp
+% Parameters:   maze         - the maze.
+%               updated      - abstraction kept up to date by wall changes.
+%               cluster_size - cluster size of the abstraction.
+%               start        - first cell of the path.
+%               goal         - last cell of the path.
+% Description:  Compares the path of the updated abstraction with the path of
+%               one built from scratch, and reports a mismatch.
+% Return:       True if both paths have the same length.
+*******************************************************************************/
+bool MazeHPATestHelper::samePath( Maze & maze, MazeHPA & updated, int cluster_size,
+  MazeCell * start, MazeCell * goal ) {
+
+  MazeHPA fresh( maze, cluster_size );
+  size_t expected = fresh.findPath( start, goal ).size();
+  size_t found = updated.findPath( start, goal ).size();
+  if( found == expected ) return true;
+  std::cout << "cluster size " << cluster_size << ", " << maze.getWidth() << "x"
+            << maze.getHeight() << ": (" << start->row << "," << start->column
+            << ") -> (" << goal->row << "," << goal->column << ") has "
+            << found << " cells, expected " << expected << std::endl;
+  return false;
+}
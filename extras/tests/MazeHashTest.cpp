@@ -0,0 +1,192 @@
+/*******************************************************************************
+                                                    Jose Jorge Jimenez-Olivas
+                                                    Brandon Cramer
+
+                 University of California, San Diego
+                           IEEE Micromouse
+
+File Name:       MazeHashTest.cpp
+Description:     Regression check of the incremental maze hash and equality.
+                 After every random wall flip, the maze must equal, and hash
+                 the same as, a fresh maze given the same walls in another
+                 order. A cleared maze must equal, hash and save the same as a
+                 maze that never had a passage.
+
+Build:           g++ -std=c++11 -O2 -I../.. MazeHashTest.cpp -o maze_hash_test
+Usage:           maze_hash_test
+Output:          One line per failed check, then a summary. Exits with 1 if
+                 any check failed.
+*******************************************************************************/
+#include "Maze.h"
+#include <random>
+#include <cstdio>
+
+/* Helper Functions */
+namespace MazeHashTestHelper {
+  bool flipWall( Maze & maze, std::mt19937 & random );
+  void copyWalls( Maze & source, Maze & destination, std::mt19937 & random );
+  std::string fileBytes( const char * filename );
+  bool expect( bool condition, const char * what, Maze & maze );
+}
+
+/*******************************************************************************
+% Routine Name: main
+% File:         MazeHashTest.cpp
+% Parameters:   None.
+% Description:  Compares incrementally hashed mazes with rebuilt ones, then
+%               cleared mazes with mazes that never had a passage.
+% Return:       0 if every check passed, 1 otherwise.
+*******************************************************************************/
+int main() {
+  const char * cleared_file = "maze_hash_test_cleared.maze";
+  const char * walled_file = "maze_hash_test_walled.maze";
+  int checks = 0;
+  int failures = 0;
+  std::mt19937 random( 11 );
+
+  /* incremental hash against the same walls applied in another order */
+  for( int trial = 0; trial < 20; trial++ ) {
+    const int width = 1 + random() % 70;
+    const int height = 1 + random() % 20;
+    Maze maze( width, height );
+    const uint64_t walled_hash = maze.getHash();
+    for( int flip = 0; flip < 100; flip++ ) {
+      const uint64_t before = maze.getHash();
+      const bool flipped = MazeHashTestHelper::flipWall( maze, random );
+      Maze rebuilt( width, height );
+      MazeHashTestHelper::copyWalls( maze, rebuilt, random );
+      checks += 3;
+      if( !MazeHashTestHelper::expect(maze.getHash() == rebuilt.getHash(),
+                                      "hash differs from a rebuilt maze", maze) ) {
+        failures++;
+      }
+      if( !MazeHashTestHelper::expect(maze == rebuilt, "differs from a rebuilt maze", maze) ) {
+        failures++;
+      }
+      if( !MazeHashTestHelper::expect(!flipped || maze.getHash() != before,
+                                      "hash unchanged by a wall flip", maze) ) {
+        failures++;
+      }
+    }
+    /* walls back up in any order restore the hash of a new maze */
+    maze.clear();
+    checks++;
+    if( !MazeHashTestHelper::expect(maze.getHash() == walled_hash,
+                                    "hash of a cleared maze", maze) ) {
+      failures++;
+    }
+  }
+
+  /* a cleared maze against one that never had a passage */
+  for( int trial = 0; trial < 10; trial++ ) {
+    const int width = 1 + random() % 40;
+    const int height = 1 + random() % 40;
+    Maze maze( width, height );
+    maze.clearWalls();
+    for( int flip = 0; flip < width * height; flip++ ) {
+      MazeHashTestHelper::flipWall( maze, random );
+    }
+    maze.clear();
+    Maze walled( width, height );
+    maze.save( cleared_file );
+    walled.save( walled_file );
+    checks += 4;
+    if( !MazeHashTestHelper::expect(maze == walled, "cleared maze differs", maze) ) {
+      failures++;
+    }
+    if( !MazeHashTestHelper::expect(maze.getHash() == walled.getHash(),
+                                    "cleared maze hash differs", maze) ) {
+      failures++;
+    }
+    if( !MazeHashTestHelper::expect(MazeHashTestHelper::fileBytes(cleared_file) ==
+                                    MazeHashTestHelper::fileBytes(walled_file),
+                                    "cleared maze saves differently", maze) ) {
+      failures++;
+    }
+    bool walls_up = true;
+    for( MazeCell * cell : maze ) {
+      for( MazeCell * neighbor : maze.getAdjacentCellList(cell) ) {
+        walls_up = walls_up && maze.wallBetween( cell, neighbor );
+      }
+    }
+    if( !MazeHashTestHelper::expect(walls_up, "cleared maze has a passage", maze) ) {
+      failures++;
+    }
+  }
+  std::remove( cleared_file );
+  std::remove( walled_file );
+
+  std::cout << checks << " checks, " << failures << " failed" << std::endl;
+  return failures ? 1 : 0;
+}
+
+/*******************************************************************************
+% Routine Name: flipWall
+% File:         MazeHashTest.cpp
+% Parameters:   maze   - the maze.
+%               random - source of the wall to flip.
+% Description:  Adds or removes the wall right of or below a random cell.
+% Return:       False if the cell has no neighbor on that side.
+*******************************************************************************/
+bool MazeHashTestHelper::flipWall( Maze & maze, std::mt19937 & random ) {
+  MazeCell * cell = maze.at( random() % maze.getHeight(), random() % maze.getWidth() );
+  MazeCell * neighbor = ( random() & 1 ) ? maze.at( cell->row, cell->column + 1 )
+                                         : maze.at( cell->row + 1, cell->column );
+  if( neighbor == nullptr ) return false;
+  if( maze.wallBetween(cell, neighbor) ) maze.removeWall( cell, neighbor );
+  else maze.addWall( cell, neighbor );
+  return true;
+}
+
+/*******************************************************************************
+% Routine Name: copyWalls
+% File:         MazeHashTest.cpp
+% Parameters:   source      - maze to copy the walls of.
+%               destination - maze of the same dimensions with every wall up.
+%               random      - source of the order passages are opened in.
+% Description:  Opens the passages of source in destination in random order.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeHashTestHelper::copyWalls( Maze & source, Maze & destination,
+  std::mt19937 & random ) {
+
+  std::vector<std::pair<MazeCell *, MazeCell *>> passages;
+  for( MazeCell * cell : source ) {
+    if( cell->right != nullptr ) passages.push_back( std::make_pair(cell, cell->right) );
+    if( cell->down != nullptr ) passages.push_back( std::make_pair(cell, cell->down) );
+  }
+  std::shuffle( passages.begin(), passages.end(), random );
+  for( std::pair<MazeCell *, MazeCell *> & passage : passages ) {
+    destination.removeWall( destination.at(passage.first->row, passage.first->column),
+                            destination.at(passage.second->row, passage.second->column) );
+  }
+}
+
+/*******************************************************************************
+% Routine Name: fileBytes
+% File:         MazeHashTest.cpp
+% Parameters:   filename - file to read.
+% Description:  Reads a whole file.
+% Return:       The bytes of the file.
+*******************************************************************************/
+std::string MazeHashTestHelper::fileBytes( const char * filename ) {
+  std::ifstream instream( filename, std::ios::in | std::ios::binary );
+  return std::string( std::istreambuf_iterator<char>(instream),
+                      std::istreambuf_iterator<char>() );
+}
+
+/*******************************************************************************
+% Routine Name: expect
+% File:         MazeHashTest.cpp
+% Parameters:   condition - result of the check.
+%               what      - description of the failure.
+%               maze      - maze checked.
+% Description:  Reports a failed check.
+% Return:       The condition.
+*******************************************************************************/
+bool MazeHashTestHelper::expect( bool condition, const char * what, Maze & maze ) {
+  if( !condition ) {
+    std::cout << maze.getWidth() << "x" << maze.getHeight() << ": " << what << std::endl;
+  }
+  return condition;
+}
@@ -0,0 +1,232 @@
+/*******************************************************************************
+                                                    Jose Jorge Jimenez-Olivas
+                                                    Brandon Cramer
+
+                 University of California, San Diego
+                           IEEE Micromouse
+
+File Name:       MazeJournalTest.cpp
+Description:     Regression check of the wall change journal and Maze::diff.
+                 Undo must step back through every recorded state, redo must
+                 step forward again, rollback must return to its checkpoint,
+                 and applying a diff must turn one maze into the other.
+
+Build:           g++ -std=c++11 -O2 -I../.. MazeJournalTest.cpp -o maze_journal_test
+Usage:           maze_journal_test
+Output:          One line per failed check, then a summary. Exits with 1 if
+                 any check failed.
+*******************************************************************************/
+#include "Maze.h"
+#include <random>
+
+/* walls of a maze at one point of its journal */
+struct MazeJournalTestState {
+  std::vector<uint64_t> right;
+  std::vector<uint64_t> down;
+  uint64_t hash;
+};
+
+/* Helper Functions */
+namespace MazeJournalTestHelper {
+  bool flipWall( Maze & maze, std::mt19937 & random );
+  MazeJournalTestState stateOf( const Maze & maze );
+  bool inState( const Maze & maze, const MazeJournalTestState & state );
+  bool expect( bool condition, const char * what, Maze & maze );
+}
+
+/*******************************************************************************
+% Routine Name: main
+% File:         MazeJournalTest.cpp
+% Parameters:   None.
+% Description:  Walks the journal of random wall flips back and forth, rolls
+%               back across a bulk load, then applies diffs between random
+%               mazes.
+% Return:       0 if every check passed, 1 otherwise.
+*******************************************************************************/
+int main() {
+  int checks = 0;
+  int failures = 0;
+  std::mt19937 random( 3 );
+
+  for( int trial = 0; trial < 20; trial++ ) {
+    const int width = 1 + random() % 70;
+    const int height = 1 + random() % 20;
+    Maze maze( width, height );
+    checks++;
+    if( !MazeJournalTestHelper::expect(!maze.undo() && !maze.redo(),
+                                       "undo or redo without a journal", maze) ) {
+      failures++;
+    }
+    maze.setJournaling( true );
+
+    /* undo and redo step through every state of single wall flips */
+    std::vector<MazeJournalTestState> states( 1, MazeJournalTestHelper::stateOf(maze) );
+    for( int step = 0; step < 40; step++ ) {
+      if( MazeJournalTestHelper::flipWall(maze, random) ) {
+        states.push_back( MazeJournalTestHelper::stateOf(maze) );
+      }
+    }
+    bool stepped = true;
+    for( size_t state = states.size() - 1; stepped && state > 0; state-- ) {
+      stepped = maze.undo() && MazeJournalTestHelper::inState( maze, states[ state - 1 ] );
+    }
+    checks += 2;
+    if( !MazeJournalTestHelper::expect(stepped && !maze.undo(), "undo missed a state", maze) ) {
+      failures++;
+    }
+    for( size_t state = 1; stepped && state < states.size(); state++ ) {
+      stepped = maze.redo() && MazeJournalTestHelper::inState( maze, states[ state ] );
+    }
+    if( !MazeJournalTestHelper::expect(stepped && !maze.redo(), "redo missed a state", maze) ) {
+      failures++;
+    }
+
+    /* rollback across a bulk load and single flips */
+    const MazeJournalTestState before = MazeJournalTestHelper::stateOf( maze );
+    const size_t start = maze.checkpoint();
+    Maze other( width, height );
+    for( int step = 0; step < width * height; step++ ) {
+      MazeJournalTestHelper::flipWall( other, random );
+    }
+    maze.setPassagePlanes( other.getRightPlane(), other.getDownPlane() );
+    const MazeJournalTestState loaded = MazeJournalTestHelper::stateOf( maze );
+    for( int step = 0; step < 20; step++ ) MazeJournalTestHelper::flipWall( maze, random );
+    checks += 4;
+    if( !MazeJournalTestHelper::expect(!maze.rollback(maze.checkpoint() + 1),
+                                       "rollback past the journal", maze) ) {
+      failures++;
+    }
+    if( !MazeJournalTestHelper::expect(maze.rollback(start) &&
+          MazeJournalTestHelper::inState(maze, before), "rollback missed", maze) ) {
+      failures++;
+    }
+    while( maze.redo() && !MazeJournalTestHelper::inState(maze, loaded) ) {}
+    if( !MazeJournalTestHelper::expect(MazeJournalTestHelper::inState(maze, loaded),
+                                       "redo missed the bulk load", maze) ) {
+      failures++;
+    }
+
+    /* a new change drops the undone history */
+    const bool flipped = maze.undo() && MazeJournalTestHelper::flipWall( maze, random );
+    if( !MazeJournalTestHelper::expect(!flipped || !maze.redo(),
+                                       "redo after a new change", maze) ) {
+      failures++;
+    }
+  }
+
+  /* applying a diff turns one maze into the other */
+  for( int trial = 0; trial < 20; trial++ ) {
+    const int width = 1 + random() % 70;
+    const int height = 1 + random() % 20;
+    Maze maze_A( width, height );
+    Maze maze_B( width, height );
+    for( int step = 0; step < width * height; step++ ) {
+      MazeJournalTestHelper::flipWall( maze_A, random );
+      MazeJournalTestHelper::flipWall( maze_B, random );
+    }
+    std::vector<WallChange> changes = Maze::diff( maze_A, maze_B );
+    size_t differing = 0;
+    for( int row = 0; row < height; row++ ) {
+      for( int column = 0; column < width; column++ ) {
+        MazeCell * right = maze_A.at( row, column + 1 );
+        MazeCell * down = maze_A.at( row + 1, column );
+        if( right != nullptr && maze_A.wallBetween(maze_A.at(row, column), right) !=
+            maze_B.wallBetween(maze_B.at(row, column), maze_B.at(row, column + 1)) ) {
+          differing++;
+        }
+        if( down != nullptr && maze_A.wallBetween(maze_A.at(row, column), down) !=
+            maze_B.wallBetween(maze_B.at(row, column), maze_B.at(row + 1, column)) ) {
+          differing++;
+        }
+      }
+    }
+    for( const WallChange & change : changes ) {
+      MazeCell * cell = maze_A.at( change.row, change.column );
+      MazeCell * neighbor = change.orientation ? maze_A.at( change.row + 1, change.column )
+                                               : maze_A.at( change.row, change.column + 1 );
+      if( change.added ) maze_A.addWall( cell, neighbor );
+      else maze_A.removeWall( cell, neighbor );
+    }
+    Maze other( width + 1, height );
+    checks += 4;
+    if( !MazeJournalTestHelper::expect(changes.size() == differing, "diff size", maze_A) ) {
+      failures++;
+    }
+    if( !MazeJournalTestHelper::expect(maze_A == maze_B, "diff applied differs", maze_A) ) {
+      failures++;
+    }
+    if( !MazeJournalTestHelper::expect(Maze::diff(maze_A, maze_B).empty(),
+                                       "diff of equal mazes", maze_A) ) {
+      failures++;
+    }
+    if( !MazeJournalTestHelper::expect(Maze::diff(maze_A, other).empty(),
+                                       "diff of other dimensions", maze_A) ) {
+      failures++;
+    }
+  }
+
+  std::cout << checks << " checks, " << failures << " failed" << std::endl;
+  return failures ? 1 : 0;
+}
+
+/*******************************************************************************
+% Routine Name: flipWall
+% File:         MazeJournalTest.cpp
+% Parameters:   maze   - the maze.
+%               random - source of the wall to flip.
+% Description:  Adds or removes the wall right of or below a random cell.
+% Return:       False if the cell has no neighbor on that side.
+*******************************************************************************/
+bool MazeJournalTestHelper::flipWall( Maze & maze, std::mt19937 & random ) {
+  MazeCell * cell = maze.at( random() % maze.getHeight(), random() % maze.getWidth() );
+  MazeCell * neighbor = ( random() & 1 ) ? maze.at( cell->row, cell->column + 1 )
+                                         : maze.at( cell->row + 1, cell->column );
+  if( neighbor == nullptr ) return false;
+  if( maze.wallBetween(cell, neighbor) ) maze.removeWall( cell, neighbor );
+  else maze.addWall( cell, neighbor );
+  return true;
+}
+
+/*******************************************************************************
+% Routine Name: stateOf
+% File:         MazeJournalTest.cpp
+% Parameters:   maze - the maze.
+% Description:  Copies the walls and hash of a maze.
+% Return:       The state of the maze.
+*******************************************************************************/
+MazeJournalTestState MazeJournalTestHelper::stateOf( const Maze & maze ) {
+  MazeJournalTestState state;
+  state.right = maze.getRightPlane();
+  state.down = maze.getDownPlane();
+  state.hash = maze.getHash();
+  return state;
+}
+
+/*******************************************************************************
+% Routine Name: inState
+% File:         MazeJournalTest.cpp
+% Parameters:   maze  - the maze.
+%               state - walls and hash recorded earlier.
+% Description:  Compares a maze with a recorded state.
+% Return:       True if the walls and hash match.
+*******************************************************************************/
+bool MazeJournalTestHelper::inState( const Maze & maze, const MazeJournalTestState & state ) {
+  return maze.getRightPlane() == state.right && maze.getDownPlane() == state.down &&
+         maze.getHash() == state.hash;
+}
+
+/*******************************************************************************
+% Routine Name: expect
+% File:         MazeJournalTest.cpp
+% Parameters:   condition - result of the check.
+%               what      - description of the failure.
+%               maze      - maze checked.
+% Description:  Reports a failed check.
+% Return:       The condition.
+*******************************************************************************/
+bool MazeJournalTestHelper::expect( bool condition, const char * what, Maze & maze ) {
+  if( !condition ) {
+    std::cout << maze.getWidth() << "x" << maze.getHeight() << ": " << what << std::endl;
+  }
+  return condition;
+}
@@ -0,0 +1,144 @@
+/*******************************************************************************
+                                                    Jose Jorge Jimenez-Olivas
+                                                    Brandon Cramer
+
+                 University of California, San Diego
+                           IEEE Micromouse
+
+File Name:       MazeSaveAsyncTest.cpp
+Description:     Regression check of the asynchronous save. The file written
+                 by saveAsync must be byte for byte the file written by save
+                 for the walls at the time of the call, even when the maze
+                 changes before the worker is done, and after clear().
+
+Build:           g++ -std=c++11 -O2 -pthread -I../.. MazeSaveAsyncTest.cpp -o maze_save_async_test
+Usage:           maze_save_async_test
+Output:          One line per failed check, then a summary. Exits with 1 if
+                 any check failed.
+*******************************************************************************/
+#include "Maze.h"
+#include <atomic>
+#include <random>
+#include <cstdio>
+
+/* Helper Functions */
+namespace MazeSaveAsyncTestHelper {
+  bool flipWall( Maze & maze, std::mt19937 & random );
+  std::string fileBytes( const char * filename );
+  bool expect( bool condition, const char * what, Maze & maze );
+}
+
+/*******************************************************************************
+% Routine Name: main
+% File:         MazeSaveAsyncTest.cpp
+% Parameters:   None.
+% Description:  Saves random mazes both ways while changing them behind the
+%               worker, then cleared mazes and a file that cannot be written.
+% Return:       0 if every check passed, 1 otherwise.
+*******************************************************************************/
+int main() {
+  const char * saved_file = "maze_save_async_test_saved.maze";
+  const char * async_file = "maze_save_async_test_async.maze";
+  int checks = 0;
+  int failures = 0;
+  std::mt19937 random( 23 );
+
+  for( int trial = 0; trial < 30; trial++ ) {
+    const int width = 1 + random() % 140;
+    const int height = 1 + random() % 70;
+    Maze maze( width, height );
+    for( int flip = 0; flip < width * height; flip++ ) {
+      MazeSaveAsyncTestHelper::flipWall( maze, random );
+    }
+    if( trial % 3 == 0 ) maze.clear();
+    maze.save( saved_file );
+
+    /* the maze changes as soon as the call returns */
+    std::atomic<int> reported( -1 );
+    std::future<bool> status = maze.saveAsync( async_file, [&reported]( bool saved ) {
+      reported = saved;
+    } );
+    for( int flip = 0; flip < 50; flip++ ) MazeSaveAsyncTestHelper::flipWall( maze, random );
+    const bool saved = status.get();
+    const std::string bytes = MazeSaveAsyncTestHelper::fileBytes( async_file );
+    checks += 3;
+    if( !MazeSaveAsyncTestHelper::expect(saved && reported == 1, "save status", maze) ) {
+      failures++;
+    }
+    if( !MazeSaveAsyncTestHelper::expect(bytes == MazeSaveAsyncTestHelper::fileBytes(saved_file),
+          "file differs from save", maze) ) {
+      failures++;
+    }
+    /* the file decodes back into the walls at the time of the call */
+    Maze decoded( width, height );
+    Maze expected( width, height );
+    expected.load( saved_file );
+    if( !MazeSaveAsyncTestHelper::expect(decoded.decode((const uint8_t *) bytes.data(),
+          bytes.size()) && decoded == expected, "file decodes to other walls", maze) ) {
+      failures++;
+    }
+  }
+
+  /* a file that cannot be written reports failure both ways */
+  Maze maze( 4, 4 );
+  std::atomic<int> reported( -1 );
+  std::future<bool> status = maze.saveAsync( "maze_save_async_test/missing/dir.maze",
+    [&reported]( bool saved ) { reported = saved; } );
+  checks++;
+  if( !MazeSaveAsyncTestHelper::expect(!status.get() && reported == 0,
+        "unwritable file reported saved", maze) ) {
+    failures++;
+  }
+  std::remove( saved_file );
+  std::remove( async_file );
+
+  std::cout << checks << " checks, " << failures << " failed" << std::endl;
+  return failures ? 1 : 0;
+}
+
+/*******************************************************************************
+% Routine Name: flipWall
+% File:         MazeSaveAsyncTest.cpp
+% Parameters:   maze   - the maze.
+%               random - source of the wall to flip.
+% Description:  Adds or removes the wall right of or below a random cell.
+% Return:       False if the cell has no neighbor on that side.
+*******************************************************************************/
+bool MazeSaveAsyncTestHelper::flipWall( Maze & maze, std::mt19937 & random ) {
+  MazeCell * cell = maze.at( random() % maze.getHeight(), random() % maze.getWidth() );
+  MazeCell * neighbor = ( random() & 1 ) ? maze.at( cell->row, cell->column + 1 )
+                                         : maze.at( cell->row + 1, cell->column );
+  if( neighbor == nullptr ) return false;
+  if( maze.wallBetween(cell, neighbor) ) maze.removeWall( cell, neighbor );
+  else maze.addWall( cell, neighbor );
+  return true;
+}
+
+/*******************************************************************************
+% Routine Name: fileBytes
+% File:         MazeSaveAsyncTest.cpp
+% Parameters:   filename - file to read.
+% Description:  Reads a whole file.
+% Return:       The bytes of the file.
+*******************************************************************************/
+std::string MazeSaveAsyncTestHelper::fileBytes( const char * filename ) {
+  std::ifstream instream( filename, std::ios::in | std::ios::binary );
+  return std::string( std::istreambuf_iterator<char>(instream),
+                      std::istreambuf_iterator<char>() );
+}
+
+/*******************************************************************************
+% Routine Name: expect
+% File:         MazeSaveAsyncTest.cpp
+% Parameters:   condition - result of the check.
+%               what      - description of the failure.
+%               maze      - maze checked.
+% Description:  Reports a failed check.
+% Return:       The condition.
+*******************************************************************************/
+bool MazeSaveAsyncTestHelper::expect( bool condition, const char * what, Maze & maze ) {
+  if( !condition ) {
+    std::cout << maze.getWidth() << "x" << maze.getHeight() << ": " << what << std::endl;
+  }
+  return condition;
+}
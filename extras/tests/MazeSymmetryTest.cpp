@@ -0,0 +1,176 @@
+/*******************************************************************************
+                                                    Jose Jorge Jimenez-Olivas
+                                                    Brandon Cramer
+
+                 University of California, San Diego
+                           IEEE Micromouse
+
+File Name:       MazeSymmetryTest.cpp
+Description:     Regression check of the maze symmetries. Every one of the 8
+                 packed transforms must match the same transform done cell by
+                 cell, all 8 images of a maze must share its canonical form,
+                 and hashing the planes from scratch must give the hash that
+                 Maze kept up to date incrementally.
+
+Build:           g++ -std=c++11 -O2 -I../.. MazeSymmetryTest.cpp -o maze_symmetry_test
+Usage:           maze_symmetry_test
+Output:          One line per failed check, then a summary. Exits with 1 if
+                 any check failed.
+*******************************************************************************/
+#include "MazeSymmetry.h"
+#include <random>
+
+/* Helper Functions */
+namespace MazeSymmetryTestHelper {
+  void randomWalls( Maze & maze, std::mt19937 & random );
+  void transformCells( Maze & maze, int symmetry, Maze & image );
+  bool samePlanes( const PassagePlanes & planes_A, const PassagePlanes & planes_B );
+  bool expect( bool condition, const char * what, Maze & maze, int symmetry );
+}
+
+/*******************************************************************************
+% Routine Name: main
+% File:         MazeSymmetryTest.cpp
+% Parameters:   None.
+% Description:  Checks every symmetry of random mazes on both sides of the
+%               64 cell word size, square and not.
+% Return:       0 if every check passed, 1 otherwise.
+*******************************************************************************/
+int main() {
+  int checks = 0;
+  int failures = 0;
+  std::mt19937 random( 5 );
+
+  for( int trial = 0; trial < 40; trial++ ) {
+    const int width = 1 + random() % ( trial < 20 ? 20 : 140 );
+    const int height = ( trial % 4 == 0 ) ? width : 1 + random() % ( trial < 20 ? 20 : 140 );
+    Maze maze( width, height );
+    MazeSymmetryTestHelper::randomWalls( maze, random );
+    const PassagePlanes planes = MazeSymmetry::planesOf( maze );
+    const CanonicalForm canonical = MazeSymmetry::canonicalize( maze );
+    checks++;
+    if( !MazeSymmetryTestHelper::expect(MazeSymmetry::hashOf(planes) == maze.getHash(),
+                                        "full rehash differs", maze, 0) ) {
+      failures++;
+    }
+
+    for( int symmetry = 0; symmetry < MazeSymmetry::SYMMETRIES; symmetry++ ) {
+      const bool transposed = symmetry & MazeSymmetry::TRANSPOSE;
+      Maze image( transposed ? height : width, transposed ? width : height );
+      MazeSymmetryTestHelper::transformCells( maze, symmetry, image );
+      const PassagePlanes transformed = MazeSymmetry::transform( planes, symmetry );
+      const CanonicalForm image_canonical = MazeSymmetry::canonicalize( image );
+      checks += 4;
+      if( !MazeSymmetryTestHelper::expect(MazeSymmetryTestHelper::samePlanes(transformed,
+            MazeSymmetry::planesOf(image)), "transform differs from the cells", maze, symmetry) ) {
+        failures++;
+      }
+      if( !MazeSymmetryTestHelper::expect(MazeSymmetryTestHelper::samePlanes(canonical.planes,
+            image_canonical.planes), "canonical form differs", maze, symmetry) ) {
+        failures++;
+      }
+      if( !MazeSymmetryTestHelper::expect(canonical.hash == image_canonical.hash &&
+            canonical.hash == MazeSymmetry::canonicalHash(image), "canonical hash differs",
+            maze, symmetry) ) {
+        failures++;
+      }
+      /* the reported symmetry maps the image onto the canonical form */
+      if( !MazeSymmetryTestHelper::expect(MazeSymmetryTestHelper::samePlanes(canonical.planes,
+            MazeSymmetry::transform(MazeSymmetry::planesOf(image), image_canonical.symmetry)),
+            "reported symmetry is wrong", maze, symmetry) ) {
+        failures++;
+      }
+    }
+
+    /* restoring the canonical planes into a maze of that shape */
+    Maze restored( canonical.planes.width, canonical.planes.height );
+    checks++;
+    if( !MazeSymmetryTestHelper::expect(MazeSymmetry::restore(canonical.planes, restored) &&
+          restored.getHash() == canonical.hash, "restored hash differs", maze, 0) ) {
+      failures++;
+    }
+  }
+
+  std::cout << checks << " checks, " << failures << " failed" << std::endl;
+  return failures ? 1 : 0;
+}
+
+/*******************************************************************************
+% Routine Name: randomWalls
+% File:         MazeSymmetryTest.cpp
+% Parameters:   maze   - maze with every wall up.
+%               random - source of the passages.
+% Description:  Opens about half of the passages of the maze.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeSymmetryTestHelper::randomWalls( Maze & maze, std::mt19937 & random ) {
+  for( int row = 0; row < maze.getHeight(); row++ ) {
+    for( int column = 0; column < maze.getWidth(); column++ ) {
+      if( random() & 1 ) maze.removeWall( maze.at(row, column), maze.at(row, column + 1) );
+      if( random() & 1 ) maze.removeWall( maze.at(row, column), maze.at(row + 1, column) );
+    }
+  }
+}
+
+/*******************************************************************************
+% Routine Name: transformCells
+% File:         MazeSymmetryTest.cpp
+% Parameters:   maze     - maze to transform.
+%               symmetry - combination of TRANSPOSE, FLIP_ROWS and FLIP_COLUMNS.
+%               image    - maze with every wall up, of the transformed shape.
+% Description:  Opens in image every passage of maze, moving both of its cells
+%               through the symmetry one coordinate at a time.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeSymmetryTestHelper::transformCells( Maze & maze, int symmetry, Maze & image ) {
+  auto mapCell = [&]( MazeCell * cell ) {
+    int row = cell->row;
+    int column = cell->column;
+    if( symmetry & MazeSymmetry::TRANSPOSE ) std::swap( row, column );
+    if( symmetry & MazeSymmetry::FLIP_COLUMNS ) column = image.getWidth() - 1 - column;
+    if( symmetry & MazeSymmetry::FLIP_ROWS ) row = image.getHeight() - 1 - row;
+    return image.at( row, column );
+  };
+  for( int row = 0; row < maze.getHeight(); row++ ) {
+    for( int column = 0; column < maze.getWidth(); column++ ) {
+      MazeCell * cell = maze.at( row, column );
+      if( cell->right != nullptr ) image.removeWall( mapCell(cell), mapCell(cell->right) );
+      if( cell->down != nullptr ) image.removeWall( mapCell(cell), mapCell(cell->down) );
+    }
+  }
+}
+
+/*******************************************************************************
+% Routine Name: samePlanes
+% File:         MazeSymmetryTest.cpp
+% Parameters:   planes_A - passage planes of a maze.
+%               planes_B - passage planes of a maze.
+% Description:  Compares the shapes and passages of two planes.
+% Return:       True if both describe the same maze.
+*******************************************************************************/
+bool MazeSymmetryTestHelper::samePlanes( const PassagePlanes & planes_A,
+  const PassagePlanes & planes_B ) {
+
+  return planes_A.width == planes_B.width && planes_A.height == planes_B.height &&
+         planes_A.right == planes_B.right && planes_A.down == planes_B.down;
+}
+
+/*******************************************************************************
+% Routine Name: expect
+% File:         MazeSymmetryTest.cpp
+% Parameters:   condition - result of the check.
+%               what      - description of the failure.
+%               maze      - maze checked.
+%               symmetry  - symmetry checked.
+% Description:  Reports a failed check.
+% Return:       The condition.
+*******************************************************************************/
+bool MazeSymmetryTestHelper::expect( bool condition, const char * what, Maze & maze,
+  int symmetry ) {
+
+  if( !condition ) {
+    std::cout << maze.getWidth() << "x" << maze.getHeight() << ", symmetry "
+              << symmetry << ": " << what << std::endl;
+  }
+  return condition;
+}
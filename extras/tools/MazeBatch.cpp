@@ -0,0 +1,462 @@
+/*******************************************************************************
+                                                    Jose Jorge Jimenez-Olivas
+                                                    Brandon Cramer
+
+                 University of California, San Diego
+                           IEEE Micromouse
+
+File Name:       MazeBatch.cpp
+Description:     Runs one solver or analytics pass over every maze of a corpus
+                 in parallel - files written by Maze::save, .maz files and
+                 text drawings. Each file is opened once and decoded in
+                 memory, and every worker reuses its own read buffer and maze.
+
+Build:           make -C .. tools/maze_batch, or
+                 g++ -std=c++11 -O2 -pthread -I../.. MazeBatch.cpp -o maze_batch
+Usage:           maze_batch [options] <maze file | directory | .tar archive> ...
+                   --pass NAME       flood (default), analytics, junctions,
+                                     hpa or canonical
+                   --format FORMAT   csv (default) or json
+                   --threads N       worker threads (default one per core)
+Output:          One CSV row or JSON object per maze, in input order, with the
+                 file, its dimensions, a status and the columns of the pass.
+                 A summary line with the throughput goes to stderr.
+*******************************************************************************/
+#include "MazeFloodFill.h"
+#include "MazeAnalytics.h"
+#include "MazeJunctionGraph.h"
+#include "MazeHPA.h"
+#include "MazeSymmetry.h"
+#include "MazeFormats.h"
+#include "WorkStealingPool.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <sstream>
+#include <iomanip>
+#include <sys/stat.h>
+#include <dirent.h>
+
+/* a maze to process - a whole file, or an entry of a tar archive */
+struct BatchJob {
+  std::string name;
+  std::string path;
+  long long offset = 0;
+  long long size = -1;
+};
+
+/* outcome of one maze */
+struct BatchResult {
+  int width = 0;
+  int height = 0;
+  std::string status;
+  std::vector<std::string> values;
+};
+
+/* a pass with the names of the columns it produces */
+struct BatchPass {
+  const char * name;
+  std::vector<std::string> columns;
+  void (*run)( Maze & maze, std::vector<std::string> & values );
+};
+
+/* buffers a worker keeps from one maze to the next */
+struct BatchScratch {
+  std::vector<uint8_t> buffer;
+  std::unique_ptr<Maze> maze;
+};
+
+/* Helper Functions */
+namespace MazeBatchHelper {
+  void collectJobs( const std::string & path, std::vector<BatchJob> & jobs );
+  void collectArchive( const std::string & path, std::vector<BatchJob> & jobs );
+  BatchResult process( const BatchJob & job, const BatchPass & pass );
+  void runFlood( Maze & maze, std::vector<std::string> & values );
+  void runAnalytics( Maze & maze, std::vector<std::string> & values );
+  void runJunctions( Maze & maze, std::vector<std::string> & values );
+  void runHPA( Maze & maze, std::vector<std::string> & values );
+  void runCanonical( Maze & maze, std::vector<std::string> & values );
+  std::string csvField( const std::string & field );
+  std::string jsonString( const std::string & text );
+}
+
+/* registered passes, looked up by name */
+static const BatchPass PASSES[] = {
+  { "flood", { "start_distance", "reachable" }, MazeBatchHelper::runFlood },
+  { "analytics", { "components", "edges", "loops", "perfect", "unreachable" },
+    MazeBatchHelper::runAnalytics },
+  { "junctions", { "junctions", "edges", "shrink_ratio", "start_distance" },
+    MazeBatchHelper::runJunctions },
+  { "hpa", { "path_cells", "nodes", "memory_bytes" }, MazeBatchHelper::runHPA },
+  { "canonical", { "canonical_hash", "symmetry" }, MazeBatchHelper::runCanonical },
+};
+
+/*******************************************************************************
+% Routine Name: main
+% File:         MazeBatch.cpp
+% Parameters:   argc - number of arguments.
+%               argv - options, maze files, directories and tar archives.
+% Description:  Collects every maze of the inputs, processes each one as an
+%               independent pool task and prints the results in input order.
+% Return:       0 on success, 1 on bad usage.
+*******************************************************************************/
+int main( int argc, char * argv[] ) {
+  const BatchPass * pass = &PASSES[ 0 ];
+  std::string format = "csv";
+  int threads = 0;
+  bool bad_usage = false;
+  std::vector<BatchJob> jobs;
+
+  for( int index = 1; index < argc; index++ ) {
+    std::string option = argv[ index ];
+    bool has_value = index + 1 < argc;
+    if( option == "--pass" && has_value ) {
+      std::string name = argv[ ++index ];
+      pass = nullptr;
+      for( const BatchPass & candidate : PASSES ) {
+        if( name == candidate.name ) pass = &candidate;
+      }
+      bad_usage |= ( pass == nullptr );
+    }
+    else if( option == "--format" && has_value ) format = argv[ ++index ];
+    else if( option == "--threads" && has_value ) threads = std::atoi( argv[ ++index ] );
+    else if( option.compare(0, 2, "--") == 0 ) bad_usage = true;
+    else MazeBatchHelper::collectJobs( option, jobs );
+  }
+  if( bad_usage || jobs.empty() || (format != "csv" && format != "json") ) {
+    std::cerr << "Usage: " << argv[ 0 ] << " [--pass NAME] [--format csv|json]"
+              << " [--threads N] <maze file | directory | .tar archive> ..."
+              << std::endl << "Passes:";
+    for( const BatchPass & candidate : PASSES ) std::cerr << " " << candidate.name;
+    std::cerr << std::endl;
+    return 1;
+  }
+
+  std::vector<BatchResult> results( jobs.size() );
+  auto start = std::chrono::steady_clock::now();
+  {
+    WorkStealingPool pool( threads );
+    for( size_t job = 0; job < jobs.size(); job++ ) {
+      pool.submit( [&, job] {
+        results[ job ] = MazeBatchHelper::process( jobs[ job ], *pass );
+      } );
+    }
+    pool.wait();
+  }
+  auto stop = std::chrono::steady_clock::now();
+
+  size_t failed = 0;
+  if( format == "csv" ) {
+    std::cout << "file,width,height,status";
+    for( const std::string & column : pass->columns ) std::cout << "," << column;
+    std::cout << "\n";
+  }
+  else {
+    std::cout << "[";
+  }
+  for( size_t job = 0; job < jobs.size(); job++ ) {
+    const BatchResult & result = results[ job ];
+    failed += ( result.status != "ok" );
+    if( format == "csv" ) {
+      std::cout << MazeBatchHelper::csvField( jobs[ job ].name ) << "," << result.width
+                << "," << result.height << "," << MazeBatchHelper::csvField( result.status );
+      for( size_t column = 0; column < pass->columns.size(); column++ ) {
+        std::cout << "," << ( column < result.values.size() ? result.values[ column ] : "" );
+      }
+      std::cout << "\n";
+      continue;
+    }
+    std::cout << ( job ? ",\n " : "\n " ) << "{\"file\": "
+              << MazeBatchHelper::jsonString( jobs[ job ].name ) << ", \"width\": "
+              << result.width << ", \"height\": " << result.height << ", \"status\": "
+              << MazeBatchHelper::jsonString( result.status );
+    for( size_t column = 0; column < result.values.size(); column++ ) {
+      /* every value is a number except the hex hash */
+      const std::string & value = result.values[ column ];
+      std::cout << ", \"" << pass->columns[ column ] << "\": "
+                << ( value.compare(0, 2, "0x") == 0 ? MazeBatchHelper::jsonString(value) : value );
+    }
+    std::cout << "}";
+  }
+  if( format == "json" ) std::cout << "\n]\n";
+  std::cout.flush();
+
+  const double seconds = std::chrono::duration<double>( stop - start ).count();
+  std::cerr << jobs.size() << " mazes, " << failed << " failed, " << seconds << " s, "
+            << jobs.size() / std::max( seconds, 1e-9 ) << " mazes/s" << std::endl;
+  return 0;
+}
+
+/*******************************************************************************
+% Routine Name: process
+% File:         MazeBatch.cpp
+% Parameters:   job  - the maze to process.
+%               pass - the pass to run on it.
+% Description:  Reads the maze with a single open into the worker's buffer,
+%               decodes it into the worker's maze - reallocated only when the
+%               dimensions change - and runs the pass. Files that are not
+%               saved mazes are imported as .maz files when their name ends
+%               in ".maz" and as text drawings otherwise.
+% Return:       The result of the maze.
+*******************************************************************************/
+BatchResult MazeBatchHelper::process( const BatchJob & job, const BatchPass & pass ) {
+  static thread_local BatchScratch scratch;
+  BatchResult result;
+  std::ifstream instream( job.path.c_str(), std::ios::in | std::ios::binary );
+  if( !instream.is_open() ) {
+    result.status = "unable to open";
+    return result;
+  }
+  long long size = job.size;
+  if( size < 0 ) {
+    instream.seekg( 0, instream.end );
+    size = instream.tellg();
+  }
+  scratch.buffer.resize( size );
+  instream.seekg( job.offset, instream.beg );
+  if( !instream.read((char *) scratch.buffer.data(), size) ) {
+    result.status = "truncated";
+    return result;
+  }
+  const uint8_t * data = scratch.buffer.data();
+  const bool maz = job.name.size() > 4 &&
+                   job.name.compare( job.name.size() - 4, 4, ".maz" ) == 0;
+  const bool saved = Maze::decodeDimensions( data, size, result.width, result.height );
+  bool known = saved;
+  if( !saved && maz ) {
+    known = MazeFormats::mazDimensions( size, result.width, result.height );
+  }
+  else if( !saved ) {
+    known = MazeFormats::textDimensions( (const char *) data, size, result.width,
+                                         result.height );
+  }
+  if( !known ) {
+    result.status = "unknown format";
+    return result;
+  }
+  if( !scratch.maze || scratch.maze->getWidth() != result.width ||
+      scratch.maze->getHeight() != result.height ) {
+    scratch.maze.reset( new Maze(result.width, result.height) );
+  }
+  if( saved ) scratch.maze->decode( data, size );
+  else if( maz ) MazeFormats::readMaz( data, size, *scratch.maze );
+  else MazeFormats::readText( (const char *) data, size, *scratch.maze );
+  pass.run( *scratch.maze, result.values );
+  result.status = "ok";
+  return result;
+}
+
+/*******************************************************************************
+% Routine Name: runFlood
+% File:         MazeBatch.cpp
+% Parameters:   maze   - the decoded maze.
+%               values - output columns.
+% Description:  Flood fill from the center cells.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeBatchHelper::runFlood( Maze & maze, std::vector<std::string> & values ) {
+  std::vector<MazeCell *> goals;
+  for( int row = (maze.getHeight() - 1) / 2; row <= maze.getHeight() / 2; row++ ) {
+    for( int column = (maze.getWidth() - 1) / 2; column <= maze.getWidth() / 2; column++ ) {
+      goals.push_back( maze.at(row, column) );
+    }
+  }
+  MazeFloodFill flood( maze, goals );
+  flood.step( INT_MAX );
+  long reachable = 0;
+  for( MazeCell * cell : maze ) {
+    reachable += flood.getDistance( cell ) != MazeFloodFill::UNKNOWN_DISTANCE;
+  }
+  values.push_back( std::to_string(flood.getDistance(maze.getHeight() - 1, 0)) );
+  values.push_back( std::to_string(reachable) );
+}
+
+/*******************************************************************************
+% Routine Name: runAnalytics
+% File:         MazeBatch.cpp
+% Parameters:   maze   - the decoded maze.
+%               values - output columns.
+% Description:  Connectivity analytics from the start corner, on one thread
+%               since the pool already keeps every core busy.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeBatchHelper::runAnalytics( Maze & maze, std::vector<std::string> & values ) {
+  MazeAnalytics analytics( maze, 1 );
+  analytics.analyze( maze.at(maze.getHeight() - 1, 0) );
+  values.push_back( std::to_string(analytics.getComponentCount()) );
+  values.push_back( std::to_string(analytics.getEdgeCount()) );
+  values.push_back( std::to_string(analytics.getLoopCount()) );
+  values.push_back( std::to_string(analytics.isPerfect()) );
+  values.push_back( std::to_string(analytics.getUnreachableCount()) );
+}
+
+/*******************************************************************************
+% Routine Name: runJunctions
+% File:         MazeBatch.cpp
+% Parameters:   maze   - the decoded maze.
+%               values - output columns.
+% Description:  Junction graph reduction and the distance from the start
+%               corner to the center over it.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeBatchHelper::runJunctions( Maze & maze, std::vector<std::string> & values ) {
+  MazeCell * start = maze.at( maze.getHeight() - 1, 0 );
+  MazeCell * goal = maze.at( maze.getHeight() / 2, maze.getWidth() / 2 );
+  MazeJunctionGraph graph( maze, { start, goal } );
+  graph.rebuild();
+  int distance = graph.distance( start, goal );
+  values.push_back( std::to_string(graph.getJunctionCount()) );
+  values.push_back( std::to_string(graph.getEdgeCount()) );
+  values.push_back( std::to_string(graph.getShrinkRatio()) );
+  values.push_back( std::to_string(distance) );
+}
+
+/*******************************************************************************
+% Routine Name: runHPA
+% File:         MazeBatch.cpp
+% Parameters:   maze   - the decoded maze.
+%               values - output columns.
+% Description:  Hierarchical path from the start corner to the center.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeBatchHelper::runHPA( Maze & maze, std::vector<std::string> & values ) {
+  MazeHPA hpa( maze );
+  std::vector<MazeCell *> path = hpa.findPath( maze.at(maze.getHeight() - 1, 0),
+    maze.at(maze.getHeight() / 2, maze.getWidth() / 2) );
+  values.push_back( std::to_string(path.size()) );
+  values.push_back( std::to_string(hpa.getNodeCount()) );
+  values.push_back( std::to_string(hpa.getMemoryUsage()) );
+}
+
+/*******************************************************************************
+% Routine Name: runCanonical
+% File:         MazeBatch.cpp
+% Parameters:   maze   - the decoded maze.
+%               values - output columns.
+% Description:  Canonical hash, equal for rotations and mirror images.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeBatchHelper::runCanonical( Maze & maze, std::vector<std::string> & values ) {
+  CanonicalForm form = MazeSymmetry::canonicalize( maze );
+  std::ostringstream hash;
+  hash << "0x" << std::hex << std::setw( 16 ) << std::setfill( '0' ) << form.hash;
+  values.push_back( hash.str() );
+  values.push_back( std::to_string(form.symmetry) );
+}
+
+/*******************************************************************************
+% Routine Name: collectJobs
+% File:         MazeBatch.cpp
+% Parameters:   path - a file, a directory or a tar archive.
+%               jobs - list to append mazes to.
+% Description:  Appends a file, every entry of a tar archive, or every file
+%               below a directory, in sorted order.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeBatchHelper::collectJobs( const std::string & path, std::vector<BatchJob> & jobs ) {
+  struct stat info;
+  if( stat(path.c_str(), &info) != 0 ) return;
+  if( !S_ISDIR(info.st_mode) ) {
+    if( !S_ISREG(info.st_mode) ) return;
+    if( path.size() > 4 && path.compare(path.size() - 4, 4, ".tar") == 0 ) {
+      collectArchive( path, jobs );
+      return;
+    }
+    BatchJob job;
+    job.name = job.path = path;
+    jobs.push_back( job );
+    return;
+  }
+  DIR * directory = opendir( path.c_str() );
+  if( directory == nullptr ) return;
+  std::vector<std::string> entries;
+  while( struct dirent * entry = readdir(directory) ) {
+    std::string name = entry->d_name;
+    if( name == "." || name == ".." ) continue;
+    entries.push_back( path + "/" + name );
+  }
+  closedir( directory );
+  std::sort( entries.begin(), entries.end() );
+  for( const std::string & entry : entries ) collectJobs( entry, jobs );
+}
+
+/*******************************************************************************
+% Routine Name: collectArchive
+% File:         MazeBatch.cpp
+% Parameters:   path - a ustar archive.
+%               jobs - list to append mazes to.
+% Description:  Walks the 512 byte headers of the archive and appends every
+%               regular file entry by offset, so the workers read the entries
+%               straight from the archive.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeBatchHelper::collectArchive( const std::string & path,
+  std::vector<BatchJob> & jobs ) {
+
+  const long long block = 512;
+  std::ifstream instream( path.c_str(), std::ios::in | std::ios::binary );
+  char header[ 512 ];
+  long long offset = 0;
+  while( instream.read(header, block) && header[ 0 ] != '\0' ) {
+    /* size is an octal field, the name may be split over prefix and name */
+    const long long size = std::strtoll( std::string(header + 124, 12).c_str(), nullptr, 8 );
+    std::string name( header, strnlen(header, 100) );
+    std::string prefix( header + 345, strnlen(header + 345, 155) );
+    if( std::string(header + 257, 5) == "ustar" && !prefix.empty() ) {
+      name = prefix + "/" + name;
+    }
+    offset += block;
+    if( header[ 156 ] == '0' || header[ 156 ] == '\0' ) {
+      BatchJob job;
+      job.name = path + ":" + name;
+      job.path = path;
+      job.offset = offset;
+      job.size = size;
+      jobs.push_back( job );
+    }
+    offset += ( size + block - 1 ) / block * block;
+    instream.seekg( offset, instream.beg );
+  }
+}
+
+/*******************************************************************************
+% Routine Name: csvField
+% File:         MazeBatch.cpp
+% Parameters:   field - text of a field.
+% Description:  Quotes a field that holds a comma, quote or line break.
+% Return:       The field as it goes into a CSV row.
+*******************************************************************************/
+std::string MazeBatchHelper::csvField( const std::string & field ) {
+  if( field.find_first_of(",\"\n") == std::string::npos ) return field;
+  std::string quoted = "\"";
+  for( char character : field ) {
+    if( character == '"' ) quoted += '"';
+    quoted += character;
+  }
+  return quoted + "\"";
+}
+
+/*******************************************************************************
+% Routine Name: jsonString
+% File:         MazeBatch.cpp
+% Parameters:   text - text of a string.
+% Description:  Escapes quotes, backslashes and control characters.
+% Return:       The text as a JSON string literal.
+*******************************************************************************/
+std::string MazeBatchHelper::jsonString( const std::string & text ) {
+  std::string escaped = "\"";
+  for( char character : text ) {
+    if( character == '"' || character == '\\' ) {
+      escaped += '\\';
+      escaped += character;
+    }
+    else if( (unsigned char) character < 0x20 ) {
+      char code[ 8 ];
+      snprintf( code, sizeof(code), "\\u%04x", character );
+      escaped += code;
+    }
+    else {
+      escaped += character;
+    }
+  }
+  return escaped + "\"";
+}
@@ -0,0 +1,179 @@
+/*******************************************************************************
+                                                    Jose Jorge Jimenez-Olivas
+                                                    Brandon Cramer
+
+                 University of California, San Diego
+                           IEEE Micromouse
+
+File Name:       MazeDedup.cpp
+Description:     Finds mazes in an archive that are rotations or mirror images
+                 of each other by comparing their canonical forms. Files are
+                 canonicalized in parallel, each read with a single open and
+                 decoded in memory.
+
+Build:           make -C .. tools/maze_dedup, or
+                 g++ -std=c++11 -O2 -pthread -I../.. MazeDedup.cpp -o maze_dedup
+Usage:           maze_dedup <maze file | directory> ...
+Output:          One line per duplicate - "<file>\t<original>\t<symmetry>",
+                 followed by a summary line on stderr.
+*******************************************************************************/
+#include "MazeSymmetry.h"
+#include "WorkStealingPool.hpp"
+#include <unordered_map>
+#include <sys/stat.h>
+#include <dirent.h>
+
+/* canonical hash and symmetry of one file */
+struct DedupEntry {
+  bool loaded = false;
+  uint64_t hash = 0;
+  int symmetry = 0;
+};
+
+/* Helper Functions */
+namespace MazeDedupHelper {
+  void collectFiles( const std::string & path, std::vector<std::string> & files );
+  bool canonicalize( const std::string & path, CanonicalForm & form );
+}
+
+/*******************************************************************************
+% Routine Name: main
+% File:         MazeDedup.cpp
+% Parameters:   argc - number of arguments.
+%               argv - maze files and directories of maze files.
+% Description:  Canonicalizes every maze on the work-stealing pool, keeping
+%               only its canonical hash, then groups the files by hash in
+%               input order. Only when a hash is already taken are the
+%               canonical planes of the files compared, so collisions never
+%               merge distinct mazes.
+% Return:       0 on success, 1 on bad usage.
+*******************************************************************************/
+int main( int argc, char * argv[] ) {
+  if( argc < 2 ) {
+    std::cerr << "Usage: " << argv[ 0 ] << " <maze file | directory> ..." << std::endl;
+    return 1;
+  }
+  std::vector<std::string> files;
+  for( int index = 1; index < argc; index++ ) {
+    MazeDedupHelper::collectFiles( argv[ index ], files );
+  }
+
+  std::vector<DedupEntry> entries( files.size() );
+  {
+    WorkStealingPool pool;
+    for( size_t file = 0; file < files.size(); file++ ) {
+      pool.submit( [&, file] {
+        CanonicalForm form;
+        DedupEntry & entry = entries[ file ];
+        entry.loaded = MazeDedupHelper::canonicalize( files[ file ], form );
+        entry.hash = form.hash;
+        entry.symmetry = form.symmetry;
+      } );
+    }
+    pool.wait();
+  }
+
+  /* canonical hash -> indices of the files of distinct canonical forms */
+  std::unordered_map<uint64_t, std::vector<size_t>> seen;
+  /* canonical planes of files whose hash was matched, read on demand */
+  std::unordered_map<size_t, PassagePlanes> planes;
+  size_t unique = 0;
+  size_t duplicates = 0;
+  size_t skipped = 0;
+  for( size_t file = 0; file < files.size(); file++ ) {
+    if( !entries[ file ].loaded ) {
+      skipped++;
+      continue;
+    }
+    std::vector<size_t> & bucket = seen[ entries[ file ].hash ];
+    bool duplicate = false;
+    for( size_t original : bucket ) {
+      CanonicalForm form;
+      for( size_t index : { original, file } ) {
+        if( planes.count(index) ) continue;
+        MazeDedupHelper::canonicalize( files[ index ], form );
+        planes[ index ] = form.planes;
+      }
+      const PassagePlanes & planes_A = planes[ original ];
+      const PassagePlanes & planes_B = planes[ file ];
+      if( planes_A.width == planes_B.width && planes_A.height == planes_B.height &&
+          planes_A.right == planes_B.right && planes_A.down == planes_B.down ) {
+        std::cout << files[ file ] << "\t" << files[ original ] << "\t"
+                  << entries[ file ].symmetry << "\n";
+        duplicate = true;
+        duplicates++;
+        break;
+      }
+    }
+    if( duplicate ) continue;
+    bucket.push_back( file );
+    unique++;
+  }
+
+  std::cerr << files.size() << " files, " << unique << " unique, "
+            << duplicates << " duplicates, " << skipped << " skipped" << std::endl;
+  return 0;
+}
+
+/*******************************************************************************
+% Routine Name: collectFiles
+% File:         MazeDedup.cpp
+% Parameters:   path  - a file or a directory.
+%               files - list to append regular files to.
+% Description:  Appends a file, or every regular file below a directory.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeDedupHelper::collectFiles( const std::string & path,
+  std::vector<std::string> & files ) {
+
+  struct stat info;
+  if( stat(path.c_str(), &info) != 0 ) return;
+  if( !S_ISDIR(info.st_mode) ) {
+    if( S_ISREG(info.st_mode) ) files.push_back( path );
+    return;
+  }
+  DIR * directory = opendir( path.c_str() );
+  if( directory == nullptr ) return;
+  std::vector<std::string> entries;
+  while( struct dirent * entry = readdir(directory) ) {
+    std::string name = entry->d_name;
+    if( name == "." || name == ".." ) continue;
+    entries.push_back( path + "/" + name );
+  }
+  closedir( directory );
+  std::sort( entries.begin(), entries.end() );
+  for( const std::string & entry : entries ) collectFiles( entry, files );
+}
+
+/*******************************************************************************
+% Routine Name: canonicalize
+% File:         MazeDedup.cpp
+% Parameters:   path - a saved maze file.
+%               form - output canonical form of the stored maze.
+% Description:  Reads the file with a single open into the calling thread's
+%               buffer, decodes it into the thread's maze - reallocated only
+%               when the dimensions change - and canonicalizes it. Files that
+%               are not saved mazes are rejected by their header and size
+%               before anything is allocated for them.
+% Return:       True if the file holds a saved maze.
+*******************************************************************************/
+bool MazeDedupHelper::canonicalize( const std::string & path, CanonicalForm & form ) {
+  static thread_local std::vector<uint8_t> buffer;
+  static thread_local std::unique_ptr<Maze> maze;
+  std::ifstream instream( path.c_str(), std::ios::in | std::ios::binary | std::ios::ate );
+  if( !instream.is_open() ) return false;
+  const std::streamoff size = instream.tellg();
+  if( size < 0 ) return false;
+  buffer.resize( size );
+  instream.seekg( 0, instream.beg );
+  if( !instream.read((char *) buffer.data(), size) ) return false;
+
+  int width, height;
+  if( !Maze::decodeDimensions(buffer.data(), size, width, height) ) return false;
+  if( !maze || maze->getWidth() != width || maze->getHeight() != height ) {
+    maze.reset( new Maze(width, height) );
+  }
+  if( !maze->decode(buffer.data(), size) ) return false;
+  form = MazeSymmetry::canonicalize( *maze );
+  return true;
+}
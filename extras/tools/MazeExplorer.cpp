@@ -0,0 +1,771 @@
+/*******************************************************************************
+                                                    Jose Jorge Jimenez-Olivas
+                                                    Brandon Cramer
+
+                 University of California, San Diego
+                           IEEE Micromouse
+
+File Name:       MazeExplorer.cpp
+Description:     Monte-Carlo exploration simulator. A virtual mouse learns the
+                 walls of a ground-truth maze only through its sensors and
+                 explores with a pluggable strategy until its map proves the
+                 shortest path to the center. Episodes run in parallel on a
+                 work-stealing thread pool.
+
+Build:           g++ -std=c++11 -O2 -pthread -I../.. MazeExplorer.cpp -o maze_explorer
+Usage:           maze_explorer [options] <maze file | directory> ...
+                   --strategy NAME   run one strategy (default all), repeatable -
+                                     flood-fill, path-frontier or planner
+                   --episodes N      episodes per maze and strategy (default 100)
+                   --threads N       worker threads (default one per core)
+                   --range N         cells the front sensor sees ahead (default 1)
+                   --dropout P       chance that a sensor misses a side (default 0)
+                   --omni            sense all four sides instead of front/left/right
+                   --cell-time S     seconds per cell while exploring (default 0.5)
+                   --turn-time S     seconds per turn while exploring (default 0.3)
+                   --run-cell-time S seconds per cell on the final run (default 0.15)
+                   --run-turn-time S seconds per turn on the final run (default 0.2)
+                   --verbose         print every episode
+Output:          One line per strategy - episodes, episodes that proved the
+                 shortest path, mean cells visited, moves, exploration time and
+                 final run time. With --verbose one line per episode first.
+*******************************************************************************/
+#include "MazeFloodFill.h"
+#include "MazeExplorationPlanner.h"
+#include "WorkStealingPool.hpp"
+#include <climits>
+#include <cstdlib>
+#include <random>
+#include <sys/stat.h>
+#include <dirent.h>
+
+/* rows and columns of a step in each heading - up, right, down, left */
+static const int HEADING_ROWS[ 4 ] = { -1, 0, 1, 0 };
+static const int HEADING_COLUMNS[ 4 ] = { 0, 1, 0, -1 };
+
+/* what the mouse can sense and how long it takes to move */
+struct SensorModel {
+  int range = 1;
+  double dropout = 0.0;
+  bool omni = false;
+};
+
+struct TimeModel {
+  double cell_seconds = 0.5;
+  double turn_seconds = 0.3;
+  double run_cell_seconds = 0.15;
+  double run_turn_seconds = 0.2;
+};
+
+/* outcome of one episode */
+struct EpisodeResult {
+  bool solved = false;
+  int cells_visited = 0;
+  int moves = 0;
+  int turns = 0;
+  double explore_seconds = 0.0;
+  double run_seconds = 0.0;
+};
+
+/*******************************************************************************
+Class Name:      Episode
+Description:     One run of the mouse through a ground-truth maze. The mouse
+                 keeps two maps - the optimistic map treats unknown walls as
+                 open, the pessimistic map treats them as walls - and the
+                 shortest path is proven once both agree on its length. The
+                 pessimistic map is kept by a MazeExplorationPlanner.
+*******************************************************************************/
+class Episode {
+public:
+  const MazeSnapshot & truth;
+  const SensorModel & sensors;
+  Maze optimistic;
+  Maze pessimistic;
+  std::vector<bool> visited;
+  std::vector<MazeCell *> goals;
+  MazeExplorationPlanner planner;
+  MazeFloodFill to_goal;
+  MazeFloodFill to_start;
+  MazeFloodFill confirmed;
+  std::mt19937 random;
+  int row;
+  int column;
+  int heading = 0;
+  int cells_visited = 0;
+  int moves = 0;
+  int turns = 0;
+  int bumps = 0;
+
+  Episode( const MazeSnapshot & truth, const SensorModel & sensors, unsigned seed );
+  bool atGoal() const;
+  bool proven();
+  int knownSides( int row, int column );
+  int distance( MazeFloodFill & field, int row, int column );
+  bool move( int next_heading );
+  void sense();
+
+private:
+  void learn( int row, int column, int side, bool wall );
+  static std::vector<MazeCell *> centerCells( Maze & maze );
+};
+
+/* Exploration strategy - picks the heading of the next move. */
+class ExplorationStrategy {
+public:
+  virtual ~ExplorationStrategy() {}
+  /* heading of the next move, or -1 if the strategy is stuck */
+  virtual int nextHeading( Episode & episode ) = 0;
+};
+
+/* Helper Functions */
+namespace MazeExplorerHelper {
+  void collectFiles( const std::string & path, std::vector<std::string> & files );
+  Maze * readMaze( const std::string & path );
+  int descend( Maze & maze, MazeFloodFill & field, int row, int column,
+    int heading, int & cells, int & turns );
+  int bestNeighbor( Episode & episode, MazeFloodFill & field );
+  EpisodeResult simulate( const MazeSnapshot & truth, const std::string & strategy,
+    const SensorModel & sensors, const TimeModel & times, unsigned seed );
+  ExplorationStrategy * createStrategy( const std::string & name );
+}
+
+/* Flood fill to the goal and back to the start until the path is proven. */
+class FloodFillStrategy : public ExplorationStrategy {
+private:
+  bool returning = false;
+
+public:
+  int nextHeading( Episode & episode ) override;
+};
+
+/* Visits the nearest cell on an optimistic shortest path with unsensed sides. */
+class PathFrontierStrategy : public ExplorationStrategy {
+private:
+  std::vector<int> previous;
+  std::vector<int> queue;
+
+public:
+  int nextHeading( Episode & episode ) override;
+};
+
+/* Follows MazeExplorationPlanner to the cheapest cell that can still help. */
+class PlannerStrategy : public ExplorationStrategy {
+public:
+  int nextHeading( Episode & episode ) override;
+};
+
+/* registered strategies, looked up by name */
+static const char * STRATEGY_NAMES[] = { "flood-fill", "path-frontier", "planner" };
+static const int STRATEGY_COUNT = sizeof( STRATEGY_NAMES ) / sizeof( STRATEGY_NAMES[0] );
+
+/*******************************************************************************
+% Routine Name: main
+% File:         MazeExplorer.cpp
+% Parameters:   argc - number of arguments.
+%               argv - options, maze files and directories of maze files.
+% Description:  Loads every maze whose center is reachable from the start
+%               corner and runs the requested episodes of each strategy on it
+%               as independent pool tasks, then prints the mean results.
+% Return:       0 on success, 1 on bad usage.
+*******************************************************************************/
+int main( int argc, char * argv[] ) {
+  SensorModel sensors;
+  TimeModel times;
+  std::vector<std::string> strategies;
+  std::vector<std::string> files;
+  int episodes = 100;
+  int threads = 0;
+  bool verbose = false;
+  bool bad_usage = false;
+
+  for( int index = 1; index < argc; index++ ) {
+    std::string option = argv[ index ];
+    bool has_value = index + 1 < argc;
+    if( option == "--omni" ) sensors.omni = true;
+    else if( option == "--verbose" ) verbose = true;
+    else if( option == "--strategy" && has_value ) strategies.push_back( argv[ ++index ] );
+    else if( option == "--episodes" && has_value ) episodes = std::atoi( argv[ ++index ] );
+    else if( option == "--threads" && has_value ) threads = std::atoi( argv[ ++index ] );
+    else if( option == "--range" && has_value ) sensors.range = std::atoi( argv[ ++index ] );
+    else if( option == "--dropout" && has_value ) sensors.dropout = std::atof( argv[ ++index ] );
+    else if( option == "--cell-time" && has_value ) times.cell_seconds = std::atof( argv[ ++index ] );
+    else if( option == "--turn-time" && has_value ) times.turn_seconds = std::atof( argv[ ++index ] );
+    else if( option == "--run-cell-time" && has_value ) times.run_cell_seconds = std::atof( argv[ ++index ] );
+    else if( option == "--run-turn-time" && has_value ) times.run_turn_seconds = std::atof( argv[ ++index ] );
+    else if( option.compare(0, 2, "--") == 0 ) bad_usage = true;
+    else MazeExplorerHelper::collectFiles( option, files );
+  }
+  if( strategies.empty() ) strategies.assign( STRATEGY_NAMES, STRATEGY_NAMES + STRATEGY_COUNT );
+  for( const std::string & name : strategies ) {
+    std::unique_ptr<ExplorationStrategy> probe( MazeExplorerHelper::createStrategy(name) );
+    if( !probe ) bad_usage = true;
+  }
+  if( bad_usage || files.empty() || episodes <= 0 || sensors.range < 1 ||
+      sensors.dropout < 0.0 || sensors.dropout >= 1.0 ) {
+    std::cerr << "Usage: " << argv[ 0 ] << " [options] <maze file | directory> ..."
+              << std::endl << "Strategies:";
+    for( const char * name : STRATEGY_NAMES ) std::cerr << " " << name;
+    std::cerr << std::endl;
+    return 1;
+  }
+
+  /* the truth is read through snapshots, which are safe to share */
+  std::vector<MazeSnapshot> truths;
+  std::vector<std::string> names;
+  size_t skipped = 0;
+  for( const std::string & file : files ) {
+    std::unique_ptr<Maze> loaded( MazeExplorerHelper::readMaze(file) );
+    if( !loaded ) {
+      skipped++;
+      continue;
+    }
+    Maze & truth = *loaded;
+    const int width = truth.getWidth();
+    const int height = truth.getHeight();
+
+    MazeFloodFill reachable( truth, { truth.at(height - 1, 0) } );
+    reachable.step( INT_MAX );
+    bool connected = false;
+    for( int row = (height - 1) / 2; row <= height / 2; row++ ) {
+      for( int column = (width - 1) / 2; column <= width / 2; column++ ) {
+        connected |= reachable.getDistance( row, column ) != MazeFloodFill::UNKNOWN_DISTANCE;
+      }
+    }
+    if( !connected ) {
+      skipped++;
+      continue;
+    }
+    truths.push_back( truth.snapshot() );
+    names.push_back( file );
+  }
+
+  /* one task per episode, each writing only its own result */
+  std::vector<EpisodeResult> results( truths.size() * strategies.size() * episodes );
+  {
+    WorkStealingPool pool( threads );
+    for( size_t maze = 0; maze < truths.size(); maze++ ) {
+      for( size_t strategy = 0; strategy < strategies.size(); strategy++ ) {
+        for( int episode = 0; episode < episodes; episode++ ) {
+          size_t slot = ( maze * strategies.size() + strategy ) * episodes + episode;
+          pool.submit( [&, maze, strategy, slot] {
+            results[ slot ] = MazeExplorerHelper::simulate( truths[ maze ],
+              strategies[ strategy ], sensors,
+              times, (unsigned)slot * 2654435761u + 1 );
+          } );
+        }
+      }
+    }
+    pool.wait();
+  }
+
+  if( verbose ) {
+    std::cout << "maze\tstrategy\tepisode\tsolved\tvisited\tmoves\tturns"
+              << "\texplore_s\trun_s" << std::endl;
+    for( size_t slot = 0; slot < results.size(); slot++ ) {
+      const EpisodeResult & result = results[ slot ];
+      std::cout << names[ slot / episodes / strategies.size() ] << "\t"
+                << strategies[ slot / episodes % strategies.size() ] << "\t"
+                << slot % episodes << "\t" << result.solved << "\t"
+                << result.cells_visited << "\t" << result.moves << "\t"
+                << result.turns << "\t" << result.explore_seconds << "\t"
+                << result.run_seconds << "\n";
+    }
+  }
+  std::cout << "strategy\tepisodes\tsolved\tvisited\tmoves\texplore_s\trun_s" << std::endl;
+  for( size_t strategy = 0; strategy < strategies.size(); strategy++ ) {
+    long total = 0;
+    long solved = 0;
+    double visited = 0, moves = 0, explore = 0, run = 0;
+    for( size_t maze = 0; maze < truths.size(); maze++ ) {
+      for( int episode = 0; episode < episodes; episode++ ) {
+        const EpisodeResult & result =
+          results[ (maze * strategies.size() + strategy) * episodes + episode ];
+        total++;
+        if( !result.solved ) continue;
+        solved++;
+        visited += result.cells_visited;
+        moves += result.moves;
+        explore += result.explore_seconds;
+        run += result.run_seconds;
+      }
+    }
+    const double count = std::max( solved, 1L );
+    std::cout << strategies[ strategy ] << "\t" << total << "\t" << solved << "\t"
+              << visited / count << "\t" << moves / count << "\t"
+              << explore / count << "\t" << run / count << std::endl;
+  }
+  std::cerr << files.size() << " files, " << truths.size() << " mazes, "
+            << skipped << " skipped" << std::endl;
+  return 0;
+}
+
+/*******************************************************************************
+% Constructor: Episode
+% File:        MazeExplorer.cpp
+% Parameters:  truth   - walls of the real maze.
+%              sensors - sensor model of the mouse.
+%              seed    - seed of the sensor noise and strategy tie breaks.
+% Description: Places the mouse in the bottom left corner facing up, with
+%              nothing known but the outer walls, and takes a first reading.
+*******************************************************************************/
+Episode::Episode( const MazeSnapshot & truth, const SensorModel & sensors,
+  unsigned seed ) : truth( truth ), sensors( sensors ),
+  optimistic( truth.getWidth(), truth.getHeight() ),
+  pessimistic( truth.getWidth(), truth.getHeight() ),
+  visited( truth.getWidth() * truth.getHeight(), false ),
+  goals( centerCells(optimistic) ),
+  planner( pessimistic, centerCells(pessimistic),
+    pessimistic.at(truth.getHeight() - 1, 0) ),
+  to_goal( optimistic, goals ),
+  to_start( optimistic, { optimistic.at(truth.getHeight() - 1, 0) } ),
+  confirmed( pessimistic, centerCells(pessimistic) ),
+  random( seed ), row( truth.getHeight() - 1 ), column( 0 ) {
+
+  optimistic.clearWalls();
+  const int width = truth.getWidth();
+  visited[ row * width + column ] = true;
+  cells_visited = 1;
+  sense();
+}
+
+/*******************************************************************************
+% Routine Name: centerCells
+% File:         MazeExplorer.cpp
+% Parameters:   maze - a maze.
+% Description:  Collects the goal cells - the center cell, or the 2x2 center
+%               square of an even sized maze.
+% Return:       The goal cells of the maze.
+*******************************************************************************/
+std::vector<MazeCell *> Episode::centerCells( Maze & maze ) {
+  std::vector<MazeCell *> cells;
+  for( int row = (maze.getHeight() - 1) / 2; row <= maze.getHeight() / 2; row++ ) {
+    for( int column = (maze.getWidth() - 1) / 2; column <= maze.getWidth() / 2; column++ ) {
+      cells.push_back( maze.at(row, column) );
+    }
+  }
+  return cells;
+}
+
+/*******************************************************************************
+% Routine Name: atGoal
+% File:         MazeExplorer.cpp
+% Parameters:   None.
+% Description:  Checks if the mouse stands on a goal cell.
+% Return:       True if the mouse is in the center.
+*******************************************************************************/
+bool Episode::atGoal() const {
+  for( MazeCell * goal : goals ) {
+    if( goal->row == row && goal->column == column ) return true;
+  }
+  return false;
+}
+
+/*******************************************************************************
+% Routine Name: distance
+% File:         MazeExplorer.cpp
+% Parameters:   field  - flood fill of one of the maps.
+%               row    - row of the cell.
+%               column - column of the cell.
+% Description:  Runs a flood fill to completion on the current map and reads
+%               the distance of a cell.
+% Return:       Distance to the field's goals, or UNKNOWN_DISTANCE.
+*******************************************************************************/
+int Episode::distance( MazeFloodFill & field, int row, int column ) {
+  if( !field.isFinal() ) field.step( INT_MAX );
+  return field.getDistance( row, column );
+}
+
+/*******************************************************************************
+% Routine Name: proven
+% File:         MazeExplorer.cpp
+% Parameters:   None.
+% Description:  The best path the walls could still allow is no shorter than
+%               the best path through passages known to be open, so that
+%               path is a shortest path of the real maze.
+% Return:       True once the shortest path is proven.
+*******************************************************************************/
+bool Episode::proven() {
+  return planner.isProven();
+}
+
+/*******************************************************************************
+% Routine Name: knownSides
+% File:         MazeExplorer.cpp
+% Parameters:   row    - row of the cell.
+%               column - column of the cell.
+% Description:  Getter method for the sides of a cell sensed so far.
+% Return:       Mask of WALL_UP, WALL_RIGHT, WALL_DOWN and WALL_LEFT.
+*******************************************************************************/
+int Episode::knownSides( int row, int column ) {
+  return planner.getKnownSides( pessimistic.at(row, column) );
+}
+
+/*******************************************************************************
+% Routine Name: learn
+% File:         MazeExplorer.cpp
+% Parameters:   row    - row of the cell.
+%               column - column of the cell.
+%               side   - heading of the sensed side.
+%               wall   - true if the side has a wall.
+% Description:  Writes one sensed side into both maps.
+% Return:       Nothing.
+*******************************************************************************/
+void Episode::learn( int row, int column, int side, bool wall ) {
+  const int mask = 1 << side;
+  if( knownSides(row, column) & mask ) return;
+  optimistic.applyWalls( optimistic.at(row, column), wall ? mask : 0, mask );
+  planner.sense( pessimistic.at(row, column), wall ? mask : 0, mask );
+}
+
+/*******************************************************************************
+% Routine Name: sense
+% File:         MazeExplorer.cpp
+% Parameters:   None.
+% Description:  Takes a sensor reading from the current cell. Each side may
+%               be missed with the dropout probability, and the front sensor
+%               follows open passages up to its range.
+% Return:       Nothing.
+*******************************************************************************/
+void Episode::sense() {
+  std::uniform_real_distribution<double> chance( 0.0, 1.0 );
+  const int open = truth.openSides( row, column );
+  /* front, right, back and left - the back only with omni sensors */
+  for( int turn = 0; turn < 4; turn++ ) {
+    if( turn == 2 && !sensors.omni ) continue;
+    const int side = ( heading + turn ) % 4;
+    if( chance(random) < sensors.dropout ) continue;
+    learn( row, column, side, !(open & (1 << side)) );
+  }
+
+  int ahead_row = row;
+  int ahead_column = column;
+  for( int step = 1; step < sensors.range; step++ ) {
+    if( !(truth.openSides(ahead_row, ahead_column) & (1 << heading)) ) break;
+    if( !(knownSides(ahead_row, ahead_column) & (1 << heading)) ) break;
+    ahead_row += HEADING_ROWS[ heading ];
+    ahead_column += HEADING_COLUMNS[ heading ];
+    if( chance(random) < sensors.dropout ) break;
+    learn( ahead_row, ahead_column, heading,
+      !(truth.openSides(ahead_row, ahead_column) & (1 << heading)) );
+  }
+}
+
+/*******************************************************************************
+% Routine Name: move
+% File:         MazeExplorer.cpp
+% Parameters:   next_heading - heading to move in.
+% Description:  Turns the mouse and drives one cell. An unsensed wall is
+%               found by bumping into it, which costs a turn and teaches the
+%               wall to both maps.
+% Return:       True if the mouse moved.
+*******************************************************************************/
+bool Episode::move( int next_heading ) {
+  if( next_heading != heading ) turns++;
+  heading = next_heading;
+  if( !(truth.openSides(row, column) & (1 << heading)) ) {
+    bumps++;
+    learn( row, column, heading, true );
+    return false;
+  }
+  learn( row, column, heading, false );
+  row += HEADING_ROWS[ heading ];
+  column += HEADING_COLUMNS[ heading ];
+  moves++;
+  if( !visited[ row * truth.getWidth() + column ] ) {
+    visited[ row * truth.getWidth() + column ] = true;
+    cells_visited++;
+  }
+  sense();
+  return true;
+}
+
+/*******************************************************************************
+% Routine Name: nextHeading
+% File:         MazeExplorer.cpp
+% Parameters:   episode - the running episode.
+% Description:  Classic flood fill - heads down the optimistic distances to
+%               the center, then back to the start, and again until the
+%               path is proven.
+% Return:       Heading of the next move, or -1 if stuck.
+*******************************************************************************/
+int FloodFillStrategy::nextHeading( Episode & episode ) {
+  if( !returning && episode.atGoal() ) returning = true;
+  if( returning && episode.row == episode.truth.getHeight() - 1 && episode.column == 0 ) {
+    returning = false;
+  }
+  return MazeExplorerHelper::bestNeighbor( episode,
+    returning ? episode.to_start : episode.to_goal );
+}
+
+/*******************************************************************************
+% Routine Name: nextHeading
+% File:         MazeExplorer.cpp
+% Parameters:   episode - the running episode.
+% Description:  Breadth first search over the optimistic map from the mouse
+%               to the nearest cell that lies on some optimistic shortest
+%               path and still has unsensed sides, and takes its first step.
+%               Neighbors are tried straight ahead first, so ties keep the
+%               mouse driving straight. If the mouse stands on such a cell it
+%               drives through an unsensed side, which settles that side.
+% Return:       Heading of the next move, or -1 if stuck.
+*******************************************************************************/
+int PathFrontierStrategy::nextHeading( Episode & episode ) {
+  const int width = episode.truth.getWidth();
+  const int height = episode.truth.getHeight();
+  const int best = episode.distance( episode.to_goal, height - 1, 0 );
+  episode.distance( episode.to_start, 0, 0 ); /* completes the start field */
+  previous.assign( width * height, -1 );
+  queue.assign( width * height, 0 );
+  const int origin = episode.row * width + episode.column;
+  previous[ origin ] = origin;
+  int head = 0;
+  int tail = 0;
+  queue[ tail++ ] = origin;
+  int target = -1;
+  while( head < tail && target < 0 ) {
+    const int cell = queue[ head++ ];
+    const int row = cell / width;
+    const int column = cell % width;
+    const int through = episode.to_goal.getDistance( row, column ) +
+                        episode.to_start.getDistance( row, column );
+    if( episode.knownSides(row, column) != Maze::ALL_SIDES && through == best ) {
+      target = cell;
+      break;
+    }
+    MazeCell * current = episode.optimistic.at( row, column );
+    MazeCell * links[ 4 ] = { current->up, current->right, current->down, current->left };
+    for( int turn = 0; turn < 4; turn++ ) {
+      const int side = ( episode.heading + turn ) % 4;
+      if( links[ side ] == nullptr ) continue;
+      const int next = links[ side ]->row * width + links[ side ]->column;
+      if( previous[ next ] >= 0 ) continue;
+      previous[ next ] = cell;
+      queue[ tail++ ] = next;
+    }
+  }
+  if( target < 0 ) return -1;
+  if( target == origin ) {
+    for( int turn = 0; turn < 4; turn++ ) {
+      const int side = ( episode.heading + turn ) % 4;
+      if( !(episode.knownSides(episode.row, episode.column) & (1 << side)) ) return side;
+    }
+  }
+  while( previous[ target ] != origin ) target = previous[ target ];
+  for( int side = 0; side < 4; side++ ) {
+    if( episode.row + HEADING_ROWS[ side ] == target / width &&
+        episode.column + HEADING_COLUMNS[ side ] == target % width ) {
+      return side;
+    }
+  }
+  return -1;
+}
+
+/*******************************************************************************
+% Routine Name: nextHeading
+% File:         MazeExplorer.cpp
+% Parameters:   episode - the running episode.
+% Description:  Takes the next step of the exploration planner, which skips
+%               every cell that cannot shorten the confirmed path.
+% Return:       Heading of the next move, or -1 once nothing can improve.
+*******************************************************************************/
+int PlannerStrategy::nextHeading( Episode & episode ) {
+  MazeCell * next = episode.planner.nextStep( episode.pessimistic.at(episode.row,
+    episode.column) );
+  if( next == nullptr ) return -1;
+  for( int side = 0; side < 4; side++ ) {
+    if( episode.row + HEADING_ROWS[ side ] == next->row &&
+        episode.column + HEADING_COLUMNS[ side ] == next->column ) {
+      return side;
+    }
+  }
+  return -1;
+}
+
+/*******************************************************************************
+% Routine Name: bestNeighbor
+% File:         MazeExplorer.cpp
+% Parameters:   episode - the running episode.
+%               field   - flood fill of the optimistic map to follow.
+% Description:  Picks the open neighbor closest to the field's goals. Going
+%               straight wins a tie, other ties are broken at random.
+% Return:       Heading of the neighbor, or -1 if none is reachable.
+*******************************************************************************/
+int MazeExplorerHelper::bestNeighbor( Episode & episode, MazeFloodFill & field ) {
+  MazeCell * current = episode.optimistic.at( episode.row, episode.column );
+  MazeCell * links[ 4 ] = { current->up, current->right, current->down, current->left };
+  int best_heading = -1;
+  int best_distance = INT_MAX;
+  int ties = 0;
+  for( int side = 0; side < 4; side++ ) {
+    if( links[ side ] == nullptr ) continue;
+    int distance = episode.distance( field, links[ side ]->row, links[ side ]->column );
+    if( distance == MazeFloodFill::UNKNOWN_DISTANCE ) continue;
+    /* straight ahead sorts before any other neighbor at the same distance */
+    distance = 2 * distance + ( side != episode.heading );
+    if( distance < best_distance ) {
+      best_distance = distance;
+      best_heading = side;
+      ties = 1;
+    }
+    else if( distance == best_distance && episode.random() % ++ties == 0 ) {
+      best_heading = side;
+    }
+  }
+  return best_heading;
+}
+
+/*******************************************************************************
+% Routine Name: descend
+% File:         MazeExplorer.cpp
+% Parameters:   maze    - map to drive on.
+%               field   - flood fill of that map.
+%               row     - row of the first cell.
+%               column  - column of the first cell.
+%               heading - heading of the mouse at the first cell.
+%               cells   - incremented by the cells driven.
+%               turns   - incremented by the turns taken.
+% Description:  Drives down the field to its goals, straight ahead whenever
+%               that is a shortest way.
+% Return:       Heading of the mouse at the end.
+*******************************************************************************/
+int MazeExplorerHelper::descend( Maze & maze, MazeFloodFill & field, int row,
+  int column, int heading, int & cells, int & turns ) {
+
+  if( !field.isFinal() ) field.step( INT_MAX );
+  int distance = field.getDistance( row, column );
+  while( distance > 0 ) {
+    MazeCell * current = maze.at( row, column );
+    MazeCell * links[ 4 ] = { current->up, current->right, current->down, current->left };
+    for( int turn = 0; turn < 4; turn++ ) {
+      const int side = ( heading + turn ) % 4;
+      if( links[ side ] == nullptr ||
+          field.getDistance(links[ side ]->row, links[ side ]->column) != distance - 1 ) {
+        continue;
+      }
+      if( side != heading ) turns++;
+      heading = side;
+      row = links[ side ]->row;
+      column = links[ side ]->column;
+      break;
+    }
+    cells++;
+    distance--;
+  }
+  return heading;
+}
+
+/*******************************************************************************
+% Routine Name: simulate
+% File:         MazeExplorer.cpp
+% Parameters:   truth    - walls of the real maze.
+%               strategy - name of the exploration strategy.
+%               sensors  - sensor model of the mouse.
+%               times    - time model of the mouse.
+%               seed     - seed of the episode.
+% Description:  Explores until the shortest path is proven or the mouse has
+%               moved 20 times per cell, drives back to the start over known
+%               passages and times the final run down the proven path.
+% Return:       Result of the episode.
+*******************************************************************************/
+EpisodeResult MazeExplorerHelper::simulate( const MazeSnapshot & truth,
+  const std::string & strategy, const SensorModel & sensors,
+  const TimeModel & times, unsigned seed ) {
+
+  std::unique_ptr<ExplorationStrategy> explorer( createStrategy(strategy) );
+  Episode episode( truth, sensors, seed );
+  const int start_row = truth.getHeight() - 1;
+  const int move_limit = 20 * truth.getWidth() * truth.getHeight();
+  EpisodeResult result;
+  while( !(result.solved = episode.proven()) && episode.moves < move_limit ) {
+    const int heading = explorer->nextHeading( episode );
+    if( heading < 0 ) break;
+    episode.move( heading );
+  }
+
+  if( result.solved ) {
+    MazeFloodFill home( episode.pessimistic, { episode.pessimistic.at(start_row, 0) } );
+    descend( episode.pessimistic, home, episode.row, episode.column, episode.heading,
+      episode.moves, episode.turns );
+
+    int run_cells = 0;
+    int run_turns = 0;
+    descend( episode.pessimistic, episode.confirmed, start_row, 0, 0, run_cells,
+      run_turns );
+    result.run_seconds = run_cells * times.run_cell_seconds +
+                         run_turns * times.run_turn_seconds;
+  }
+  result.cells_visited = episode.cells_visited;
+  result.moves = episode.moves;
+  result.turns = episode.turns;
+  result.explore_seconds = episode.moves * times.cell_seconds +
+                           ( episode.turns + episode.bumps ) * times.turn_seconds;
+  return result;
+}
+
+/*******************************************************************************
+% Routine Name: createStrategy
+% File:         MazeExplorer.cpp
+% Parameters:   name - name of a registered strategy.
+% Description:  Strategy factory - every episode gets its own instance.
+% Return:       A new strategy, or nullptr for an unknown name.
+*******************************************************************************/
+ExplorationStrategy * MazeExplorerHelper::createStrategy( const std::string & name ) {
+  if( name == "flood-fill" ) return new FloodFillStrategy();
+  if( name == "path-frontier" ) return new PathFrontierStrategy();
+  if( name == "planner" ) return new PlannerStrategy();
+  return nullptr;
+}
+
+/*******************************************************************************
+% Routine Name: collectFiles
+% File:         MazeExplorer.cpp
+% Parameters:   path  - a file or a directory.
+%               files - list to append regular files to.
+% Description:  Appends a file, or every regular file below a directory.
+% Return:       Nothing.
+*******************************************************************************/
+void MazeExplorerHelper::collectFiles( const std::string & path,
+  std::vector<std::string> & files ) {
+
+  struct stat info;
+  if( stat(path.c_str(), &info) != 0 ) return;
+  if( !S_ISDIR(info.st_mode) ) {
+    if( S_ISREG(info.st_mode) ) files.push_back( path );
+    return;
+  }
+  DIR * directory = opendir( path.c_str() );
+  if( directory == nullptr ) return;
+  std::vector<std::string> entries;
+  while( struct dirent * entry = readdir(directory) ) {
+    std::string name = entry->d_name;
+    if( name == "." || name == ".." ) continue;
+    entries.push_back( path + "/" + name );
+  }
+  closedir( directory );
+  std::sort( entries.begin(), entries.end() );
+  for( const std::string & entry : entries ) collectFiles( entry, files );
+}
+
+/*******************************************************************************
+% Routine Name: readMaze
+% File:         MazeExplorer.cpp
+% Parameters:   path - a saved maze file.
+% Description:  Reads the file with a single open and decodes it in memory.
+%               Foreign files are rejected by Maze::decodeDimensions before
+%               a maze is allocated for them, and nothing is printed.
+% Return:       The maze, owned by the caller, or nullptr if the file does
+%               not hold a saved maze.
+*******************************************************************************/
+Maze * MazeExplorerHelper::readMaze( const std::string & path ) {
+  std::ifstream instream( path.c_str(), std::ios::in | std::ios::binary );
+  std::vector<uint8_t> bytes( (std::istreambuf_iterator<char>(instream)),
+                              std::istreambuf_iterator<char>() );
+  int width, height;
+  if( !Maze::decodeDimensions(bytes.data(), bytes.size(), width, height) ) return nullptr;
+  Maze * maze = new Maze( width, height );
+  if( !maze->decode(bytes.data(), bytes.size()) ) {
+    delete maze;
+    return nullptr;
+  }
+  return maze;
+}
@@ -0,0 +1,207 @@
+/*******************************************************************************
+                                                    Jose Jorge Jimenez-Olivas
+                                                    Brandon Cramer
+
+                 University of California, San Diego
+                           IEEE Micromouse
+
+File Name:       WorkStealingPool.hpp
+Description:     Thread pool with one task deque per worker. Workers run their
+                 own tasks newest first and steal the oldest tasks of other
+                 workers when they run dry.
+*******************************************************************************/
+#ifndef WORKSTEALINGPOOL_HPP
+#define WORKSTEALINGPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkStealingPool {
+private:
+  /* tasks of one worker - the owner works at the back, thieves at the front */
+  struct TaskQueue {
+    std::mutex lock;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  std::vector<std::unique_ptr<TaskQueue>> queues;
+  std::vector<std::thread> workers;
+  /* tasks submitted and not finished, and tasks still waiting in a queue */
+  std::atomic<long> pending;
+  std::atomic<long> queued;
+  std::atomic<long> steals;
+  std::atomic<unsigned> next_queue;
+  std::atomic<bool> stopping;
+  std::mutex idle_lock;
+  std::condition_variable work_available;
+  std::condition_variable all_done;
+
+  /* worker index of the calling thread, -1 outside the pool */
+  static int & workerIndex() {
+    static thread_local int index = -1;
+    return index;
+  }
+
+  /*****************************************************************************
+  % Routine Name: take
+  % File:         WorkStealingPool.hpp
+  % Parameters:   worker - index of the calling worker.
+  %               task   - set to the task taken.
+  % Description:  Takes the newest task of the worker's own queue, or else
+  %               steals the oldest task of another queue.
+  % Return:       True if a task was taken.
+  *****************************************************************************/
+  bool take( int worker, std::function<void()> & task ) {
+    {
+      std::lock_guard<std::mutex> guard( queues[ worker ]->lock );
+      if( !queues[ worker ]->tasks.empty() ) {
+        task = std::move( queues[ worker ]->tasks.back() );
+        queues[ worker ]->tasks.pop_back();
+        queued--;
+        return true;
+      }
+    }
+    for( size_t offset = 1; offset < queues.size(); offset++ ) {
+      TaskQueue & victim = *queues[ (worker + offset) % queues.size() ];
+      std::lock_guard<std::mutex> guard( victim.lock );
+      if( !victim.tasks.empty() ) {
+        task = std::move( victim.tasks.front() );
+        victim.tasks.pop_front();
+        queued--;
+        steals++;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /*****************************************************************************
+  % Routine Name: run
+  % File:         WorkStealingPool.hpp
+  % Parameters:   worker - index of this worker.
+  % Description:  Worker loop - runs tasks until the pool stops, sleeping
+  %               while no queue holds work.
+  % Return:       Nothing.
+  *****************************************************************************/
+  void run( int worker ) {
+    workerIndex() = worker;
+    std::function<void()> task;
+    while( true ) {
+      if( take(worker, task) ) {
+        task();
+        task = nullptr;
+        if( --pending == 0 ) {
+          std::lock_guard<std::mutex> guard( idle_lock );
+          all_done.notify_all();
+        }
+        continue;
+      }
+      std::unique_lock<std::mutex> guard( idle_lock );
+      /* submit counts tasks under this lock, so no wake-up is lost */
+      work_available.wait( guard, [this] { return stopping || queued > 0; } );
+      if( stopping && queued <= 0 ) return;
+    }
+  }
+
+public:
+  /*****************************************************************************
+  % Constructor:  WorkStealingPool
+  % File:         WorkStealingPool.hpp
+  % Parameters:   threads - number of workers, 0 for one per core.
+  % Description:  Starts the workers, each with its own task queue.
+  *****************************************************************************/
+  WorkStealingPool( int threads = 0 ) : pending( 0 ), queued( 0 ), steals( 0 ),
+    next_queue( 0 ), stopping( false ) {
+
+    if( threads <= 0 ) threads = std::max( 1u, std::thread::hardware_concurrency() );
+    for( int worker = 0; worker < threads; worker++ ) {
+      queues.emplace_back( new TaskQueue() );
+    }
+    for( int worker = 0; worker < threads; worker++ ) {
+      workers.emplace_back( &WorkStealingPool::run, this, worker );
+    }
+  }
+
+  /*****************************************************************************
+  % Destructor:   ~WorkStealingPool
+  % File:         WorkStealingPool.hpp
+  % Parameters:   None.
+  % Description:  Finishes every submitted task and joins the workers.
+  *****************************************************************************/
+  ~WorkStealingPool() {
+    wait();
+    {
+      std::lock_guard<std::mutex> guard( idle_lock );
+      stopping = true;
+    }
+    work_available.notify_all();
+    for( std::thread & worker : workers ) worker.join();
+  }
+
+  /*****************************************************************************
+  % Routine Name: submit
+  % File:         WorkStealingPool.hpp
+  % Parameters:   task - work to run on the pool.
+  % Description:  Queues a task. Tasks submitted by a worker go to its own
+  %               queue, others are dealt round robin.
+  % Return:       Nothing.
+  *****************************************************************************/
+  void submit( std::function<void()> task ) {
+    int worker = workerIndex();
+    if( worker < 0 ) worker = next_queue++ % queues.size();
+    pending++;
+    {
+      std::lock_guard<std::mutex> guard( queues[ worker ]->lock );
+      queues[ worker ]->tasks.push_back( std::move(task) );
+    }
+    {
+      std::lock_guard<std::mutex> guard( idle_lock );
+      queued++;
+    }
+    work_available.notify_one();
+  }
+
+  /*****************************************************************************
+  % Routine Name: wait
+  % File:         WorkStealingPool.hpp
+  % Parameters:   None.
+  % Description:  Blocks until every submitted task has finished. Must not be
+  %               called from a task.
+  % Return:       Nothing.
+  *****************************************************************************/
+  void wait() {
+    std::unique_lock<std::mutex> guard( idle_lock );
+    all_done.wait( guard, [this] { return pending == 0; } );
+  }
+
+  /*****************************************************************************
+  % Routine Name: getThreadCount
+  % File:         WorkStealingPool.hpp
+  % Parameters:   None.
+  % Description:  Getter method for the number of workers.
+  % Return:       Number of worker threads.
+  *****************************************************************************/
+  int getThreadCount() const {
+    return workers.size();
+  }
+
+  /*****************************************************************************
+  % Routine Name: getStealCount
+  % File:         WorkStealingPool.hpp
+  % Parameters:   None.
+  % Description:  Getter method for the number of tasks taken from another
+  %               worker's queue.
+  % Return:       Number of steals so far.
+  *****************************************************************************/
+  long getStealCount() const {
+    return steals;
+  }
+};
+
+#endif